@@ -0,0 +1,117 @@
+// 压缩的字节 / CPU 取舍：JSON 与 JS 两种负载，分别以 identity / gzip / br
+// 经 compress_response 输出，报告输出字节数、压缩比与 us/req；
+// 再用 serve_file 发送预压缩的 .br / .gz 兄弟文件，对比“请求时零压缩”的开销。
+//
+//   ./compress_bench [iterations=2000]
+#include "http/Compression.h"
+#include "http/HttpParser.h"
+#include "http/StaticFile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+std::string json_payload() {
+    std::string s = "{\"items\":[";
+    for (int i = 0; i < 120; ++i) {
+        if (i) s += ',';
+        s += "{\"id\":" + std::to_string(1000 + i) + ",\"sku\":\"SKU-" + std::to_string(i * 37 % 1000) +
+             "\",\"name\":\"Item number " + std::to_string(i) +
+             "\",\"price\":" + std::to_string(i * 13 % 500) + ".99,\"in_stock\":" + (i % 3 ? "true" : "false") +
+             ",\"tags\":[\"sale\",\"new\",\"popular\"]}";
+    }
+    return s + "]}";
+}
+
+std::string js_payload() {
+    std::string s;
+    for (int i = 0; i < 600; ++i) {
+        s += "export function handler" + std::to_string(i) + "(event, context) {\n"
+             "  const value = context.state.get('key" + std::to_string(i % 50) + "') ?? null;\n"
+             "  if (value === null) { return { status: 404, body: 'missing' }; }\n"
+             "  return { status: 200, body: JSON.stringify({ id: " + std::to_string(i) + ", value }) };\n"
+             "}\n";
+    }
+    return s;
+}
+
+http::HttpRequest make_request(http::HttpParser& p, const std::string& raw) {
+    p.reset();
+    p.parse(raw);
+    return p.request();
+}
+
+void run_dynamic(const char* name, const std::string& payload, const char* content_type, int iters) {
+    http::CompressOptions opts;
+    opts.enabled = true;
+    for (const char* ae : {"identity", "gzip", "br"}) {
+        const std::string raw = std::string("GET / HTTP/1.1\r\nHost: x\r\nAccept-Encoding: ") + ae + "\r\n\r\n";
+        http::HttpParser parser;
+        const http::HttpRequest req = make_request(parser, raw);
+        size_t out_bytes = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; ++i) {
+            http::HttpResponse resp;
+            resp.set_content_type(content_type);
+            resp.body = payload;
+            http::compress_response(req, resp, opts);
+            out_bytes = resp.body.size();
+        }
+        const double us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / iters;
+        std::printf("  %-5s %-9s %8zu -> %8zu bytes  (%5.1f%%)  %8.2f us/req\n", name, ae, payload.size(), out_bytes,
+                    100.0 * static_cast<double>(out_bytes) / static_cast<double>(payload.size()), us);
+    }
+}
+
+// 预压缩文件：压缩在部署时做一次，请求时只是选文件
+void run_precompressed(const std::string& payload, int iters) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "compress_bench";
+    fs::create_directories(dir);
+    const std::string path = (dir / "app.js").string();
+    std::string gz, br;
+    http::gzip_compress(payload, gz, 9);
+    http::brotli_compress(payload, br, 11);
+    std::ofstream(path, std::ios::binary) << payload;
+    if (!gz.empty()) std::ofstream(path + ".gz", std::ios::binary) << gz;
+    if (!br.empty()) std::ofstream(path + ".br", std::ios::binary) << br;
+
+    for (const char* ae : {"identity", "gzip", "br"}) {
+        const std::string raw = std::string("GET /app.js HTTP/1.1\r\nHost: x\r\nAccept-Encoding: ") + ae + "\r\n\r\n";
+        http::HttpParser parser;
+        const http::HttpRequest req = make_request(parser, raw);
+        uint64_t out_bytes = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; ++i) {
+            http::HttpResponse resp;
+            http::serve_file(req, resp, path);
+            out_bytes = resp.body_size();
+        }
+        const double us =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / iters;
+        std::printf("  file  %-9s %8zu -> %8llu bytes  (%5.1f%%)  %8.2f us/req\n", ae, payload.size(),
+                    static_cast<unsigned long long>(out_bytes),
+                    100.0 * static_cast<double>(out_bytes) / static_cast<double>(payload.size()), us);
+    }
+    fs::remove_all(dir);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iters = argc > 1 ? std::atoi(argv[1]) : 2000;
+    std::printf("codecs: gzip=%s br=%s\n", http::codec_available(http::Encoding::Gzip) ? "yes" : "no",
+                http::codec_available(http::Encoding::Brotli) ? "yes" : "no");
+    std::printf("dynamic (gzip level 5, br quality 4):\n");
+    run_dynamic("json", json_payload(), "application/json", iters);
+    run_dynamic("js", js_payload(), "application/javascript", iters);
+    std::printf("precompressed siblings (gzip -9, br -q 11, served from the asset cache):\n");
+    run_precompressed(js_payload(), iters * 10);
+    return 0;
+}
@@ -0,0 +1,192 @@
+// 每条空闲 keep-alive 连接在服务端占用的用户态内存（POSIX）。
+// 本进程起一个单 loop 的 Server，子进程建立 N 条连接，每条发一个浏览器式的请求并读回响应，
+// 然后保持空闲；比较前后服务端进程的堆占用（glibc mallinfo2）与 RSS，除以 N。
+// 客户端放在子进程里，服务端的 fd 才和真实部署一样是连续的。内核的 socket 缓冲区不在其中。
+//
+//   ./conn_mem_bench [connections=10000]
+#include "server/Server.h"
+#include "http/Router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+socket_t connect_to(uint16_t port) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        socket_t s = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = htons(port);
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return s;
+        net::close_socket(s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 服务端还没起来
+    }
+    return net::kInvalidSocket;
+}
+
+// 读完一个响应（按 Content-Length 判断结束）
+bool read_response(socket_t s, std::string& buf) {
+    buf.clear();
+    char tmp[4096];
+    for (;;) {
+        const ssize_t n = ::recv(s, tmp, sizeof(tmp), 0);
+        if (n <= 0) return false;
+        buf.append(tmp, static_cast<size_t>(n));
+        const size_t hdr_end = buf.find("\r\n\r\n");
+        if (hdr_end == std::string::npos) continue;
+        const size_t cl = buf.find("Content-Length: ");
+        const size_t len = cl == std::string::npos ? 0 : std::strtoul(buf.c_str() + cl + 16, nullptr, 10);
+        if (buf.size() >= hdr_end + 4 + len) return true;
+    }
+}
+
+// 堆上已分配的字节数；拿不到时为 0
+size_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+size_t rss_bytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+struct Result {
+    bool   ok{false};
+    int    conns{0};
+    double heap_per_conn{0};
+    double rss_per_conn{0};
+};
+
+// 子进程：建立 conns 条连接，各完成一次请求；全部完成后往 ready 写一个字节（失败写 0），
+// 等 quit 可读（父进程测完）后退出
+void client(uint16_t port, int conns, int ready, int quit) {
+    static const char kReq[] =
+        "GET /ping HTTP/1.1\r\nHost: bench.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate, br\r\nAccept-Language: en-US,en;q=0.9\r\n"
+        "Cookie: session=0123456789abcdef0123456789abcdef; theme=dark\r\n\r\n";
+    std::vector<socket_t> socks;
+    std::string buf;
+    char ok = 1;
+    for (int i = 0; i < conns && ok; ++i) {
+        const socket_t s = connect_to(port);
+        if (!net::is_valid_socket(s)) {
+            ok = 0;
+            break;
+        }
+        socks.push_back(s);
+        ok = ::send(s, kReq, sizeof(kReq) - 1, 0) > 0 && read_response(s, buf);
+        if (i == 0 && ok) { // 第一条作为预热，父进程在这之后取基线
+            (void)::write(ready, &ok, 1);
+            (void)::read(quit, &ok, 1);
+        }
+    }
+    (void)::write(ready, &ok, 1);
+    char c;
+    (void)::read(quit, &c, 1);
+    for (socket_t s : socks) net::close_socket(s);
+}
+
+Result run(net::Backend backend, uint16_t port, int conns) {
+    http::Router router;
+    router.get("/ping", [](const http::HttpRequest&, http::HttpResponse& resp) {
+        resp.set_content_type("text/plain");
+        resp.body = "pong";
+    });
+
+    // 先 fork 再起服务线程：子进程里只有一个线程
+    int ready[2], quit[2];
+    if (::pipe(ready) != 0 || ::pipe(quit) != 0) return {};
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        client(port, conns, ready[1], quit[0]);
+        ::_exit(0);
+    }
+
+    net::Server server(port);
+    server.set_router(&router);
+    server.set_backend(backend);
+    bool started = true;
+    std::thread srv([&] { started = server.listen_and_serve(); });
+
+    Result r;
+    char ok = 0;
+    // 预热：loop 自己的一次性分配（poller 的事件数组、缓冲池的第一份）不算进每条连接
+    r.ok = ::read(ready[0], &ok, 1) == 1 && ok;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const size_t heap0 = heap_in_use();
+    const size_t rss0  = rss_bytes();
+    (void)::write(quit[1], &ok, 1);
+    r.ok = r.ok && ::read(ready[0], &ok, 1) == 1 && ok;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // 让 loop 处理完最后的事件
+    const size_t heap1 = heap_in_use();
+    const size_t rss1  = rss_bytes();
+    (void)::write(quit[1], &ok, 1);
+    ::waitpid(pid, nullptr, 0);
+    for (int fd : {ready[0], ready[1], quit[0], quit[1]}) ::close(fd);
+
+    server.stop();
+    srv.join();
+    r.ok    = r.ok && started;
+    r.conns = conns;
+    const double n  = static_cast<double>(conns - 1);
+    r.heap_per_conn = (static_cast<double>(heap1) - static_cast<double>(heap0)) / n;
+    r.rss_per_conn  = (static_cast<double>(rss1) - static_cast<double>(rss0)) / n;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int conns = argc > 1 ? std::atoi(argv[1]) : 10000;
+    // 软限制提到硬限制（子进程继承），仍不够就减少连接数
+    rlimit lim{};
+    if (::getrlimit(RLIMIT_NOFILE, &lim) == 0) {
+        lim.rlim_cur = lim.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &lim);
+        const auto room = static_cast<int>(std::min<rlim_t>(lim.rlim_cur, 1u << 20) - 64);
+        if (conns > room) conns = room;
+    }
+
+    std::printf("sizeof(Connection) = %zu\n", sizeof(net::Connection));
+    const net::Backend backends[] = {net::Backend::Select, net::Backend::Epoll, net::Backend::IoUring};
+    std::printf("%-10s %12s %14s %14s\n", "backend", "connections", "heap B/conn", "rss B/conn");
+    uint16_t port = 18180;
+    for (net::Backend b : backends) {
+        // select 只能监视 FD_SETSIZE 以内的 fd
+        const int n = b == net::Backend::Select ? std::min(conns, 900) : conns;
+        const Result r = run(b, port++, n);
+        if (!r.ok) {
+            std::printf("%-10s %12s\n", net::backend_name(b), "unavailable");
+            continue;
+        }
+        std::printf("%-10s %12d %14.0f %14.0f\n", net::backend_name(b), r.conns, r.heap_per_conn, r.rss_per_conn);
+    }
+    return 0;
+}
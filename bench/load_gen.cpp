@@ -0,0 +1,393 @@
+// 本机回环上的 HTTP/1.1 负载生成器（POSIX）。T 个线程各自用 poll 驱动一组 keep-alive 连接：
+//   闭环（默认）：每条连接收到响应后立刻发下一个请求，测最大吞吐；
+//   开环（-r 每秒请求数）：请求按固定间隔排定发出时刻，连接都忙时在客户端排队，
+//     延迟从排定时刻算起——协调遗漏（coordinated omission）校正：服务端停顿期间本该发出的
+//     请求的等待都会计入，而不是像闭环那样停顿时干脆不发、漏掉这些样本。
+// 不给 -p 时在本进程内起一个 Server（-b 后端、-l loop 数）压 /ping。
+// 输出吞吐与 p50/p90/p99/p99.9/max 延迟；开环同时给出未校正（从实际发出算起）的一行作对照。
+// 只认 Content-Length 定界的响应。
+//
+//   ./load_gen [-c connections=64] [-t threads=2] [-d seconds=5] [-r rate=0 (闭环)]
+//              [-p port (压外部服务)] [-u path=/ping] [-b auto|select|epoll|io_uring] [-l loops=1]
+#include "server/Server.h"
+#include "http/Router.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// 对数线性直方图（纳秒）：每个 2 的幂区间分 32 个子桶，相对误差不超过 1/32，
+// 记录是一次下标运算，线程各记各的，结束时合并
+class Histogram {
+public:
+    void record(uint64_t v) noexcept {
+        ++counts_[index(v)];
+        ++total_;
+        if (v > max_) max_ = v;
+    }
+    void merge(const Histogram& o) noexcept {
+        for (size_t i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+        total_ += o.total_;
+        max_ = std::max(max_, o.max_);
+    }
+    uint64_t count() const noexcept { return total_; }
+    uint64_t max() const noexcept { return max_; }
+    // 第 q（0..1）分位所在桶的中值
+    uint64_t percentile(double q) const noexcept {
+        if (total_ == 0) return 0;
+        const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total_))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(mid(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static constexpr int    kSubBits = 5;
+    static constexpr size_t kSub     = size_t{1} << kSubBits;
+    static constexpr size_t kBuckets = kSub + (64 - kSubBits) * kSub;
+
+    static size_t index(uint64_t v) noexcept {
+        if (v < kSub) return static_cast<size_t>(v);
+        const int shift = 63 - std::countl_zero(v) - kSubBits;
+        return kSub + static_cast<size_t>(shift) * kSub + static_cast<size_t>((v >> shift) - kSub);
+    }
+    static uint64_t mid(size_t i) noexcept {
+        if (i < kSub) return i;
+        const size_t shift = (i - kSub) / kSub;
+        const uint64_t lo  = static_cast<uint64_t>(kSub + (i - kSub) % kSub) << shift;
+        return lo + ((uint64_t{1} << shift) >> 1);
+    }
+
+    std::vector<uint64_t> counts_ = std::vector<uint64_t>(kBuckets);
+    uint64_t              total_{0};
+    uint64_t              max_{0};
+};
+
+struct Options {
+    int         conns{64};
+    int         threads{2};
+    double      seconds{5};
+    double      rate{0}; // 0 = 闭环
+    int         port{0}; // 0 = 本进程内起服务
+    std::string path{"/ping"};
+    net::Backend backend{net::Backend::Auto};
+    unsigned    loops{1};
+};
+
+struct ThreadResult {
+    Histogram latency; // 闭环：从发出算起；开环：从排定时刻算起
+    Histogram service; // 从实际发出算起（开环的未校正值）
+    uint64_t  done{0};
+    uint64_t  errors{0};
+    uint64_t  backlog{0}; // 开环：结束时还没发出的请求（服务端跟不上排定速率）
+};
+
+// 各线程先建好连接再报到，全部到齐后主线程定下统一的开始时刻
+struct StartGate {
+    std::atomic<int>      connected{0};
+    std::atomic<uint64_t> start{0};
+};
+
+struct Conn {
+    socket_t    fd{net::kInvalidSocket};
+    std::string in;
+    size_t      out_off{0}; // 请求已写出的字节，写完前关注 POLLOUT
+    bool        busy{false};
+    uint64_t    intended{0};
+    uint64_t    sent{0};
+};
+
+socket_t connect_to(uint16_t port) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        socket_t s = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = htons(port);
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            int one = 1;
+            ::setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            net::set_socket_nonblocking(s);
+            return s;
+        }
+        net::close_socket(s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 服务端还没起来
+    }
+    return net::kInvalidSocket;
+}
+
+// 缓冲里是否已有一个完整响应；有则返回它的长度
+size_t response_length(const std::string& buf) {
+    const size_t hdr_end = buf.find("\r\n\r\n");
+    if (hdr_end == std::string::npos) return 0;
+    size_t len = 0;
+    for (size_t pos = buf.find("\r\n"); pos < hdr_end; pos = buf.find("\r\n", pos + 2)) {
+        static const char kName[] = "content-length:";
+        if (hdr_end - pos - 2 < sizeof(kName) - 1) continue;
+        if (!std::equal(kName, kName + sizeof(kName) - 1, buf.begin() + static_cast<std::ptrdiff_t>(pos + 2),
+                        [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); }))
+            continue;
+        len = std::strtoull(buf.c_str() + pos + 2 + sizeof(kName) - 1, nullptr, 10);
+        break;
+    }
+    return buf.size() >= hdr_end + 4 + len ? hdr_end + 4 + len : 0;
+}
+
+void client(const Options& o, uint16_t port, int conns, double rate, StartGate& gate, ThreadResult& r) {
+    const std::string req = "GET " + o.path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    std::vector<Conn> cs(static_cast<size_t>(conns));
+    std::vector<size_t> idle;
+    for (size_t i = 0; i < cs.size(); ++i) {
+        cs[i].fd = connect_to(port);
+        if (!net::is_valid_socket(cs[i].fd)) { ++r.errors; continue; }
+        idle.push_back(i);
+    }
+    gate.connected.fetch_add(1);
+    uint64_t start;
+    while ((start = gate.start.load()) == 0) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    const uint64_t stop = start + static_cast<uint64_t>(o.seconds * 1e9);
+    const bool open_loop = rate > 0;
+    const auto interval  = open_loop ? static_cast<uint64_t>(1e9 / rate) : 0;
+    uint64_t next = start;
+    std::deque<uint64_t> pending; // 开环：到点但还没有空闲连接发出的请求的排定时刻
+    std::vector<pollfd> pfds;
+    std::vector<size_t> owners;
+    char tmp[16384];
+
+    // 写出请求剩余部分；false 表示连接出错
+    auto flush = [&](size_t i) {
+        Conn& c = cs[i];
+        while (c.out_off < req.size()) {
+            const ssize_t n = ::send(c.fd, req.data() + c.out_off, req.size() - c.out_off, MSG_NOSIGNAL);
+            if (n > 0) { c.out_off += static_cast<size_t>(n); continue; }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            return false;
+        }
+        return true;
+    };
+    auto reconnect = [&](size_t i) {
+        Conn& c = cs[i];
+        ++r.errors;
+        net::close_socket(c.fd);
+        c = Conn{};
+        c.fd = connect_to(port);
+        if (net::is_valid_socket(c.fd)) idle.push_back(i);
+    };
+
+    while (now_ns() < start) {}
+    for (uint64_t now = now_ns(); now < stop; now = now_ns()) {
+        if (open_loop)
+            for (; next <= now; next += interval) pending.push_back(next);
+        // 空闲连接领取请求：开环按排定时刻排队，闭环立刻发
+        while (!idle.empty() && (!open_loop || !pending.empty())) {
+            const size_t i = idle.back();
+            idle.pop_back();
+            Conn& c    = cs[i];
+            c.busy     = true;
+            c.out_off  = 0;
+            c.sent     = now;
+            c.intended = open_loop ? pending.front() : now;
+            if (open_loop) pending.pop_front();
+            if (!flush(i)) reconnect(i);
+        }
+
+        pfds.clear();
+        owners.clear();
+        for (size_t i = 0; i < cs.size(); ++i) {
+            if (!cs[i].busy) continue;
+            pfds.push_back(pollfd{cs[i].fd, static_cast<short>(cs[i].out_off < req.size() ? POLLOUT : POLLIN), 0});
+            owners.push_back(i);
+        }
+        // 睡到下一个排定时刻为止，早醒不晚醒，否则生成器自己的拖延会被当成服务端延迟。
+        // poll 只有毫秒精度：Linux 上用 ppoll，其他系统不足 1ms 时不睡
+        uint64_t wait = stop - now;
+        if (open_loop) wait = std::min(wait, next > now ? next - now : 0);
+        wait = std::min<uint64_t>(wait, 100'000'000);
+#ifdef __linux__
+        const timespec ts{static_cast<time_t>(wait / 1'000'000'000), static_cast<long>(wait % 1'000'000'000)};
+        if (::ppoll(pfds.data(), pfds.size(), &ts, nullptr) <= 0)
+#else
+        if (::poll(pfds.data(), pfds.size(), static_cast<int>(wait / 1'000'000)) <= 0)
+#endif
+            continue;
+
+        const uint64_t t = now_ns();
+        for (size_t k = 0; k < pfds.size(); ++k) {
+            if (!pfds[k].revents) continue;
+            const size_t i = owners[k];
+            Conn& c = cs[i];
+            if (c.out_off < req.size()) {
+                if (!flush(i)) reconnect(i);
+                continue;
+            }
+            bool closed = false;
+            for (;;) {
+                const ssize_t n = ::recv(c.fd, tmp, sizeof(tmp), 0);
+                if (n > 0) { c.in.append(tmp, static_cast<size_t>(n)); continue; }
+                closed = n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            if (const size_t len = response_length(c.in)) {
+                r.latency.record(t - c.intended);
+                r.service.record(t - c.sent);
+                ++r.done;
+                c.in.erase(0, len);
+                c.busy = false;
+                if (closed) { // Connection: close 之类：换一条连接，不算失败
+                    net::close_socket(c.fd);
+                    c    = Conn{};
+                    c.fd = connect_to(port);
+                    if (net::is_valid_socket(c.fd)) idle.push_back(i);
+                } else {
+                    idle.push_back(i);
+                }
+            } else if (closed) {
+                reconnect(i);
+            }
+        }
+    }
+    r.backlog = pending.size();
+    for (Conn& c : cs)
+        if (net::is_valid_socket(c.fd)) net::close_socket(c.fd);
+}
+
+void print_row(const char* name, const Histogram& h) {
+    const auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1e3; };
+    std::printf("%-12s %9.1f %9.1f %9.1f %9.1f %10.1f\n", name, us(h.percentile(0.5)), us(h.percentile(0.9)),
+                us(h.percentile(0.99)), us(h.percentile(0.999)), us(h.max()));
+}
+
+bool parse_args(int argc, char** argv, Options& o) {
+    int opt;
+    while ((opt = ::getopt(argc, argv, "c:t:d:r:p:u:b:l:")) != -1) {
+        switch (opt) {
+            case 'c': o.conns   = std::atoi(optarg); break;
+            case 't': o.threads = std::atoi(optarg); break;
+            case 'd': o.seconds = std::atof(optarg); break;
+            case 'r': o.rate    = std::atof(optarg); break;
+            case 'p': o.port    = std::atoi(optarg); break;
+            case 'u': o.path    = optarg; break;
+            case 'l': o.loops   = static_cast<unsigned>(std::atoi(optarg)); break;
+            case 'b': {
+                bool found = false;
+                for (net::Backend b : {net::Backend::Auto, net::Backend::Select, net::Backend::Epoll,
+                                       net::Backend::IoUring}) {
+                    if (std::strcmp(optarg, net::backend_name(b)) == 0) { o.backend = b; found = true; }
+                }
+                if (!found) return false;
+                break;
+            }
+            default: return false;
+        }
+    }
+    return o.conns > 0 && o.threads > 0 && o.seconds > 0 && o.rate >= 0 && !o.path.empty() && o.path[0] == '/';
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if (!parse_args(argc, argv, o)) {
+        std::fprintf(stderr,
+                     "usage: %s [-c connections] [-t threads] [-d seconds] [-r rate] [-p port] [-u path]\n"
+                     "          [-b auto|select|epoll|io_uring] [-l loops]\n",
+                     argv[0]);
+        return 2;
+    }
+    o.threads = std::min(o.threads, o.conns);
+    rlimit lim{};
+    if (::getrlimit(RLIMIT_NOFILE, &lim) == 0) { // 服务端和客户端的 fd 都在本进程里
+        lim.rlim_cur = lim.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    http::Router router;
+    router.get("/ping", [](const http::HttpRequest&, http::HttpResponse& resp) {
+        resp.set_content_type("text/plain");
+        resp.body = "pong";
+    });
+    std::unique_ptr<net::Server> server;
+    std::thread srv;
+    bool started = true;
+    uint16_t port = static_cast<uint16_t>(o.port);
+    if (o.port == 0) {
+        port   = 18190;
+        server = std::make_unique<net::Server>(port);
+        server->set_router(&router);
+        server->set_backend(o.backend);
+        server->set_threads(o.loops);
+        srv = std::thread([&] { started = server->listen_and_serve(); });
+    }
+
+    std::vector<ThreadResult> results(static_cast<size_t>(o.threads));
+    std::vector<std::thread> clients;
+    StartGate gate;
+    for (int t = 0; t < o.threads; ++t) {
+        const int n = o.conns / o.threads + (t < o.conns % o.threads ? 1 : 0);
+        clients.emplace_back([&, t, n] { client(o, port, n, o.rate / o.threads, gate, results[static_cast<size_t>(t)]); });
+    }
+    while (gate.connected.load() < o.threads) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    gate.start.store(now_ns() + 1'000'000);
+    for (std::thread& t : clients) t.join();
+    if (server) {
+        server->stop();
+        srv.join();
+        if (!started) {
+            std::fprintf(stderr, "server failed to start\n");
+            return 1;
+        }
+    }
+
+    ThreadResult total;
+    for (const ThreadResult& r : results) {
+        total.latency.merge(r.latency);
+        total.service.merge(r.service);
+        total.done += r.done;
+        total.errors += r.errors;
+        total.backlog += r.backlog;
+    }
+    std::printf("%s loop, %d connections, %d threads, %.1fs", o.rate > 0 ? "open" : "closed", o.conns, o.threads,
+                o.seconds);
+    if (o.rate > 0) std::printf(", target %.0f req/s", o.rate);
+    std::printf("\nrequests %llu  errors %llu  throughput %.0f req/s\n", static_cast<unsigned long long>(total.done),
+                static_cast<unsigned long long>(total.errors), static_cast<double>(total.done) / o.seconds);
+    std::printf("%-12s %9s %9s %9s %9s %10s\n", "latency(us)", "p50", "p90", "p99", "p99.9", "max");
+    if (o.rate > 0) {
+        print_row("corrected", total.latency);
+        print_row("uncorrected", total.service);
+        if (total.backlog)
+            std::printf("backlog %llu requests never sent: the server is slower than the target rate\n",
+                        static_cast<unsigned long long>(total.backlog));
+    } else {
+        print_row("service", total.service);
+    }
+    return 0;
+}
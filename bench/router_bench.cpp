@@ -0,0 +1,121 @@
+// 路由查找微基准：分别注册 10 / 100 / 1000 / 10000 条形如
+// /api/v<k>/res<i>/:id/items/*rest 与 /api/v<k>/res<i>/list 的路由，
+// 对命中 / 参数 / 404 / 405 四类路径反复 route()，输出 ns/lookup。
+// 基数树的查找只和路径长度有关，各行的耗时应基本不随路由数增长。
+// 最后把同一组 12 条字面路由分别注册到 Router 与编译期 RouteTable，对比两者的分发开销。
+//
+//   ./router_bench [iterations=1000000]
+#include "http/HttpParser.h"
+#include "http/RouteTable.h"
+#include "http/Router.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+void run(size_t routes, int iters) {
+    http::Router router;
+    size_t hits = 0;
+    for (size_t i = 0; i < routes / 2; ++i) {
+        const std::string base = "/api/v" + std::to_string(i % 4) + "/res" + std::to_string(i);
+        router.get(base + "/list", [&hits](const http::HttpRequest&, http::HttpResponse&) { ++hits; });
+        router.get(base + "/:id/items/*rest", [&hits](const http::HttpRequest& req, http::HttpResponse&) {
+            hits += req.param("id").size();
+        });
+    }
+    const size_t last = routes / 2 - 1;
+    const std::string mid = "/api/v" + std::to_string(last % 4) + "/res" + std::to_string(last);
+    const struct {
+        const char* name;
+        std::string path;
+        http::Method method;
+    } cases[] = {
+        {"static", mid + "/list", http::Method::GET},
+        {"params", mid + "/1842/items/a/b/c", http::Method::GET},
+        {"404", mid + "/1842/nothing", http::Method::GET},
+        {"405", mid + "/list", http::Method::POST},
+    };
+
+    std::printf("%6zu routes:", routes);
+    for (const auto& c : cases) {
+        http::HttpRequest req;
+        req.method = c.method;
+        req.path   = c.path;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < iters; ++i) {
+            http::HttpResponse resp;
+            router.route(req, resp);
+        }
+        const double ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / iters;
+        std::printf("  %-6s %7.1f ns", c.name, ns);
+    }
+    std::printf("\n");
+    if (hits == 0) std::printf("(no hits?)\n");
+}
+
+size_t g_sink = 0;
+
+void h_ok(const http::HttpRequest&, http::HttpResponse&) { ++g_sink; }
+
+constexpr auto kTable = http::make_route_table(
+    http::route<http::Method::GET, "/">(h_ok),
+    http::route<http::Method::GET, "/healthz">(h_ok),
+    http::route<http::Method::GET, "/readyz">(h_ok),
+    http::route<http::Method::GET, "/metrics">(h_ok),
+    http::route<http::Method::GET, "/api/v1/users">(h_ok),
+    http::route<http::Method::POST, "/api/v1/users">(h_ok),
+    http::route<http::Method::GET, "/api/v1/orders">(h_ok),
+    http::route<http::Method::POST, "/api/v1/orders">(h_ok),
+    http::route<http::Method::GET, "/api/v1/products">(h_ok),
+    http::route<http::Method::GET, "/api/v1/session">(h_ok),
+    http::route<http::Method::DELETE_, "/api/v1/session">(h_ok),
+    http::route<http::Method::GET, "/api/v1/products/featured">(h_ok));
+
+void run_table(int iters) {
+    http::Router dynamic;
+    const struct { http::Method m; const char* p; } entries[] = {
+        {http::Method::GET, "/"}, {http::Method::GET, "/healthz"}, {http::Method::GET, "/readyz"},
+        {http::Method::GET, "/metrics"}, {http::Method::GET, "/api/v1/users"}, {http::Method::POST, "/api/v1/users"},
+        {http::Method::GET, "/api/v1/orders"}, {http::Method::POST, "/api/v1/orders"},
+        {http::Method::GET, "/api/v1/products"}, {http::Method::GET, "/api/v1/session"},
+        {http::Method::DELETE_, "/api/v1/session"}, {http::Method::GET, "/api/v1/products/featured"},
+    };
+    for (const auto& e : entries)
+        dynamic.add(e.m, e.p, [](const http::HttpRequest&, http::HttpResponse&) { ++g_sink; });
+    http::Router table;
+    table.set_route_table(kTable);
+
+    for (const char* path : {"/healthz", "/api/v1/session", "/api/v1/products/featured"}) {
+        http::HttpRequest req;
+        req.method = http::Method::GET;
+        req.path   = path;
+        std::printf("%-26s", path);
+        for (const http::Router* r : {&dynamic, &table}) {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < iters; ++i) {
+                http::HttpResponse resp;
+                r->route(req, resp);
+            }
+            const double ns =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / iters;
+            std::printf("  %-6s %7.1f ns", r == &dynamic ? "tree" : "table", ns);
+        }
+        std::printf("\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iters = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    for (size_t routes : {10, 100, 1000, 10000}) run(routes, iters);
+    std::printf("12 literal routes, dynamic tree vs compile-time table:\n");
+    run_table(iters);
+    if (g_sink == 0) std::printf("(no hits?)\n");
+    return 0;
+}
@@ -0,0 +1,96 @@
+// 响应序列化微基准：几种常见形态的响应（API 的小 JSON、带一串头的 HTML 页面、
+// 静态文件缓存命中的 304、带 Set-Cookie 的登录响应），分别用
+//   to_string   —— 头 + 体拼成一个新串
+//   head        —— 只生成响应头，每次新建 std::string
+//   write_head  —— 写进复用的缓冲（EventLoop 的做法），输出 ns/resp 与输出字节的 MB/s。
+// 计时包含在 arena 上构造响应（处理函数的那部分工作），三种方式之间的差就是序列化方式的差。
+//
+//   ./serialize_bench [iterations=1000000]
+#include "http/HttpResponse.h"
+#include "http/RequestArena.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Case {
+    const char* name;
+    void (*build)(http::HttpResponse&);
+};
+
+const Case kCases[] = {
+    {"json", [](http::HttpResponse& r) {
+         r.set_content_type("application/json");
+         r.set_keep_alive(true);
+         r.body = R"({"id":1842,"name":"Ada","email":"ada@example.com","roles":["admin","dev"]})";
+     }},
+    {"html", [](http::HttpResponse& r) {
+         r.set_content_type("text/html; charset=utf-8");
+         r.set_header("Cache-Control", "no-cache, private");
+         r.set_header("Content-Security-Policy", "default-src 'self'; img-src 'self' data: https://cdn.example.com");
+         r.set_header("Strict-Transport-Security", "max-age=63072000; includeSubDomains; preload");
+         r.set_header("X-Content-Type-Options", "nosniff");
+         r.set_header("X-Frame-Options", "DENY");
+         r.set_header("Vary", "Accept-Encoding");
+         r.set_keep_alive(true);
+         r.body.assign(12 * 1024, 'h');
+     }},
+    {"304", [](http::HttpResponse& r) {
+         static const auto validators = std::make_shared<const std::string>(
+             "ETag: \"5f2a-18c3b1d2e40\"\r\nLast-Modified: Tue, 09 Jan 2024 10:12:44 GMT\r\n"
+             "Cache-Control: public, max-age=3600\r\nVary: Accept-Encoding\r\n");
+         r.status      = 304;
+         r.reason      = "Not Modified";
+         r.raw_headers = validators;
+         r.set_keep_alive(true);
+     }},
+    {"login", [](http::HttpResponse& r) {
+         r.status = 302;
+         r.reason = "Found";
+         r.set_header("Location", "https://www.example.com/dashboard?tab=overview&from=login");
+         r.set_header("Set-Cookie", "session=8f14e45fceea167a5a36dedd4bea2543; Path=/; HttpOnly; Secure; SameSite=Lax");
+         r.set_header("Cache-Control", "no-store");
+         r.set_keep_alive(false);
+     }},
+};
+
+enum class Mode { ToString, Head, WriteHead };
+
+void run(const Case& c, Mode mode, int iters) {
+    http::RequestArena arena;
+    std::string out;
+    size_t bytes = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int it = 0; it < iters; ++it) {
+        arena.rewind();
+        http::HttpResponse resp(&arena);
+        c.build(resp);
+        switch (mode) {
+            case Mode::ToString:  bytes += resp.to_string().size(); break;
+            case Mode::Head:      bytes += resp.head().size(); break;
+            case Mode::WriteHead:
+                out.clear();
+                resp.write_head(out);
+                bytes += out.size();
+                break;
+        }
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    static const char* const names[] = {"to_string", "head", "write_head"};
+    std::printf("%-6s %-11s %10.1f ns/resp %10.1f MB/s\n", c.name, names[static_cast<int>(mode)],
+                secs * 1e9 / iters, static_cast<double>(bytes) / secs / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int iters = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    for (const Case& c : kCases)
+        for (Mode m : {Mode::ToString, Mode::Head, Mode::WriteHead}) run(c, m, iters);
+    return 0;
+}
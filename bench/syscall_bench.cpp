@@ -0,0 +1,113 @@
+// 各事件后端每个请求的系统调用数对比。
+// 在本进程内起一个单 loop 的 Server，用若干条 keep-alive 连接按批次发请求
+// （每条连接一次写入、一次读回），结束后读取 Server::stats()。
+//
+//   ./syscall_bench [connections=64] [rounds=2000]
+#include "server/Server.h"
+#include "http/Router.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+socket_t connect_to(uint16_t port) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        socket_t s = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = htons(port);
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return s;
+        net::close_socket(s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // 服务端还没起来
+    }
+    return net::kInvalidSocket;
+}
+
+// 读完一个响应（基准只用固定 body 的路由，按 Content-Length 判断结束）
+bool read_response(socket_t s, std::string& buf) {
+    buf.clear();
+    char tmp[4096];
+    for (;;) {
+        const ssize_t n = ::recv(s, tmp, sizeof(tmp), 0);
+        if (n <= 0) return false;
+        buf.append(tmp, static_cast<size_t>(n));
+        const size_t hdr_end = buf.find("\r\n\r\n");
+        if (hdr_end == std::string::npos) continue;
+        const size_t cl = buf.find("Content-Length: ");
+        const size_t len = cl == std::string::npos ? 0 : std::strtoul(buf.c_str() + cl + 16, nullptr, 10);
+        if (buf.size() >= hdr_end + 4 + len) return true;
+    }
+}
+
+struct Result {
+    bool     ok{false};
+    uint64_t requests{0};
+    uint64_t syscalls{0};
+    double   seconds{0};
+};
+
+Result run(net::Backend backend, uint16_t port, int conns, int rounds) {
+    http::Router router;
+    router.get("/ping", [](const http::HttpRequest&, http::HttpResponse& resp) {
+        resp.set_content_type("text/plain");
+        resp.body = "pong";
+    });
+
+    net::Server server(port);
+    server.set_router(&router);
+    server.set_backend(backend);
+    bool started = true;
+    std::thread srv([&] { started = server.listen_and_serve(); });
+
+    std::vector<socket_t> socks;
+    for (int i = 0; i < conns; ++i) socks.push_back(connect_to(port));
+
+    static const char kReq[] = "GET /ping HTTP/1.1\r\nHost: bench\r\n\r\n";
+    std::string buf;
+    Result r;
+    r.ok = true;
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds && r.ok; ++round) {
+        for (socket_t s : socks) ::send(s, kReq, sizeof(kReq) - 1, 0);
+        for (socket_t s : socks) r.ok = r.ok && read_response(s, buf);
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (socket_t s : socks) net::close_socket(s);
+    server.stop();
+    srv.join();
+    r.ok       = r.ok && started;
+    r.requests = server.stats().requests;
+    r.syscalls = server.stats().syscalls;
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int conns  = argc > 1 ? std::atoi(argv[1]) : 64;
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    const net::Backend backends[] = {net::Backend::Select, net::Backend::Epoll, net::Backend::IoUring};
+    std::printf("%-10s %12s %12s %14s %12s\n", "backend", "requests", "syscalls", "syscalls/req", "req/s");
+    uint16_t port = 18080;
+    for (net::Backend b : backends) {
+        const Result r = run(b, port++, conns, rounds);
+        if (!r.ok || r.requests == 0) {
+            std::printf("%-10s %12s\n", net::backend_name(b), "unavailable");
+            continue;
+        }
+        std::printf("%-10s %12llu %12llu %14.2f %12.0f\n", net::backend_name(b),
+                    static_cast<unsigned long long>(r.requests),
+                    static_cast<unsigned long long>(r.syscalls),
+                    static_cast<double>(r.syscalls) / static_cast<double>(r.requests),
+                    static_cast<double>(r.requests) / r.seconds);
+    }
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "server/Server.h"
 #include "http/Router.h"
 #include "http/HttpResponse.h"
+#include "server/Coroutine.h"
+#include <chrono>
 #include <iostream>
 
 int main() {
@@ -10,6 +12,17 @@ int main() {
         resp.set_content_type("application/json");
         resp.body = R"({"message":"Hello, C++ Web Server!"})";
     });
+    router.get("/users/:id", [](const http::HttpRequest& req, http::HttpResponse& resp){
+        resp.set_content_type("application/json");
+        resp.body = R"({"id":")" + std::string(req.param("id")) + R"("})";
+    });
+    // 协程路由：sleep 期间 loop 照常处理其他连接
+    router.get("/delay", [](const http::HttpRequest&) -> http::Task<http::HttpResponse> {
+        co_await net::sleep_for(std::chrono::milliseconds(100));
+        http::HttpResponse resp;
+        resp.body = "slept 100ms";
+        co_return resp;
+    });
     router.set_static("/static", "static");
     
     net::Server server(8080);
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace http {
+
+// Incremental request body decoder: a Content-Length body passes through, a chunked one
+// (RFC 9112 section 7.1) is stripped of its framing. Chunk extensions and trailer fields
+// are skipped. Works on whatever bytes have arrived; nothing is buffered, so a chunk-size
+// line or CRLF split across reads simply resumes on the next call.
+class BodyDecoder {
+public:
+    // Bytes of chunk extensions plus trailer fields tolerated per body, so a client cannot
+    // keep a connection busy with framing that never yields data.
+    static constexpr size_t kMaxFraming = 8 * 1024;
+
+    void reset_length(uint64_t n) noexcept;
+    void reset_chunked() noexcept;
+
+    // Decodes from the front of `in`: returns how many bytes were consumed and points `data`
+    // at the body bytes among them (a view into `in`, empty when only framing was consumed).
+    // Call again with the rest until it returns 0, done() or error().
+    size_t next(std::string_view in, std::string_view& data) noexcept;
+
+    bool     done() const noexcept { return state_ == State::Done; }
+    bool     error() const noexcept { return state_ == State::Error; }
+    bool     chunked() const noexcept { return chunked_; }
+    uint64_t size() const noexcept { return size_; } // body bytes produced so far
+
+private:
+    enum class State : uint8_t { Size, Ext, SizeLf, Data, DataCr, DataLf, Trailer, TrailerLf, Done, Error };
+
+    State    state_{State::Done};
+    bool     chunked_{false};
+    bool     line_empty_{true}; // trailer: nothing on the current line yet
+    uint8_t  digits_{0};
+    uint64_t remaining_{0};     // of the current chunk, or of a Content-Length body
+    uint64_t size_{0};
+    size_t   framing_{0};
+};
+
+} // namespace http
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+
+namespace http {
+
+enum class Encoding { Identity, Gzip, Brotli };
+
+// "br", "gzip" or "identity".
+std::string_view encoding_token(Encoding e) noexcept;
+
+// True when an Accept-Encoding value allows `coding` (q > 0, or "*" with q > 0 when the
+// coding is not listed). Token comparison is case-insensitive.
+bool accepts_encoding(std::string_view accept_encoding, std::string_view coding) noexcept;
+
+// Text-like media types worth compressing (text/*, JSON, JavaScript, XML, SVG, ...).
+bool compressible_type(std::string_view content_type) noexcept;
+
+// Whether the library was built with the codec (zlib / libbrotlienc).
+bool codec_available(Encoding e) noexcept;
+
+// One-shot compression with per-thread encoder state that is reused across calls
+// (a reset z_stream, an arena backing the brotli encoder). Appends to `out`.
+bool gzip_compress(std::string_view in, std::string& out, int level);
+bool brotli_compress(std::string_view in, std::string& out, int quality);
+
+struct CompressOptions {
+    bool   enabled{false};
+    size_t min_size{1024};   // smaller bodies are not worth the CPU / header bytes
+    int    gzip_level{5};
+    int    brotli_quality{4}; // fast levels: this runs on every dynamic response
+};
+
+// Adds a value to the response's Vary header (no duplicates).
+void add_vary(HttpResponse& resp, std::string_view field);
+
+// On-the-fly compression of a handler's response: when enabled and the response is a
+// compressible 200 with an in-memory body of at least min_size and no Content-Encoding,
+// replaces the body with its br (preferred) or gzip encoding, sets Content-Encoding,
+// marks a strong ETag as belonging to that encoding and adds Vary: Accept-Encoding.
+// Returns true when the body was compressed.
+bool compress_response(const HttpRequest& req, HttpResponse& resp, const CompressOptions& opts);
+
+} // namespace http
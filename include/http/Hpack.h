@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http {
+
+// HPACK (RFC 7541), the header compression of HTTP/2: the static table, one dynamic table
+// per direction and the canonical Huffman code for string literals. An encoder or decoder
+// holds one connection's state for one direction, so blocks must go through it in wire order.
+
+// Huffman coding of string literals (RFC 7541 Appendix B).
+size_t huffman_size(std::string_view s) noexcept; // encoded length in bytes
+void   huffman_encode(std::string_view s, std::string& out);
+// Appends the decoded string to `out`. Fails on an invalid code, an encoded EOS, or padding
+// that is longer than 7 bits or not all ones.
+bool   huffman_decode(std::string_view s, std::string& out);
+
+// Dynamic table: newest entry first, each entry counted as name + value + 32 bytes
+// (section 4.1); inserting past the maximum evicts from the oldest end.
+class HpackTable {
+public:
+    explicit HpackTable(size_t max_size) : max_(max_size) {}
+
+    void   insert(std::string_view name, std::string_view value);
+    void   resize(size_t max_size);
+    size_t count() const noexcept { return entries_.size(); }
+    size_t size() const noexcept { return size_; }
+    size_t max_size() const noexcept { return max_; }
+    // 0 is the newest entry (HPACK index 62).
+    std::string_view name(size_t i) const noexcept { return entries_[i].name; }
+    std::string_view value(size_t i) const noexcept { return entries_[i].value; }
+
+private:
+    struct Entry {
+        std::string name;
+        std::string value;
+    };
+    void evict(size_t max_size);
+
+    std::deque<Entry> entries_;
+    size_t            size_{0};
+    size_t            max_;
+};
+
+// Position of one decoded field in the buffer passed to HpackDecoder::decode.
+struct HpackField {
+    uint32_t name_off;
+    uint32_t name_len;
+    uint32_t value_off;
+    uint32_t value_len;
+
+    std::string_view name(std::string_view buf) const noexcept { return buf.substr(name_off, name_len); }
+    std::string_view value(std::string_view buf) const noexcept { return buf.substr(value_off, value_len); }
+};
+
+class HpackDecoder {
+public:
+    static constexpr size_t kDefaultTableSize = 4096;
+
+    // Decodes one complete header block (a HEADERS payload plus its CONTINUATIONs). Names and
+    // values are appended to `buf` and their positions to `fields`, so a field costs no
+    // allocation of its own and the positions survive `buf` growing. Returns false on a
+    // malformed block or once `buf` would exceed `max_bytes`; either is a connection error,
+    // since the dynamic table may then be out of step with the peer's.
+    bool decode(std::string_view block, std::string& buf, std::vector<HpackField>& fields, size_t max_bytes);
+    // Our SETTINGS_HEADER_TABLE_SIZE: the largest table the peer's size updates may ask for.
+    void set_max_table_size(size_t n) noexcept { limit_ = n; }
+
+private:
+    bool lookup(size_t index, std::string_view& name, std::string_view& value) const noexcept;
+
+    HpackTable table_{kDefaultTableSize};
+    size_t     limit_{kDefaultTableSize};
+};
+
+class HpackEncoder {
+public:
+    // The peer's SETTINGS_HEADER_TABLE_SIZE. The table never grows past the default 4096
+    // bytes; a smaller size is announced at the start of the next block.
+    void set_max_table_size(size_t n);
+    // Starts a header block: emits the pending dynamic table size update, if any.
+    void begin(std::string& out);
+    void status(int code, std::string& out);
+    // One field; `name` must already be lowercase (HTTP/2 rejects uppercase names). Values
+    // that are different for nearly every response (content-length, date, etag, cookies...)
+    // are sent without indexing so they do not push reusable entries out of the table.
+    void field(std::string_view name, std::string_view value, std::string& out);
+
+private:
+    HpackTable table_{HpackDecoder::kDefaultTableSize};
+    size_t     min_pending_{SIZE_MAX}; // smallest size asked for since the last block
+    size_t     next_size_{HpackDecoder::kDefaultTableSize};
+};
+
+} // namespace http
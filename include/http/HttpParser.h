@@ -1,33 +1,70 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <optional>
+#include "http/BodyDecoder.h"
 #include "http/HttpRequest.h"
 
 
 namespace http {
 
 // Very simple HTTP/1.1 parser: request-line + headers + optional body by Content-Length
+// or chunked transfer-coding. The parsed request is zero-copy: its fields are views into
+// the buffer passed to parse(), except a chunked body, which is decoded into a buffer owned
+// by the parser (valid until reset()).
 class HttpParser {
 public:
     enum class State { REQUEST_LINE, HEADERS, BODY, COMPLETE, ERROR };
 
+    enum class Status { NeedMore, Complete, Error };
+
     HttpParser();
-    // Feed data and try to parse one request. Returns true when a full request is parsed.
-    bool parse(const std::string& data);
+    // Incremental parse of one request. `data` is everything received so far for this
+    // request, starting at its first byte; call again with the grown window after each
+    // recv. Only the bytes appended since the previous call are scanned (a partial line
+    // resumes where it stopped), so total work is linear in the request size.
+    // Bytes after the request (pipelined requests) are left alone.
+    Status feed(std::string_view data);
+    // Convenience wrapper: true when a full request is parsed.
+    bool parse(std::string_view data) { return feed(data) == Status::Complete; }
 
     bool complete() const { return state_ == State::COMPLETE; }
     bool error() const { return state_ == State::ERROR; }
+    // Status to answer a failed request with: 431 when the head has more than
+    // HeaderList::kMaxHeaders fields, 400 for anything malformed.
+    unsigned error_status() const { return error_status_; }
+    // Headers are parsed and the body is still incomplete; consumed() is then the size of
+    // the request head.
+    bool in_body() const { return state_ == State::BODY; }
+    // Declared Content-Length; 0 for a chunked body, whose length is unknown up front.
+    size_t body_length() const { return expected_body_len_; }
+    bool chunked() const { return decoder_.chunked(); }
+    // For a caller that consumed the body itself (streamed or spilled to disk) while the
+    // parser sat in_body(): completes the request with `body` (which the caller keeps
+    // alive); consumed() stays the size of the head.
+    void finish_body(std::string_view body);
     const HttpRequest& request() const { return req_; }
+    HttpRequest& request() { return req_; } // the router records path parameters in it
+    // Bytes of `data` the parser has consumed: complete lines so far, and once the
+    // request is complete, exactly the bytes it occupied.
+    size_t consumed() const { return consumed_; }
     void reset();
 
 private:
     State state_{State::REQUEST_LINE};
+    unsigned error_status_{400};
     HttpRequest req_;
     size_t expected_body_len_{0};
+    BodyDecoder decoder_;     // chunked bodies only
+    std::string chunked_body_;
+    size_t body_raw_{0};      // chunked: raw bytes after the head decoded so far
     size_t consumed_{0}; // how many chars of the input have been consumed
+    size_t scan_{0};     // next unscanned byte of the current line (>= consumed_)
+    const char* base_{nullptr}; // data.data() of the previous call, views in req_ point here
 
-    bool parse_request_line(const std::string& line);
-    bool parse_header_line(const std::string& line);
+    bool parse_request_line(std::string_view line);
+    bool parse_header_line(std::string_view line);
+    void rebase(const char* from, const char* to);
 };
 
 } // namespace http
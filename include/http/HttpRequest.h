@@ -1,23 +1,145 @@
 #pragma once
-#include <string>
-#include <unordered_map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 namespace http {
 
 enum class Method { GET, POST, PUT, DELETE_, HEAD, OPTIONS, PATCH, UNKNOWN };
 
+// ASCII case-insensitive comparison (header names, Connection tokens).
+bool iequals(std::string_view a, std::string_view b) noexcept;
+// Whether a comma-separated header value (Connection, Upgrade) lists `token`,
+// compared case-insensitively with surrounding whitespace ignored.
+bool has_token(std::string_view list, std::string_view token) noexcept;
+
+struct Header {
+    std::string_view name;
+    std::string_view value;
+};
+
+// Flat header list: the first kInlineHeaders live inline in the request, a longer list
+// moves to the heap once. Lookups are linear and case-insensitive, which beats hashing
+// for the dozen headers a request usually carries.
+class HeaderList {
+public:
+    static constexpr size_t kInlineHeaders = 32;
+    static constexpr size_t kMaxHeaders    = 100; // more is answered 431
+
+    // Returns false when the list already holds kMaxHeaders fields.
+    bool add(std::string_view name, std::string_view value) {
+        if (size_ < kInlineHeaders) {
+            inline_[size_++] = Header{name, value};
+            return true;
+        }
+        if (size_ == kMaxHeaders) return false;
+        if (size_ == kInlineHeaders) overflow_.assign(inline_.begin(), inline_.end());
+        overflow_.push_back(Header{name, value});
+        ++size_;
+        return true;
+    }
+    // Pointer to the first value with this name, nullptr when absent.
+    const std::string_view* find(std::string_view name) const noexcept {
+        for (const Header& h : *this)
+            if (iequals(h.name, name)) return &h.value;
+        return nullptr;
+    }
+    void clear() noexcept {
+        size_ = 0;
+        overflow_.clear(); // keeps the capacity for the next request on the connection
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    const Header* begin() const noexcept { return size_ > kInlineHeaders ? overflow_.data() : inline_.data(); }
+    const Header* end() const noexcept { return begin() + size_; }
+    Header* begin() noexcept { return size_ > kInlineHeaders ? overflow_.data() : inline_.data(); }
+    Header* end() noexcept { return begin() + size_; }
+
+private:
+    std::array<Header, kInlineHeaders> inline_{};
+    std::vector<Header>                overflow_; // all fields once there are more than kInlineHeaders
+    size_t                             size_{0};
+};
+
+struct Param {
+    std::string_view name;  // points into the route table
+    std::string_view value; // points into the request path
+};
+
+// Path parameters captured by the router (":id" segments, a "*rest" catch-all), in
+// pattern order. Stored inline like the headers, so matching never allocates.
+class ParamList {
+public:
+    static constexpr size_t kMaxParams = 8;
+
+    bool add(std::string_view name, std::string_view value) noexcept {
+        if (size_ == kMaxParams) return false;
+        items_[size_++] = Param{name, value};
+        return true;
+    }
+    // Value of the named parameter, empty view when absent.
+    std::string_view get(std::string_view name) const noexcept {
+        for (size_t i = 0; i < size_; ++i)
+            if (items_[i].name == name) return items_[i].value;
+        return {};
+    }
+    void truncate(size_t n) noexcept { if (n < size_) size_ = n; }
+    void clear() noexcept { size_ = 0; }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    const Param* begin() const noexcept { return items_.data(); }
+    const Param* end() const noexcept { return items_.data() + size_; }
+    Param* begin() noexcept { return items_.data(); }
+    Param* end() noexcept { return items_.data() + size_; }
+
+private:
+    std::array<Param, kMaxParams> items_{};
+    size_t                        size_{0};
+};
+
+// A request body the server wrote to an unlinked temporary file instead of memory
+// (RouteOptions::spill_threshold): `size` bytes from offset 0 of `fd`. `owner` keeps the
+// file open while any copy of the request lives, so it may be read on a worker thread or
+// sent back with HttpResponse::file.
+struct BodyFile {
+    std::shared_ptr<const void> owner;
+    int                         fd{-1};
+    uint64_t                    size{0};
+};
+
+// Zero-copy request: every field is a view into the connection's input buffer.
+// Views stay valid only while the handler runs; copy anything that must outlive it.
 struct HttpRequest {
-    Method method{Method::UNKNOWN};
-    std::string uri;
-    std::string path;
-    std::string query;
-    std::string version{"HTTP/1.1"};
-    std::unordered_map<std::string, std::string> headers;
-    std::string body;
+    Method           method{Method::UNKNOWN};
+    std::string_view uri;
+    std::string_view path;
+    std::string_view query;
+    std::string_view version{"HTTP/1.1"};
+    HeaderList       headers;
+    std::string_view body;
+    BodyFile         body_file; // set instead of body when the body was spilled to disk
+    ParamList        params; // filled by Router::route
 
+    // Header value or empty view when absent.
+    std::string_view header(std::string_view name) const noexcept {
+        const std::string_view* v = headers.find(name);
+        return v ? *v : std::string_view{};
+    }
+    // Path parameter captured by the matched route, empty view when absent.
+    std::string_view param(std::string_view name) const noexcept { return params.get(name); }
     bool keep_alive() const;
+    void clear() noexcept;
+    // Re-points every view that lies in [from, from + len) at the same offset in `to`,
+    // after the request bytes were copied there (e.g. to hand the request to another
+    // thread). Views elsewhere (parameter names, defaults) are left alone.
+    void rebase(const char* from, size_t len, const char* to) noexcept;
 };
 
-Method parse_method(const std::string& s);
+Method parse_method(std::string_view s);
 
 } // namespace http
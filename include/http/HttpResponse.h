@@ -1,20 +1,133 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace http {
 
+// A byte range of an open file, sent by the server with sendfile so the data never
+// passes through user space. `owner` keeps `fd` open until the send completes.
+struct FileRange {
+    std::shared_ptr<const void> owner;
+    int                         fd{-1};
+    uint64_t                    offset{0};
+    uint64_t                    length{0};
+};
+
+// Shared by a StreamWaker and the server sending its stream. While the body is in progress
+// the server binds it to the connection (and HTTP/2 stream); wake() then forwards to the
+// server once per producer call, and is dropped while unbound (before the stream has asked
+// its producer anything, or after it ended).
+class StreamSignal {
+public:
+    using Sink = void (*)(void* target, uint64_t conn, uint32_t stream);
+
+    void wake();
+    void bind(Sink sink, void* target, uint64_t conn, uint32_t stream) noexcept;
+    void unbind() noexcept;
+    // Called by the server right before asking the producer; wakes after it count again.
+    void rearm() noexcept { pending_.store(false, std::memory_order_release); }
+    // Woken since the last rearm().
+    bool pending() const noexcept { return pending_.load(std::memory_order_acquire); }
+
+private:
+    std::mutex        mu_; // held while forwarding, so unbind() waits for a wake in flight
+    Sink              sink_{nullptr};
+    void*             target_{nullptr};
+    uint64_t          conn_{0};
+    uint32_t          stream_{0};
+    std::atomic<bool> pending_{false};
+};
+
+// Lets a streaming body be pushed instead of polled: an event source calls wake() when the
+// producer has something to send. Any thread, any number of times; cheap to copy.
+class StreamWaker {
+public:
+    StreamWaker() = default;
+    void wake() const {
+        if (signal_) signal_->wake();
+    }
+    explicit operator bool() const noexcept { return static_cast<bool>(signal_); }
+
+private:
+    friend struct HttpResponse;
+    explicit StreamWaker(std::shared_ptr<StreamSignal> signal) noexcept : signal_(std::move(signal)) {}
+
+    std::shared_ptr<StreamSignal> signal_;
+};
+
+// Header names/values and the reason phrase live in a polymorphic memory resource: the
+// default heap, or the connection's RequestArena when the event loop builds the response.
+// Copies always go to the default heap, and moving into a response on another resource
+// copies the elements, so a response handed to a worker thread never refers to the arena.
 struct HttpResponse {
+    using Headers = std::pmr::unordered_map<std::pmr::string, std::pmr::string>;
+
+    HttpResponse() = default;
+    explicit HttpResponse(std::pmr::memory_resource* mr) : reason("OK", mr), headers(mr) {}
+
     int status{200};
-    std::string reason{"OK"};
-    std::unordered_map<std::string, std::string> headers;
+    std::pmr::string reason{"OK"};
+    Headers headers;
+    // Pre-serialized header lines ("Name: value\r\n"...) emitted after `headers`;
+    // lets a cache keep a ready-made header block per entry.
+    std::shared_ptr<const std::string> raw_headers;
     std::string body;
+    // Takes precedence over `body` when set: the bytes are sent straight from this shared
+    // buffer (e.g. a cached file) without copying it into the response.
+    std::shared_ptr<const std::string> shared_body;
+    // Takes precedence over both when fd >= 0 (static files).
+    FileRange file;
 
-    void set_content_type(const std::string& type) { headers["Content-Type"] = type; }
-    void set_header(const std::string& key, const std::string& value) {
-        headers[key] = value;
+    // Streaming body, for responses too large or too open-ended to build up front (exports,
+    // server-sent events). The server calls the producer on its event loop thread whenever
+    // the connection's queued output drops below a low watermark, so it runs at the client's
+    // pace. Append the next piece to `chunk` and return true while more follows; return false
+    // once the body is complete (that call's chunk is still sent). Returning true with
+    // nothing appended means nothing is ready yet: with a stream_waker() the stream then
+    // sleeps until wake(), otherwise the server asks again a few milliseconds later.
+    // Takes precedence over `body`, `shared_body` and `file`.
+    using BodyProducer = std::function<bool(std::string& chunk)>;
+    BodyProducer stream;
+    // Length of a streamed body when known up front, sent as Content-Length; kChunked uses
+    // chunked transfer-coding. The server switches kChunked to kUntilClose for HTTP/1.0
+    // clients, which do not understand chunked: the body then ends when the connection closes.
+    static constexpr int64_t kChunked    = -1;
+    static constexpr int64_t kUntilClose = -2;
+    int64_t stream_length{kChunked};
+    // Set by stream_waker(); the server binds it while it sends the stream.
+    std::shared_ptr<StreamSignal> stream_signal;
+
+    void set_content_type(std::string_view type) { set_header("Content-Type", type); }
+    void set_header(std::string_view key, std::string_view value) {
+        headers[std::pmr::string(key, headers.get_allocator())] = value;
     }
     void set_keep_alive(bool on);
+    void set_stream(BodyProducer producer, int64_t length = kChunked) {
+        stream        = std::move(producer);
+        stream_length = length;
+    }
+    // A handle to wake this response's stream when its producer has data (an SSE feed
+    // subscribing to an event source), so an idle stream costs nothing while it waits.
+    StreamWaker stream_waker() {
+        if (!stream_signal) stream_signal = std::make_shared<StreamSignal>();
+        return StreamWaker(stream_signal);
+    }
+    uint64_t body_size() const noexcept {
+        if (file.fd >= 0) return file.length;
+        return shared_body ? shared_body->size() : body.size();
+    }
+    // Status line + headers + blank line; the body is queued separately by the server.
+    std::string head() const;
+    // Appends head() to `out` without temporaries (the server writes into a recycled buffer).
+    void write_head(std::string& out) const;
+    // head() + body; a file or streamed body is not included (only the server sends those).
     std::string to_string() const;
 };
 
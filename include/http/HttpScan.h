@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+
+namespace http {
+
+// Vectorized scanning primitives used by HttpParser. The implementation is
+// picked once at startup (AVX2 > SSE4.2 > scalar) from what the CPU supports.
+
+// Offset of the first byte in [p, p+n) that ends or invalidates a header line:
+// '\r', '\n', or a control character other than HTAB (0x00-0x1F, 0x7F).
+// Bytes >= 0x80 (obs-text) are allowed. Returns n if there is none.
+size_t scan_line_end(const char* p, size_t n);
+
+// Offset of the first byte in [p, p+n) that is not an RFC 9110 token character
+// (the end of a method or header name). Returns n if all bytes are tchars.
+size_t scan_token(const char* p, size_t n);
+
+enum class ScanImpl { Scalar, SSE42, AVX2 };
+
+ScanImpl    scan_impl() noexcept;
+const char* scan_impl_name(ScanImpl impl) noexcept;
+// Force an implementation (benchmarks); false if the CPU lacks support for it.
+bool        scan_select(ScanImpl impl) noexcept;
+
+} // namespace http
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+namespace http {
+
+// Monotonic memory resource for everything one request/response pair allocates (response
+// header nodes and strings, a long reason phrase). Allocation bumps a pointer through a
+// chain of 4KB blocks and deallocate does nothing; rewind() drops it all in one step and
+// keeps the first few blocks warm, so at steady state a response costs no malloc at all.
+// Owned by a connection and used only on its event loop thread.
+class RequestArena final : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kBlockSize  = 4096;
+    static constexpr size_t kWarmBlocks = 4;
+
+    RequestArena() = default;
+    ~RequestArena() override;
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    // Invalidates every allocation made since the last rewind. Oversized blocks and blocks
+    // beyond kWarmBlocks go back to the heap.
+    void rewind() noexcept;
+
+    size_t blocks() const noexcept;             // blocks currently held (warm ones included)
+    size_t bytes_used() const noexcept { return used_; } // handed out since the last rewind
+
+private:
+    struct Block {
+        Block* next;
+        size_t size; // including this header
+    };
+
+    void* do_allocate(size_t bytes, size_t align) override;
+    void  do_deallocate(void*, size_t, size_t) noexcept override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+    void enter(Block* b) noexcept;
+
+    Block* head_{nullptr};
+    Block* cur_{nullptr};
+    char*  ptr_{nullptr};
+    char*  end_{nullptr};
+    size_t used_{0};
+};
+
+} // namespace http
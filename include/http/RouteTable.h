@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+
+namespace http {
+
+// String literal usable as a template argument: route<Method::GET, "/hello">(fn).
+template <size_t N>
+struct FixedPath {
+    char chars[N]{};
+
+    constexpr FixedPath(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) chars[i] = s[i];
+    }
+    static constexpr size_t size() noexcept { return N - 1; }
+    constexpr std::string_view view() const noexcept { return {chars, N - 1}; }
+};
+
+// One compile-time route: method and path are template arguments, the handler is
+// stored by value with its own type, so the call is direct and can be inlined.
+template <Method M, FixedPath P, class F>
+struct StaticRoute {
+    static constexpr Method method = M;
+    static constexpr auto   path   = P;
+
+    F fn;
+
+    static_assert(P.size() > 0 && P.chars[0] == '/', "route path must start with '/'");
+    static_assert(P.view().find_first_of(":*") == std::string_view::npos,
+                  "compile-time routes are literal; register patterns on the Router");
+    static_assert(M != Method::UNKNOWN, "route needs a concrete method");
+
+    // 长度是常量：比较先看长度，再由编译器展开成几次按字比较
+    static bool matches(std::string_view p) noexcept {
+        return p.size() == P.size() && std::memcmp(p.data(), P.chars, P.size()) == 0;
+    }
+};
+
+template <Method M, FixedPath P, class F>
+constexpr StaticRoute<M, P, F> route(F fn) {
+    return StaticRoute<M, P, F>{std::move(fn)};
+}
+
+// Routes known at build time. dispatch() is generated per table: for every entry a
+// method test, a length test against a constant and a fixed-size compare, followed by
+// a direct call of that entry's handler. No hashing and no std::function. Install
+// it in front of a Router with Router::set_route_table(); the Router falls back to its
+// radix trees and static mounts, and includes the table in 405 Allow lists.
+template <class... R>
+class RouteTable {
+public:
+    constexpr explicit RouteTable(R... routes) : routes_(std::move(routes)...) {}
+
+    // Calls the matching handler; false when no entry has this method and path.
+    bool dispatch(const HttpRequest& req, HttpResponse& resp) const {
+        return dispatch_impl(req, resp, std::index_sequence_for<R...>{});
+    }
+    // Bit (1 << Method) set for every method registered for `path`.
+    unsigned allowed(std::string_view path) const noexcept {
+        return ((R::matches(path) ? 1u << static_cast<unsigned>(R::method) : 0u) | ... | 0u);
+    }
+    static constexpr size_t size() noexcept { return sizeof...(R); }
+
+private:
+    static constexpr bool unique() {
+        constexpr Method           methods[] = {R::method..., Method::UNKNOWN};
+        constexpr std::string_view paths[]   = {R::path.view()..., std::string_view{}};
+        for (size_t i = 0; i < sizeof...(R); ++i)
+            for (size_t j = i + 1; j < sizeof...(R); ++j)
+                if (methods[i] == methods[j] && paths[i] == paths[j]) return false;
+        return true;
+    }
+    static_assert(unique(), "duplicate (method, path) in route table");
+
+    template <size_t... I>
+    bool dispatch_impl(const HttpRequest& req, HttpResponse& resp, std::index_sequence<I...>) const {
+        const std::string_view p = req.path;
+        const Method           m = req.method;
+        return ((R::method == m && R::matches(p) && (std::get<I>(routes_).fn(req, resp), true)) || ...);
+    }
+
+    std::tuple<R...> routes_;
+};
+
+template <class... R>
+constexpr RouteTable<R...> make_route_table(R... routes) {
+    return RouteTable<R...>(std::move(routes)...);
+}
+
+} // namespace http
@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "http/Task.h"
+
+namespace http {
+
+using Handler = std::function<void(const HttpRequest&, HttpResponse&)>;
+// Coroutine handler: runs on the connection's event loop and may co_await the request
+// body, timers and other non-blocking sockets (server/Coroutine.h) without blocking it.
+// The request stays valid until the returned task finishes.
+using AsyncHandler = std::function<Task<HttpResponse>(const HttpRequest&)>;
+
+// Per-route execution options.
+struct RouteOptions {
+    // Run the handler on the server's worker pool instead of the event loop, for
+    // handlers that block (database calls, parsing big files). Without a pool
+    // (Server::set_workers(0)) the handler still runs inline. Ignored for coroutine
+    // handlers, which always run on the loop.
+    bool     blocking{false};
+    // Requests of this route waiting for or running on the pool, summed over all
+    // loops. Beyond it the route is shed with 503 instead of queueing.
+    unsigned max_queue{64};
+    // Largest request body accepted, in bytes; 0 = the server default (1MB including the
+    // head). A declared Content-Length beyond it is answered 413 before the body is read,
+    // a chunked body as soon as it grows past it.
+    uint64_t max_body{0};
+    // Bodies larger than this many bytes are written to an unlinked temporary file as they
+    // arrive, so memory stays bounded: the handler then finds the body in req.body_file and
+    // req.body is empty. 0 = always in memory. Raise max_body to accept large uploads.
+    uint64_t spill_threshold{0};
+    // Coroutine routes only: the handler starts when the head is complete and pulls the
+    // body piece by piece with co_await net::body_chunk(req) instead of getting it whole.
+    // Reading from the client pauses while the handler lags behind.
+    bool     stream_body{false};
+};
+
+// A registered handler (plain or coroutine, exactly one is set) and its options.
+// Shared read-only between the loops, apart from the admission counter of blocking
+// routes.
+struct Route {
+    Handler                       handler;
+    AsyncHandler                  async;
+    RouteOptions                  opts;
+    uint32_t                      id{0}; // index in Router::routes(), the route's metrics slot
+    mutable std::atomic<unsigned> inflight{0};
+};
+
+// Compressed radix tree mapping path patterns to handlers (the Router keeps one per
+// method). A pattern is literal bytes plus "/:name" segments, each matching one
+// non-empty path segment, and an optional trailing "/*name" catch-all matching the
+// rest of the path (possibly empty). Literal edges win over a parameter, a parameter
+// over the catch-all. Lookup walks the path once, backtracking only out of a literal
+// edge that dead-ends, so its cost follows the path length, not the route count.
+class RouteTree {
+public:
+    // Registers `pattern`; re-adding a pattern replaces its route. Returns false when
+    // the pattern is malformed (no leading '/', ':' or '*' not at a segment start, an
+    // unnamed parameter, '*' not last) or names a parameter differently from a route
+    // already using that position.
+    bool insert(std::string_view pattern, Handler h, const RouteOptions& opts = {}, uint32_t id = 0);
+    bool insert(std::string_view pattern, AsyncHandler h, const RouteOptions& opts = {}, uint32_t id = 0);
+
+    // Route for `path`, or nullptr. Captured parameters are appended to `params`
+    // (left unchanged on a miss).
+    const Route* find(std::string_view path, ParamList& params) const;
+
+    bool empty() const noexcept { return routes_ == 0; }
+
+private:
+    struct Node {
+        std::string                        prefix;  // literal bytes consumed here
+        std::string                        indices; // first byte of each literal child
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node>              param;   // ":name" edge, its name below
+        std::string                        param_name;
+        std::string                        catch_all_name;
+        std::unique_ptr<Route>             catch_all;
+        std::unique_ptr<Route>             route;
+    };
+
+    bool insert_route(std::string_view pattern, std::unique_ptr<Route> r);
+    static void split(Node& n, size_t at);
+    static const Route* match(const Node& n, std::string_view path, ParamList& params);
+
+    Node   root_;
+    size_t routes_{0};
+};
+
+} // namespace http
@@ -1,45 +1,142 @@
 #pragma once
-#include <functional>
+#include <array>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
+#include "http/Compression.h"
 #include "http/HttpRequest.h"
 #include "http/HttpResponse.h"
+#include "http/RouteTree.h"
+#include "http/StaticFile.h"
 
 namespace http { // 整个都在http命名空间下
 
-using Handler = std::function<void(const HttpRequest&, HttpResponse&)>;
+// "GET", "POST", ...; empty for Method::UNKNOWN.
+std::string_view method_name(Method m) noexcept;
 
-struct RouteKey {
-    Method method;
-    std::string path;
-    bool operator==(const RouteKey& other) const { return method == other.method && path == other.path; }
-};
+class Router {
+public:
+    // What a route id (Route::id) stands for, e.g. in metrics labels. The first ids are
+    // pseudo-routes for answers that no registered pattern produced; registered patterns
+    // follow in registration order, and re-adding a pattern keeps its id.
+    struct RouteInfo {
+        Method      method;
+        std::string pattern;
+    };
+    static constexpr uint32_t kUnmatchedRoute = 0; // 404 / 405, and errors before routing
+    static constexpr uint32_t kStaticRoute    = 1; // files under set_static() mounts
+    static constexpr uint32_t kTableRoute     = 2; // the compile-time route table
 
-struct RouteKeyHash {
-    std::size_t operator()(const RouteKey& k) const {
-        return (static_cast<std::size_t>(k.method) << 32) ^ std::hash<std::string>()(k.path);
+    void get(const std::string& path, Handler h, const RouteOptions& opts = {}) {
+        add(Method::GET, path, std::move(h), opts);
     }
-};
+    void post(const std::string& path, Handler h, const RouteOptions& opts = {}) {
+        add(Method::POST, path, std::move(h), opts);
+    }
+    // 协程处理函数：返回 Task<HttpResponse>，在连接所属的 loop 上运行
+    void get(const std::string& path, AsyncHandler h, const RouteOptions& opts = {}) {
+        add(Method::GET, path, std::move(h), opts);
+    }
+    void post(const std::string& path, AsyncHandler h, const RouteOptions& opts = {}) {
+        add(Method::POST, path, std::move(h), opts);
+    }
+    // 添加 方法+路径模式->处理函数 的映射，模式支持 "/users/:id" 与 "/files/*rest"；
+    // 模式非法或参数名与已有路由冲突时返回 false
+    bool add(Method m, const std::string& path, Handler h, const RouteOptions& opts = {});
+    bool add(Method m, const std::string& path, AsyncHandler h, const RouteOptions& opts = {});
 
-class Router {
-public:
-    void get(const std::string& path, Handler h) { add(Method::GET, path, std::move(h)); }
-    void post(const std::string& path, Handler h) { add(Method::POST, path, std::move(h)); }
-    void add(Method m, const std::string& path, Handler h) { //添加 路径+方法->处理函数 的映射
-        routes_[RouteKey{m, path}] = std::move(h);
+    // Dispatches a request: the compile-time table if one is set, the route trees
+    // (captured parameters go to req.params), then the static mounts. A path that only
+    // matches under other methods is answered 405 with Allow. Returns false when
+    // nothing matches (404). Blocking routes run inline here; a coroutine route is run
+    // until it first suspends, and answered 500 if it did not finish by then (its
+    // awaitables need an event loop).
+    bool route(HttpRequest& req, HttpResponse& resp) const;
+
+    enum class Dispatch { NotFound, Done, Deferred, Coroutine };
+    // Like route(), except that a blocking route is not run (when `offload`, otherwise
+    // it runs inline): when its queue has room a slot is taken and Deferred is returned;
+    // the caller then runs `route` elsewhere with run_deferred(). A full queue is
+    // answered 503. For a coroutine route Coroutine is returned; the caller drives the
+    // task from route->async(req) and passes its response to finish().
+    // `route` is set to whatever answers the request: the registered route, or the
+    // static / table pseudo-route (only its id is meaningful); nullptr when nothing
+    // matched or the answer is a 405.
+    Dispatch dispatch(HttpRequest& req, HttpResponse& resp, const Route*& route, bool offload = true) const;
+    // Runs a deferred route (handler, then compression) and releases its slot.
+    void run_deferred(const Route& r, const HttpRequest& req, HttpResponse& resp) const;
+    // Post-processing of a response produced outside route() (compression).
+    void finish(const HttpRequest& req, HttpResponse& resp) const { compress_response(req, resp, compress_); }
+
+    // Route ids and what they stand for, indexed by Route::id.
+    const std::vector<RouteInfo>& routes() const noexcept { return infos_; }
+
+    // Whether any coroutine route is registered.
+    bool has_coroutines() const noexcept { return coroutines_; }
+    // Coroutine route for a request whose headers are parsed but whose body is still
+    // arriving (parameters go to req.params), or nullptr. Such a handler starts right
+    // away and waits for the body itself; anything else waits for the full request.
+    const Route* match_coroutine(HttpRequest& req) const;
+    // Tree route of any kind for a request whose headers are parsed, or nullptr (no route,
+    // or the path belongs to the compile-time table): the server reads its body options
+    // (RouteOptions::max_body, spill_threshold, stream_body) before the body arrives.
+    const Route* match_route(HttpRequest& req) const;
+    // Whether any route sets body options.
+    bool has_body_options() const noexcept { return body_options_; }
+    // Releases the slot of a deferred route that will not run.
+    static void cancel_deferred(const Route& r) noexcept { r.inflight.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Consult a compile-time RouteTable (RouteTable.h) before the trees. The table is
+    // not copied and must outlive the router.
+    template <class Table>
+    void set_route_table(const Table& table) {
+        table_ = &table;
+        table_dispatch_ = [](const void* t, const HttpRequest& req, HttpResponse& resp) {
+            return static_cast<const Table*>(t)->dispatch(req, resp);
+        };
+        table_allowed_ = [](const void* t, std::string_view path) {
+            return static_cast<const Table*>(t)->allowed(path);
+        };
     }
-    bool route(const HttpRequest& req, HttpResponse& resp) const;
 
-    // simple static file serving under a prefix mapping to a root directory
-    void set_static(const std::string& url_prefix, const std::string& dir_root) {
-        static_prefix_ = url_prefix; static_root_ = dir_root;
+    // serve files under dir_root for GET / HEAD below url_prefix; mounts can be
+    // combined (the longest matching prefix wins), the same prefix is replaced
+    void set_static(const std::string& url_prefix, const std::string& dir_root);
+    // in-memory cache for small static files (per event loop); max_bytes = 0 disables it
+    void set_static_cache(size_t max_bytes, size_t max_file_bytes = 256 * 1024) {
+        static_opts_.cache_bytes = max_bytes; static_opts_.cache_max_file = max_file_bytes;
     }
+    // serve precompressed "<file>.br" / "<file>.gz" siblings when the client accepts them
+    void set_static_precompressed(bool on) { static_opts_.precompressed = on; }
+    // on-the-fly gzip / br of handler responses (off by default)
+    void set_compression(const CompressOptions& opts) { compress_ = opts; }
 
 private:
-    std::unordered_map<RouteKey, Handler, RouteKeyHash> routes_;
-    std::string static_prefix_;
-    std::string static_root_;
+    static constexpr size_t kMethods = static_cast<size_t>(Method::UNKNOWN);
+
+    struct StaticMount {
+        std::string prefix; // without trailing '/'
+        std::string root;
+    };
+
+    Dispatch dispatch_impl(HttpRequest& req, HttpResponse& resp, const Route*& route, bool offload) const;
+    uint32_t route_id(Method m, const std::string& path) const;
+    void     name_route(uint32_t id, Method m, const std::string& path);
+    const StaticMount* find_mount(std::string_view path) const;
+    void method_not_allowed(std::string_view path, HttpResponse& resp) const;
+
+    // 编译期路由表：类型在 set_route_table 处擦除成两个函数指针，表内的处理函数仍是直接调用
+    const void* table_{nullptr};
+    bool (*table_dispatch_)(const void*, const HttpRequest&, HttpResponse&){nullptr};
+    unsigned (*table_allowed_)(const void*, std::string_view){nullptr};
+
+    std::array<RouteTree, kMethods> trees_;
+    std::vector<StaticMount> mounts_; // 按前缀长度降序
+    std::vector<RouteInfo> infos_{{Method::UNKNOWN, "unmatched"}, {Method::UNKNOWN, "static"}, {Method::UNKNOWN, "table"}};
+    bool coroutines_{false};
+    bool body_options_{false};
+    StaticOptions static_opts_;
+    CompressOptions compress_;
 };
 
 } // namespace http
-
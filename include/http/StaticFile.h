@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+
+namespace http {
+
+// Content-Type from the file extension (application/octet-stream when unknown).
+std::string_view mime_type(std::string_view path);
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+std::string http_date(int64_t unix_seconds);
+// Inverse of http_date (IMF-fixdate only); -1 for anything else.
+int64_t parse_http_date(std::string_view s);
+
+// RFC 9110 section 13.1: true when a GET/HEAD may be answered with 304. If-None-Match
+// (weak comparison, "*" allowed) takes precedence over If-Modified-Since.
+bool not_modified(const HttpRequest& req, std::string_view etag, int64_t mtime_seconds);
+
+enum class RangeResult { None, Ok, Unsatisfiable };
+
+// Parses a single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range against a
+// representation of `size` bytes, yielding the inclusive [first, last]. Multiple ranges,
+// other units and malformed values give None: the header is ignored and the whole file
+// is served, as RFC 9110 allows.
+RangeResult parse_range(std::string_view value, uint64_t size, uint64_t& first, uint64_t& last);
+
+struct StaticOptions {
+    // Per-loop budget of the in-memory asset cache; 0 disables it.
+    size_t cache_bytes{32 * 1024 * 1024};
+    // Files up to this size are cached in memory, larger ones are sent with sendfile.
+    size_t cache_max_file{256 * 1024};
+    // Serve "<file>.br" / "<file>.gz" siblings to clients that accept them.
+    bool precompressed{true};
+};
+
+// Serves the regular file at `path` as 200, 304, 206 (satisfiable Range whose If-Range,
+// if any, still matches), 416 or 404, with a strong ETag and Last-Modified.
+// Small files come from a per-thread LRU cache holding the body and pre-serialized
+// headers; everything else is attached as a FileRange from a per-thread cache of open
+// descriptors and sent with sendfile, so memory use does not depend on the file size.
+// Cached entries are revalidated against mtime / size / inode; on Linux an inotify
+// watch on their directories makes that a single atomic load until something changes.
+// For compressible types a precompressed "<path>.br" or "<path>.gz" sibling is sent
+// instead when the client accepts it (Content-Encoding, Vary: Accept-Encoding).
+void serve_file(const HttpRequest& req, HttpResponse& resp, const std::string& path,
+                const StaticOptions& opts = {});
+
+} // namespace http
@@ -0,0 +1,129 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace http {
+
+// Free-list allocator for coroutine frames. Blocks are kept per size class (64-byte
+// steps up to 2KB) in thread-local lists, so a frame that is created and destroyed on
+// the same event loop costs a pointer pop and push instead of malloc/free. Larger
+// frames, and every frame under AddressSanitizer, go to operator new.
+struct FramePool {
+    static void* allocate(size_t n);
+    static void  deallocate(void* p, size_t n) noexcept;
+};
+
+template <class T>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation; // the awaiting coroutine, none for a top-level task
+    std::exception_ptr      error;
+
+    // Lazy: nothing runs until the task is awaited or resumed by its owner.
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    // Hands control back to the awaiting coroutine without growing the stack; a
+    // top-level task just stops, and its owner sees done().
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+            if (auto c = h.promise().continuation) return c;
+            return std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    static void* operator new(size_t n) { return FramePool::allocate(n); }
+    static void  operator delete(void* p, size_t n) noexcept { FramePool::deallocate(p, n); }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+    template <class U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+};
+
+} // namespace detail
+
+// Coroutine result type: `Task<HttpResponse>` for coroutine route handlers, any
+// Task<T> for helpers they co_await. Starts suspended; co_await runs it to
+// completion and yields its value (or rethrows its exception). The frame belongs to
+// the Task and is destroyed with it, suspended or not.
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+    using handle_type  = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(handle_type h) noexcept : h_(h) {}
+    Task(Task&& o) noexcept : h_(std::exchange(o.h_, {})) {}
+    Task& operator=(Task&& o) noexcept {
+        if (this != &o) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(o.h_, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (h_) h_.destroy();
+    }
+
+    explicit operator bool() const noexcept { return static_cast<bool>(h_); }
+
+    // Owner interface (the event loop): resume() starts a top-level task; later
+    // resumptions go to whichever frame of the chain suspended.
+    bool done() const noexcept { return h_.done(); }
+    void resume() const { h_.resume(); }
+    // After done(): whether the coroutine ended with an exception instead of a value.
+    bool failed() const noexcept { return static_cast<bool>(h_.promise().error); }
+    T result() {
+        if (h_.promise().error) std::rethrow_exception(h_.promise().error);
+        if constexpr (!std::is_void_v<T>) return std::move(*h_.promise().value);
+    }
+
+    bool await_ready() const noexcept { return !h_ || h_.done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        h_.promise().continuation = awaiting;
+        return h_; // symmetric transfer: start the child on this stack frame's behalf
+    }
+    T await_resume() { return result(); }
+
+private:
+    handle_type h_;
+};
+
+namespace detail {
+
+template <class T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+} // namespace http
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace http {
+
+// WebSocket (RFC 6455), server side: the handshake key, a parser for client frames
+// (always masked, possibly fragmented, with control frames in between) and serialization
+// of server frames. No extension is negotiated, so the RSV bits must be zero.
+
+// Sec-WebSocket-Accept for a client's Sec-WebSocket-Key: base64(SHA-1(key + GUID)).
+std::string ws_accept_key(std::string_view key);
+
+// XORs p[0, n) in place with the 4-byte masking key as it appears on the wire, starting
+// at key byte `phase` (0-3). The implementation is picked once at startup like the header
+// scanners (HttpScan.h): AVX2 > SSE2 on x86, NEON on ARM, 64-bit words otherwise.
+void ws_unmask(char* p, size_t n, const uint8_t key[4], size_t phase = 0) noexcept;
+
+enum class UnmaskImpl { Scalar, SSE2, AVX2, NEON };
+
+UnmaskImpl  unmask_impl() noexcept;
+const char* unmask_impl_name(UnmaskImpl impl) noexcept;
+// Force an implementation (benchmarks); false if the CPU lacks support for it.
+bool        unmask_select(UnmaskImpl impl) noexcept;
+
+// Whether s is well-formed UTF-8: no overlong forms, surrogates or code points past
+// U+10FFFF. ASCII runs are checked eight bytes at a time.
+bool utf8_valid(std::string_view s) noexcept;
+
+enum class WsOpcode : uint8_t {
+    Continuation = 0x0,
+    Text         = 0x1,
+    Binary       = 0x2,
+    Close        = 0x8,
+    Ping         = 0x9,
+    Pong         = 0xA,
+};
+
+// Close status codes (section 7.4.1) the server sends or reports.
+constexpr uint16_t kWsCloseNormal      = 1000;
+constexpr uint16_t kWsCloseGoingAway   = 1001;
+constexpr uint16_t kWsCloseProtocol    = 1002;
+constexpr uint16_t kWsCloseNoStatus    = 1005; // a Close frame without a code (never sent)
+constexpr uint16_t kWsCloseAbnormal    = 1006; // the connection ended without a Close (never sent)
+constexpr uint16_t kWsCloseInvalidData = 1007;
+constexpr uint16_t kWsClosePolicy      = 1008;
+constexpr uint16_t kWsCloseTooBig      = 1009;
+
+// Appends the header of an unmasked server frame carrying `len` payload bytes.
+void ws_frame_header(WsOpcode op, uint64_t len, std::string& out, bool fin = true);
+// Appends a whole unmasked frame.
+void ws_frame(WsOpcode op, std::string_view payload, std::string& out);
+// Appends a Close frame; code 0 sends one without a status (the reply to a Close that
+// had none). The reason is cut to fit the 125-byte control frame limit.
+void ws_close_frame(uint16_t code, std::string_view reason, std::string& out);
+
+// A server-to-client message serialized once: frame header and payload in one immutable
+// shared buffer, so sending it to many connections only queues a reference to it.
+class WsMessage {
+public:
+    WsMessage() = default;
+    static WsMessage text(std::string_view payload) { return WsMessage(WsOpcode::Text, payload); }
+    static WsMessage binary(std::string_view payload) { return WsMessage(WsOpcode::Binary, payload); }
+
+    bool empty() const noexcept { return !frame_; }
+    const std::shared_ptr<const std::string>& frame() const noexcept { return frame_; }
+
+private:
+    WsMessage(WsOpcode op, std::string_view payload);
+
+    std::shared_ptr<const std::string> frame_;
+};
+
+// One thing WsParser::parse found at the front of the buffer.
+struct WsEvent {
+    enum class Kind : uint8_t { None, Message, Ping, Pong, Close, Error };
+
+    Kind             kind{Kind::None};
+    bool             binary{false}; // Message
+    uint16_t         code{0};       // Close: the peer's status (kWsCloseNoStatus if none); Error: status to close with
+    std::string_view data;          // Message / Ping / Pong payload, Close reason
+};
+
+// Incremental parser for client frames. Each parse() call takes at most one complete frame
+// off the front of the buffer and unmasks its payload in place. A message in a single
+// frame is returned as a view into the buffer; fragments are collected in the parser and
+// the message is returned from there once the final one arrives. Control frames between
+// fragments are returned as they come. A frame announcing more than the message limit is
+// rejected from its header, before its payload is buffered. Text messages and close
+// reasons must be valid UTF-8.
+class WsParser {
+public:
+    explicit WsParser(size_t max_message) : max_(max_message) {}
+
+    // Bytes consumed, 0 (with Kind::None) while the frame at the front is incomplete.
+    // Views in `ev` stay valid until the next call and while the consumed bytes are kept.
+    // Nothing more should be parsed after an Error or a Close.
+    size_t parse(char* p, size_t n, WsEvent& ev);
+
+private:
+    std::string message_; // fragments received so far
+    size_t      max_;
+    bool        fragmented_{false};
+    bool        binary_{false};
+};
+
+} // namespace http
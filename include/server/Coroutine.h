@@ -0,0 +1,89 @@
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <string_view>
+
+#include "http/HttpRequest.h"
+#include "http/Task.h"
+#include "server/EventLoop.h"
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+// 协程路由（返回 http::Task<http::HttpResponse> 的处理函数）里可以 co_await 的操作。
+// 都在连接所属的 loop 线程上完成：挂起期间不占线程，只占协程帧。
+// 一个请求同一时刻只能等一件事（没有 when_all）；不在 loop 上运行时（例如直接调用
+// Router::route）这些操作不挂起：sleep 立即返回，fd 等待返回 false。
+
+// 定时器，毫秒精度
+struct SleepAwaiter {
+    EventLoop::Clock::time_point until;
+
+    bool await_ready() const noexcept { return until <= EventLoop::Clock::now(); }
+    bool await_suspend(std::coroutine_handle<> h) const { return EventLoop::suspend_until(until, h); }
+    void await_resume() const noexcept {}
+};
+
+template <class Rep, class Period>
+SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> d) {
+    return {EventLoop::Clock::now() + std::chrono::ceil<EventLoop::Clock::duration>(d)};
+}
+
+// 等一个非阻塞 fd（例如到上游的 socket）可读 / 可写；返回 false 表示等不了：
+// 不在 loop 上、该 fd 已有协程在等，或后端无法注册它（select 的 FD_SETSIZE）
+struct FdAwaiter {
+    socket_t fd;
+    bool     write;
+    bool     ok{true};
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) {
+        ok = EventLoop::suspend_on_fd(fd, write, h);
+        return ok;
+    }
+    bool await_resume() const noexcept { return ok; }
+};
+
+inline FdAwaiter readable(socket_t fd) { return {fd, false}; }
+inline FdAwaiter writable(socket_t fd) { return {fd, true}; }
+
+// 等请求体收齐并返回它。协程路由在请求头完整时就开始运行，此前 req.body 为空；
+// 恢复后 req.body 指向完整的请求体
+struct BodyAwaiter {
+    const http::HttpRequest& req;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> h) const { return EventLoop::suspend_on_body(h); }
+    std::string_view await_resume() const noexcept { return req.body; }
+};
+
+inline BodyAwaiter request_body(const http::HttpRequest& req) { return {req}; }
+
+// 取请求体的下一块，空表示已取完。RouteOptions::stream_body 的路由边收边交出，
+// 返回的视图到下一次 body_chunk 之前有效；处理函数取得慢时 loop 暂停读这个连接，
+// 积压不超过几百 KB（此时 request_body 不等待，返回空）。其他路由在请求体收齐后
+// 把它整个作为一块交出。不在 loop 上运行时直接返回空
+struct BodyChunkAwaiter {
+    std::string_view chunk;
+    bool             ready{false};
+
+    bool await_ready() noexcept { return ready = EventLoop::take_body_chunk(chunk); }
+    bool await_suspend(std::coroutine_handle<> h) const { return EventLoop::suspend_on_body(h, true); }
+    std::string_view await_resume() noexcept {
+        if (!ready) EventLoop::take_body_chunk(chunk);
+        return chunk;
+    }
+};
+
+// req 只用来标明取的是哪个请求的请求体（与 request_body 对称）
+inline BodyChunkAwaiter body_chunk(const http::HttpRequest&) { return {}; }
+
+// 非阻塞 socket 上的协程版收发：先直接调用，EAGAIN 时挂起等就绪
+// 返回收到的字节数，0 为对端关闭，-1 为出错
+http::Task<ssize_t> async_recv(socket_t fd, char* buf, size_t len);
+// 全部发完返回 len，出错返回 -1
+http::Task<ssize_t> async_send(socket_t fd, const char* data, size_t len);
+// 非阻塞 connect，连上返回 true
+http::Task<bool> async_connect(socket_t fd, const sockaddr* addr, socklen_t len);
+
+} // namespace net
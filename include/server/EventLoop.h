@@ -0,0 +1,514 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "http/Router.h"
+#include "http/BodyDecoder.h"
+#include "http/HttpParser.h"
+#include "http/RequestArena.h"
+#include "http/Task.h"
+#include "server/FdTable.h"
+#include "server/H2Session.h"
+#include "server/Metrics.h"
+#include "server/MpscQueue.h"
+#include "server/OutputQueue.h"
+#include "server/PlatformSocket.h"
+#include "server/Poller.h"
+#include "server/SpillFile.h"
+#include "server/TimerWheel.h"
+#include "server/Trace.h"
+#include "server/Waker.h"
+#include "server/WebSocket.h"
+#include "server/WorkerPool.h"
+#ifdef __linux__
+#include "server/IoUring.h"
+#include <sys/uio.h>
+#endif
+
+namespace net {
+
+#ifdef __linux__
+// io_uring SENDMSG 的参数：内核完成前必须保持不动，所以跟着连接走
+struct UringSend {
+    static constexpr size_t kMaxIov = 16;
+    msghdr msg{};
+    iovec  iov[kMaxIov]{};
+};
+#endif
+
+// 在本 loop 上运行的协程路由：请求字节的副本、协程本身，以及它此刻挂起在什么上。
+// 请求体还没收齐时就已启动（头部一完整），请求体到齐后放进 body；
+// 流式请求体（RouteOptions::stream_body）则边收边放进 body_next，由 body_chunk 一块块取走。
+// HTTP/2 连接上每个流各有一个，请求收齐才启动
+struct CoroCall {
+    enum class Wait : uint8_t { None, Timer, Fd, Body };
+
+    socket_t                       fd{};           // 所属连接
+    uint32_t                       gen{0};
+    uint32_t                       h2_stream{0};   // HTTP/2 连接上的流，0 为 HTTP/1.1 的请求
+    std::string                    raw;            // req 的视图指向这里
+    http::HttpRequest              req;
+    std::string                    body;           // 后到的请求体；流式时是最近取走的一块
+    std::string                    body_next;      // 流式：已收到、还没被取走的数据
+    bool                           body_ready{false};
+    bool                           body_taken{false}; // 非流式的 body_chunk：整个请求体已作为一块交出
+    bool                           stream{false};
+    bool                           responded{false}; // 响应已入队，只差请求体收齐
+    Wait                           wait{Wait::None};
+    uint32_t                       route_id{0};    // 指标：路由编号与开始时间
+    std::chrono::steady_clock::time_point start;
+    uint32_t                       wait_seq{0};    // 本次 fd 等待的编号，过期的就绪事件据此丢弃
+    socket_t                       wait_fd{kInvalidSocket};
+    TimerNode                      timer;          // sleep 用，随调用一起销毁即撤销
+    std::coroutine_handle<>        waiter;         // 挂起的那一帧（可能是被 co_await 的子任务）
+    http::Task<http::HttpResponse> task;           // 最后声明：先于 req 销毁
+};
+
+// 连接超时（毫秒，0 表示不限制）。连接任一时刻只处在一个阶段，只有一个定时器在计时
+struct Timeouts {
+    uint32_t keep_alive_ms{60000}; // 上一个响应发完后等下一个请求
+    uint32_t header_ms{10000};     // 请求头从开始（或连接建立）到收齐，超时返回 408
+    uint32_t body_ms{30000};       // 请求体两次收到数据之间，超时返回 408
+    uint32_t write_ms{30000};      // 响应两次发出数据之间（对端不读），超时直接关闭
+};
+
+// 流式响应（HttpResponse::stream）：响应头入队后，输出队列低于低水位时由 loop 向生产者
+// 拉下一块，按 chunked 或原样（已知长度 / 读到连接关闭为止）分帧入队。
+// 流结束前连接上后续的 pipelined 请求只收不处理，和异步请求一样
+struct ResponseStream {
+    ~ResponseStream() {
+        if (signal) signal->unbind(); // 之后的 wake() 不再投递到本 loop
+    }
+
+    http::HttpResponse::BodyProducer    producer;
+    std::string                         chunk;     // 交给生产者填的缓冲，入队时移走
+    TimerNode                           timer;     // 生产者暂时没有数据、又没有 waker：过一会儿再拉
+    std::shared_ptr<http::StreamSignal> signal;    // HttpResponse::stream_waker()：有数据时由它唤醒
+    bool                                chunked{true};
+    bool                                waiting{false}; // 生产者暂时没有数据，等唤醒或重试
+};
+
+// 不整块留在 inbuf 里的请求体（RouteOptions::stream_body / spill_threshold）：
+// loop 自己解码，边收边交给协程或写进临时文件，inbuf 里只留请求头和还没解码的尾巴
+struct RequestBody {
+    http::BodyDecoder          decoder;
+    std::shared_ptr<SpillFile> file;          // 超过阈值后落盘
+    std::string                mem;           // 阈值以内先放内存
+    uint64_t                   limit{0};      // 请求体上限
+    uint64_t                   spill_threshold{0};
+    size_t                     head{0};       // inbuf 开头请求头的长度
+    bool                       stream{false}; // 交给协程（CoroCall::body_next），否则落盘
+};
+
+// 开启追踪时连接上的请求记录：正在处理的一个，和响应已入队、等发完的那些（pipelining）。
+// 字节数是连接输出流里的位置，发送推进到某条记录的 end_offset 即为该响应发完
+struct ConnTrace {
+    TraceRecord              cur;
+    std::vector<TraceRecord> sending;
+    uint64_t                 last_recv{0}; // 最近一次收到数据的 tick
+    uint64_t                 queued{0};
+    uint64_t                 sent{0};
+
+    void reset() noexcept {
+        cur = TraceRecord{};
+        sending.clear();
+        last_recv = queued = sent = 0;
+    }
+};
+
+// 连接只在收发数据期间需要的状态：输入缓冲、解析器、输出队列。
+// 从 loop 的池里借，连接回到空闲（没有未完成的请求、待发数据和异步请求）时还回去，
+// 空闲的 keep-alive 连接只剩 Connection 本身
+struct ConnIo {
+    std::string        inbuf;
+    http::HttpParser   parser;
+    OutputQueue        out;          // 待发送的响应（头 / 体分段）
+    http::RequestArena arena;        // 同步路由的响应头在这里分配，每个请求开始前回卷
+    std::unique_ptr<ConnTrace> trace; // 开启追踪的 loop 上才有
+    std::unique_ptr<ResponseStream> stream; // 正在发送的流式响应
+    std::unique_ptr<RequestBody>    body;   // 正在边收边处理的请求体
+    size_t             max_request{0};       // 当前请求在 inbuf 里的上限（路由的 max_body），0 为默认
+#ifdef __linux__
+    UringSend          send;         // io_uring 后端：发送中时借用不会归还，地址不变
+#endif
+};
+
+// HTTP/2 连接（h2c）：协议状态，以及各流在本 loop 上的处理。同步路由当场答复，
+// blocking 路由交给工作线程、协程路由各占一个 CoroCall，同一连接上可以同时有很多个，
+// 谁先做完谁先答复。跟着 Connection 走：空闲时 ConnIo 照样还回池里，HPACK 的动态表不丢
+struct H2Conn {
+    explicit H2Conn(std::function<uint64_t(http::HttpRequest&)> body_limit) : session(std::move(body_limit)) {}
+
+    H2Session                                               session;
+    std::unordered_map<uint32_t, std::unique_ptr<CoroCall>> calls;  // 按流编号
+    TimerNode                                               retry;  // 流式响应的生产者暂时没有数据
+    uint32_t                                                next_call{0}; // 协程定时器的编号
+};
+
+// 升级成 WebSocket 的连接：交给回调的句柄、帧解析状态和订阅的频道。跟着 Connection 走，
+// 空闲时 ConnIo 照样还回池里，没收齐的分片消息留在 parser 里
+struct WsConn {
+    WsConn(WebSocket s, std::shared_ptr<const WsHandlers> h)
+        : socket(s), handlers(std::move(h)), parser(handlers->max_message) {}
+
+    WebSocket                         socket;
+    std::shared_ptr<const WsHandlers> handlers;
+    http::WsParser                    parser;
+    std::vector<WsChannel*>           channels;           // 订阅的频道，结束时逐个退订
+    bool                              close_sent{false};  // 已发出 Close（或连接已结束）：不再发送
+    bool                              finished{false};    // on_close 已调用
+    bool                              flush_pending{false}; // 已登记到本轮末尾发送
+    bool                              overflow{false};    // 待发超过 max_backlog：不再入队，本轮末尾断开
+};
+
+struct Connection {
+    // 超时按阶段计：工作线程 / 协程处理期间（Busy）不计时
+    enum class Phase : uint8_t { Header, Body, Idle, Write, Busy };
+
+    explicit Connection(socket_t s) noexcept : fd(s) {}
+
+    socket_t         fd{};
+    std::unique_ptr<ConnIo> io;      // 有数据在收发时才有
+    bool             keep_alive{true};
+    bool             async_pending{false}; // 有请求在工作线程 / 协程里：后续请求等它的响应入队后再处理
+    bool             body_probed{false};   // 当前请求已在头部完整时按路由决定过请求体怎么收
+    bool             read_paused{false};   // 流式请求体：处理函数跟不上，暂停从 socket 读
+    uint32_t         gen{0};          // 区分 fd 复用：过期的 CQE / 工作线程的响应直接丢弃
+    std::unique_ptr<CoroCall> call;   // 进行中的协程路由，连接关闭时连同协程帧一起销毁
+    std::unique_ptr<H2Conn> h2;       // 已切换到 HTTP/2
+    std::unique_ptr<WsConn> ws;       // 已升级为 WebSocket
+
+    // 超时：时间都是 loop 的毫秒 tick
+    TimerNode        timer;
+    uint64_t         deadline{0};     // 当前阶段的截止时间，0 为不计时；只提前不推后地改挂定时器
+    uint64_t         phase_since{0};
+    uint64_t         last_read{0};
+    uint64_t         last_write{0};
+    uint32_t         responses{0};    // 已入队的响应数：变化说明有进展，阶段重新计时
+    uint32_t         phase_responses{0};
+    Phase            phase{Phase::Header};
+
+    // io_uring 后端专用：发送中的段由 out.pin() 锁定，完成前保持不动
+    uint8_t          ops_inflight{0}; // 已提交未完成的 recv / send 数
+    bool             recv_armed{false};
+    bool             send_inflight{false};
+    bool             closing{false};
+
+    bool has_output() const noexcept { return io && !io->out.empty(); }
+    bool streaming() const noexcept { return io && io->stream; }
+};
+
+// 每个 loop 的计数器，只由本 loop 线程写
+struct LoopStats {
+    uint64_t requests{0};
+    uint64_t syscalls{0}; // 本 loop 发起的系统调用（recv/send/accept/poll/epoll_ctl/io_uring_enter/close）
+
+    LoopStats& operator+=(const LoopStats& o) noexcept {
+        requests += o.requests;
+        syscalls += o.syscalls;
+        return *this;
+    }
+};
+
+// 单个 reactor：自己的监听 socket、Poller 与连接表，只在一个线程上运行。
+// 多个 EventLoop 之间不共享可变状态，Router 以只读方式共享。
+// 有 WorkerPool 时，blocking 路由在池里执行，响应经无锁队列 + Waker 交回本 loop。
+// 协程路由在本 loop 上运行，挂起时只占协程帧，由定时器 / fd 就绪 / 请求体到齐恢复。
+// 连接超时和协程的定时器挂在同一个分层时间轮上，poll 等待到最近的一个到期为止。
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    EventLoop(const http::Router* router, Backend backend, WorkerPool* pool = nullptr)
+        : router_(router), backend_(backend), now_(now_ms()), wheel_(now_),
+          metrics_(std::make_shared<LoopMetrics>(router ? router->routes().size() : 1)), pool_(pool) {}
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 创建监听 socket 并初始化 Poller；reuse_port 时设置 SO_REUSEPORT，
+    // 让内核在多个 loop 的监听 socket 之间分发新连接
+    [[nodiscard]] bool open(uint16_t port, bool reuse_port);
+
+    // 运行直到 running 变为 false（最多延迟一个 poll 超时）
+    void run(const std::atomic<bool>& running);
+
+    Backend backend() const noexcept;
+
+    // run 之前调用
+    void set_timeouts(const Timeouts& t) noexcept { timeouts_ = t; }
+
+    // 内置端点（指标、追踪）：GET path 由 render 生成响应体，在 Router 之前匹配。run 之前调用
+    void add_endpoint(std::string path, std::string content_type, std::function<std::string()> render) {
+        endpoints_.push_back(Endpoint{std::move(path), std::move(content_type), std::move(render)});
+    }
+    // 每轮事件处理完调用一次（最迟隔一个 poll 超时），run 之前设置
+    void set_tick_hook(std::function<void()> hook) { tick_hook_ = std::move(hook); }
+    // 本 loop 的指标，任意线程可读；loop 销毁后仍然有效
+    std::shared_ptr<const LoopMetrics> metrics() const noexcept { return metrics_; }
+    // 开启请求追踪（opts 两个条件都为 0 时不开），run 之前调用
+    void set_tracing(const TraceOptions& opts, unsigned loop_index);
+    // 本 loop 的追踪记录，未开启时为空；同 metrics()
+    std::shared_ptr<const TraceRing> tracer() const noexcept { return tracer_; }
+
+    // 任意线程调用：把做完的任务交回本 loop（由 drain_completions 在 loop 线程上收尾）
+    void post(Task* done) noexcept;
+
+    // 供 Coroutine.h 的 awaitable 使用：把本线程 loop 上正在运行的协程路由挂到
+    // 定时器 / fd / 请求体上，h 是要恢复的那一帧。返回 false 表示不挂起：不在 loop 的
+    // 协程里（例如 Router::route 直接调用）、fd 已有人在等或无法注册、请求体已收齐。
+    static bool suspend_until(Clock::time_point t, std::coroutine_handle<> h);
+    static bool suspend_on_fd(socket_t fd, bool write, std::coroutine_handle<> h);
+    // chunk：等 body_chunk 的下一块（流式请求体），否则等请求体收齐；流式请求体不能整个等
+    static bool suspend_on_body(std::coroutine_handle<> h, bool chunk = false);
+    // 供 body_chunk：取下一块请求体放进 out，返回 false 表示还没有、需要挂起等待。
+    // 流式请求体取走后可能恢复从 socket 读；非流式的请求体收齐后整个作为一块交出一次
+    static bool take_body_chunk(std::string_view& out);
+    // 落盘请求体的临时目录，空为系统临时目录；run 之前调用
+    void set_spill_dir(std::string dir) { spill_dir_ = std::move(dir); }
+    // WebSocket 端点：GET path 带 Upgrade: websocket 的请求升级，在 Router 之前匹配。run 之前调用
+    void add_websocket(std::string path, std::shared_ptr<const WsHandlers> handlers) {
+        ws_routes_.push_back(WsRoute{std::move(path), std::move(handlers)});
+    }
+    // 接受 HTTP/2 明文连接（prior knowledge 与 Upgrade: h2c），默认开启；run 之前调用
+    void set_http2(bool on) noexcept { http2_ = on; }
+    // run 返回后读取才是准确的
+    const LoopStats& stats() const noexcept { return stats_; }
+
+private:
+    friend class WebSocket; // 句柄与频道经由 loop 入队 / 订阅
+    friend class WsChannel;
+
+    static void        close_socket(socket_t s) noexcept;
+    static bool        set_nonblocking(socket_t s) noexcept;
+    [[nodiscard]] bool handle_read(Connection& c);
+    [[nodiscard]] bool handle_write(Connection& c);
+    [[nodiscard]] bool process_input(Connection& c); // 解析 inbuf 并把响应追加到 out
+    // 内置端点，然后是 Router；builtin 为内置端点（不计入路由延迟）
+    http::Router::Dispatch route_request(http::HttpRequest& req, http::HttpResponse& resp, const http::Route*& route,
+                                         bool& builtin);
+    uint64_t           body_limit(http::HttpRequest& req) const; // 路由的 max_body，没设为默认上限
+    // 请求头刚完整、请求体还在路上：按路由的请求体选项决定怎么收。返回非 0 为要回的错误状态码
+    unsigned           begin_body(Connection& c, std::string_view head);
+    // 边收边处理的请求体：解码新到的数据交给协程 / 写进文件。请求体收齐、可以接着处理后面的
+    // 请求时返回 true；还要等数据或已回了错误时返回 false
+    bool               feed_body(Connection& c);
+    bool               spill_body(RequestBody& b, std::string_view data); // 写不进去返回 false
+    // 回错误状态码并在发完后关闭，撤销进行中的请求体和协程（已答复过的不再回）
+    void               queue_error(Connection& c, unsigned status, const char* reason);
+    void               end_request(Connection& c) noexcept; // 当前请求处理完：解析器和请求体状态归位
+    void               pause_read(Connection& c);
+    void               resume_read(Connection& c);  // 登记到本轮末尾恢复
+    void               resume_reads();
+    // 请求字节拷进 out，req 的视图改指过去；不在 raw 里的请求体（chunked 解码出来的、
+    // 落盘阈值内留在内存里的）接在后面一起拷
+    static void        copy_request(std::string_view raw, const http::HttpRequest& src, http::HttpRequest& req,
+                                    std::string& out);
+    // 头、体分段入队，体不拷贝；req 用来决定流式响应的分帧（HTTP/1.0、HEAD），错误响应可不给
+    void               queue_response(Connection& c, http::HttpResponse& resp, const http::HttpRequest* req = nullptr);
+    // 流式响应：向生产者拉数据直到输出队列到高水位、生产者暂时没有数据或本轮配额用完。
+    // 流结束返回 true，调用方接着处理等在后面的 pipelined 请求
+    bool               pump_stream(Connection& c, size_t& budget);
+    void               resume_streams(); // 上一轮用完配额的流式响应
+    ConnIo&            borrow_io(Connection& c);
+    void               return_io(Connection& c); // 清空后放回池里
+    // stream：HTTP/2 连接上的流，响应回来时按流答复；0 则连接等这个响应（async_pending）
+    void               submit_job(Connection& c, std::string_view raw, const http::HttpRequest& req,
+                                  const http::Route& route, http::HttpResponse&& resp, Clock::time_point start,
+                                  uint32_t stream = 0);
+    void               drain_completions(); // 工作线程做完的请求：响应入队并继续处理该连接
+    void               after_async(Connection& c); // 异步响应入队后：处理后续请求并发送 / 关闭
+    void               observe(uint32_t route, unsigned status, Clock::time_point start) noexcept {
+        using namespace std::chrono;
+        metrics_->observe(route, status, static_cast<uint64_t>(duration_cast<nanoseconds>(Clock::now() - start).count()));
+    }
+    static uint32_t    route_id(const http::Route* r) noexcept {
+        return r ? r->id : http::Router::kUnmatchedRoute;
+    }
+    // 追踪（tracer_ 非空时才调用）：请求开始与解析、响应入队、发送推进
+    uint64_t           trace_feed_begin(Connection& c);
+    void               trace_feed_end(Connection& c, uint64_t t0, const http::HttpRequest* complete);
+    // open_ended：流式响应，结束位置等流发完（trace_stream(done)）才知道
+    void               trace_queued(Connection& c, uint64_t routed, uint16_t status, uint64_t bytes,
+                                    bool open_ended = false);
+    void               trace_stream(Connection& c, uint64_t bytes, bool done);
+    void               trace_sent(Connection& c, size_t n);
+
+    // 协程路由（EventLoop_coro.cpp）
+    // body_pending：头部完整就启动，请求体随后由 feed_call_body（或流式地由 feed_body）送到
+    void               start_call(Connection& c, std::string_view raw, bool body_pending,
+                                  const http::HttpRequest& req, const http::Route& route);
+    [[nodiscard]] bool feed_call_body(Connection& c); // 请求体收齐返回 true，出错时已回了错误
+    void               wake_body_waiter(Connection& c); // 请求体有新数据 / 收齐：恢复等它的协程
+    void               settle_call(Connection& c); // 随后：协程做完则收尾，已答复且请求体收齐则请求结束
+    void               resume_call(CoroCall& call, std::coroutine_handle<> h);
+    void               wake_call(Connection& c, CoroCall& call); // 等待点就绪：恢复，做完则收尾
+    http::HttpResponse call_response(CoroCall& call); // 做完的协程的响应（异常时 500）
+    void               complete_call(Connection& c); // 协程结束：响应入队
+    void               cancel_call(Connection& c);   // 连接关闭：撤销等待并销毁协程帧
+    void               cancel_wait(CoroCall& call);  // 撤销 fd 等待的登记
+    void               wake_fd_waiter(socket_t fd, uint32_t seq);
+
+    // HTTP/2（EventLoop_h2.cpp）
+    [[nodiscard]] bool h2_start(Connection& c);      // prior knowledge：inbuf 以连接前言开头
+    // 请求带 Upgrade: h2c：回 101，这个请求成为流 1。不升级（设置解不开）返回 false
+    bool               h2_upgrade(Connection& c, std::string_view raw, const http::HttpRequest& req);
+    [[nodiscard]] bool h2_input(Connection& c);      // inbuf 喂给会话，分派收齐的流
+    void               h2_dispatch(Connection& c, H2Stream& s);
+    void               h2_respond(Connection& c, uint32_t stream, http::HttpResponse& resp, bool head_only);
+    void               h2_pump(Connection& c, size_t& budget); // 各流的响应体按窗口入队
+    void               h2_cancel(Connection& c, uint32_t stream); // 对端撤销了流：作废它的协程
+    void               h2_release(Connection& c);    // 连接关闭：撤销所有流的协程
+    void               start_h2_call(Connection& c, H2Stream& s, const http::Route& route);
+    void               complete_h2_call(Connection& c, CoroCall& call); // 答复后 call 随之销毁
+    CoroCall*          find_h2_call(Connection& c, uint32_t seq) noexcept;
+
+    // WebSocket（EventLoop_ws.cpp）
+    // 请求是到 WebSocket 端点的升级：回 101（握手不合规则回 400 / 426 并在发完后关闭）
+    // 并返回 true；不是则返回 false，照常交给路由
+    bool               ws_upgrade(Connection& c, const http::HttpRequest& req);
+    [[nodiscard]] bool ws_input(Connection& c);      // 解析 inbuf 里完整的帧，消息交给回调
+    Connection*        ws_conn(const WebSocket& s) noexcept; // 句柄的连接，已关闭为 nullptr
+    void               ws_send(Connection& c, http::WsOpcode op, std::string_view payload);
+    void               ws_queue(Connection& c, std::string frame);
+    void               ws_queue(Connection& c, const std::shared_ptr<const std::string>& frame);
+    void               ws_queued(Connection& c);     // 检查积压，登记到本轮末尾发送
+    void               ws_close(Connection& c, uint16_t code, std::string_view reason); // 发 Close
+    void               ws_finish(Connection& c, uint16_t code); // 调用 on_close 并退订所有频道
+    void               ws_release(Connection& c);    // 连接关闭：没结束的按 1006 结束
+    void               ws_subscribe(Connection& c, WsChannel& ch);
+    void               ws_unsubscribe(Connection& c, WsChannel& ch);
+    void               ws_post(WsChannel* ch, const std::shared_ptr<const std::string>& frame); // 任意线程
+    void               ws_fanout(WsChannel* ch, const std::shared_ptr<const std::string>& frame);
+    void               ws_drain(bool deliver);       // 其他线程发布过来的广播
+    void               ws_flush();                   // 本轮入队了 WebSocket 帧的连接：发送 / 断开慢订阅者
+    void               ws_detach() noexcept;         // loop 销毁：从各频道摘掉自己
+    // HttpResponse::stream_waker() 的投递目标，任意线程调用：本线程直接处理，
+    // 其他线程经 stream_wakes_ + Waker 交给本 loop。conn 为 timer_tag(kTimerStream, c)，stream 为 HTTP/2 的流
+    static void        stream_wake_sink(void* loop, uint64_t conn, uint32_t stream);
+    void               on_stream_wake(uint64_t conn, uint32_t stream);
+
+    // 定时器：连接超时与协程 sleep 共用一个时间轮，节点的 data 为 类型(8) | gen(24) | fd(32)。
+    // HTTP/2 的协程 sleep 在 gen 的位置放调用编号：节点随调用销毁，到期时调用一定还在
+    enum TimerKind : uint64_t { kTimerConn = 1, kTimerCall = 2, kTimerStream = 3, kTimerH2Call = 4 };
+    static uint64_t    timer_tag(TimerKind k, const Connection& c) noexcept {
+        return (static_cast<uint64_t>(k) << 56) | (static_cast<uint64_t>(c.gen & 0xFFFFFF) << 32) |
+               static_cast<uint32_t>(c.fd);
+    }
+    static uint64_t    now_ms() noexcept;
+    static uint64_t    to_tick(Clock::time_point t) noexcept; // 向上取整到毫秒
+    void               run_timers();
+    int                next_timeout(int cap_ms) const; // 到下一个定时器的毫秒数，最多 cap_ms
+    void               refresh_timer(Connection& c);   // 按连接当前状态确定阶段和截止时间
+    void               expire_conn(Connection& c);
+    void               accept_all();
+    void               close_conn(socket_t fd);
+    void               close_all();
+    void               run_poller(const std::atomic<bool>& running);
+    bool               open_poller(); // 创建 poller 并注册监听 fd 和 Waker
+
+#ifdef __linux__
+    bool               open_uring();
+    void               run_uring(const std::atomic<bool>& running);
+    void               uring_on_cqe(const io_uring_cqe& cqe);
+    void               uring_arm_accept();
+    void               uring_arm_recv(Connection& c);
+    void               uring_arm_wake();
+    bool               uring_arm_fd_wait(socket_t fd, bool write, uint32_t seq);
+    void               uring_cancel_fd_wait(socket_t fd, uint32_t seq);
+    void               uring_pause_recv(Connection& c); // 撤掉多发 recv，恢复时重新挂上
+    bool               uring_flush(Connection& c); // 返回 false 表示连接已释放
+    bool               uring_close(Connection& c); // 同上
+#endif
+
+private:
+    const http::Router*                      router_{nullptr};
+    Backend                                  backend_{Backend::Auto};
+    socket_t                                 listen_fd_{kInvalidSocket};
+    std::unique_ptr<Poller>                  poller_;
+    Timeouts                                 timeouts_;
+    uint64_t                                 now_;      // 本轮事件的时间，wait 返回时更新
+    TimerWheel                               wheel_;    // 先于 conns_ 声明：连接里的节点先销毁
+    FdTable<Connection>                      conns_;
+    std::vector<std::unique_ptr<ConnIo>>     io_pool_;  // 空闲连接还回来的 ConnIo
+    LoopStats                                stats_;
+    std::shared_ptr<LoopMetrics>             metrics_;  // 只有本 loop 写，Server 抓取时读
+    std::shared_ptr<TraceRing>               tracer_;   // 同上，未开启追踪时为空
+    struct Endpoint {
+        std::string                  path;
+        std::string                  content_type;
+        std::function<std::string()> render;
+    };
+    std::vector<Endpoint>                    endpoints_;
+    std::function<void()>                    tick_hook_;
+    uint32_t                                 next_gen_{0};
+    WorkerPool*                              pool_{nullptr};
+    Waker                                    waker_;
+    MpscQueue                                done_;               // 工作线程 -> 本 loop
+    MpscQueue                                stream_wakes_;       // 其他线程唤醒的流式响应 -> 本 loop
+    std::atomic<bool>                        wake_pending_{false}; // 已 notify 未处理：合并唤醒
+
+    // 协程路由：被等待的 fd，以及正在恢复的调用
+    struct FdWait {
+        socket_t conn;
+        uint32_t gen;
+        uint32_t seq;
+        uint32_t stream; // HTTP/2 的流，0 为连接的 call
+    };
+    std::unordered_map<socket_t, FdWait>     fd_waits_;
+    std::vector<socket_t>                    ready_fds_;  // 本批就绪的被等待 fd，事件处理完再恢复
+    // 流式响应的水位：输出队列低于低水位才向生产者要数据，一次最多攒到高水位；
+    // 对端读得慢时队列停在高水位，生产者不再被调用（背压），内存占用与响应总长无关
+    static constexpr size_t   kStreamLowWater  = 16 * 1024;
+    static constexpr size_t   kStreamHighWater = 64 * 1024;
+    // 每轮事件循环一个连接最多生产这么多字节，其余的下一轮再发：快的对端不会独占 loop
+    static constexpr size_t   kStreamBudget    = 256 * 1024;
+    static constexpr uint64_t kStreamRetryMs   = 10; // 生产者暂时没有数据时多久后再问
+    // 用完本轮配额的流式响应：本轮事件处理完再接着发，有它们时 poll 不等待
+    struct StreamRef {
+        socket_t fd;
+        uint32_t gen;
+    };
+    std::vector<StreamRef>                   stream_ready_;
+    // 流式请求体：协程还没取走的数据到这么多就暂停读 socket，取走后再恢复（背压）
+    static constexpr size_t   kBodyHighWater   = 256 * 1024;
+    // 为了避免恶意请求撑爆内存，给 inbuf 设一个上限；路由可用 RouteOptions::max_body 放宽
+    static constexpr size_t   kMaxRequestSize  = 1 * 1024 * 1024;
+    static size_t             request_limit(const ConnIo& io) noexcept {
+        return io.max_request ? io.max_request : kMaxRequestSize;
+    }
+    std::vector<StreamRef>                   read_ready_; // 要恢复读的连接，本轮事件处理完再读
+    // WebSocket：端点、各频道在本 loop 上的订阅者，以及本轮入队了帧、等着发送的连接。
+    // 关闭的订阅者不当场从列表里删（可能有成千上万个同时断开），分发时顺带清掉
+    struct WsRoute {
+        std::string                       path;
+        std::shared_ptr<const WsHandlers> handlers;
+    };
+    struct WsSubs {
+        std::vector<StreamRef> refs;
+        size_t                 dead{0}; // 已结束但还在 refs 里的，多了在订阅时压缩
+    };
+    std::vector<WsRoute>                     ws_routes_;
+    std::unordered_map<WsChannel*, WsSubs>   ws_subs_;
+    std::vector<StreamRef>                   ws_flush_;
+    MpscQueue                                ws_inbox_;  // 其他线程发布的广播 -> 本 loop
+    std::string                              spill_dir_;
+    bool                                     http2_{true};
+    CoroCall*                                current_{nullptr};
+    uint32_t                                 next_seq_{0};
+    static thread_local EventLoop*           tls_loop_;   // run() 期间本线程的 loop
+#ifdef __linux__
+    std::unique_ptr<IoUring>                 uring_;
+    uint64_t                                 wake_buf_{0};         // eventfd 的 READ 目标
+#endif
+};
+
+} // namespace net
@@ -0,0 +1,113 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+// 以 fd 为下标的对象表（slab）：查找是一次下标运算，没有哈希也没有每个对象一次的节点分配。
+// 内核分配 fd 时总取最小的空闲号，所以 fd 是稠密的；按 256 个槽一块分配，
+// 块内对象地址固定（定时器节点、内核持有的指针可以指向它们），整块空了就释放。
+// Windows 的 SOCKET 是 4 的倍数的句柄值，按 fd / 4 作下标。只在单个线程上使用。
+template <class T>
+class FdTable {
+public:
+    static constexpr size_t kChunkBits = 8;
+    static constexpr size_t kChunk     = size_t{1} << kChunkBits;
+
+    FdTable() = default;
+    ~FdTable() { clear(); }
+    FdTable(const FdTable&) = delete;
+    FdTable& operator=(const FdTable&) = delete;
+
+    T* find(socket_t fd) noexcept {
+        const size_t i = index(fd);
+        Chunk* ch = (i >> kChunkBits) < chunks_.size() ? chunks_[i >> kChunkBits].get() : nullptr;
+        return ch && ch->live(i & (kChunk - 1)) ? ch->at(i & (kChunk - 1)) : nullptr;
+    }
+    bool contains(socket_t fd) noexcept { return find(fd) != nullptr; }
+
+    // fd 不能已在表中；args 传给 T 的构造函数
+    template <class... Args>
+    T& emplace(socket_t fd, Args&&... args) {
+        const size_t i = index(fd);
+        const size_t c = i >> kChunkBits;
+        if (c >= chunks_.size()) chunks_.resize(c + 1);
+        if (!chunks_[c]) chunks_[c] = std::make_unique<Chunk>();
+        Chunk& ch = *chunks_[c];
+        T* p = ::new (static_cast<void*>(ch.slots[i & (kChunk - 1)])) T(std::forward<Args>(args)...);
+        ch.set_live(i & (kChunk - 1), true);
+        ++ch.count;
+        ++size_;
+        return *p;
+    }
+
+    void erase(socket_t fd) noexcept {
+        const size_t i = index(fd);
+        const size_t c = i >> kChunkBits;
+        if (c >= chunks_.size() || !chunks_[c] || !chunks_[c]->live(i & (kChunk - 1))) return;
+        Chunk& ch = *chunks_[c];
+        ch.at(i & (kChunk - 1))->~T();
+        ch.set_live(i & (kChunk - 1), false);
+        --size_;
+        if (--ch.count == 0) chunks_[c].reset();
+    }
+
+    // f(T&)；f 里不能增删表项
+    template <class F>
+    void for_each(F&& f) {
+        for (auto& ch : chunks_) {
+            if (!ch) continue;
+            for (size_t w = 0; w < kChunk / 64; ++w)
+                for (uint64_t bits = ch->mask[w]; bits; bits &= bits - 1)
+                    f(*ch->at(w * 64 + static_cast<size_t>(std::countr_zero(bits))));
+        }
+    }
+
+    void clear() noexcept {
+        for (auto& ch : chunks_) {
+            if (!ch) continue;
+            for (size_t j = 0; j < kChunk; ++j)
+                if (ch->live(j)) ch->at(j)->~T();
+            ch.reset();
+        }
+        chunks_.clear();
+        size_ = 0;
+    }
+
+    size_t size() const noexcept { return size_; }
+    bool   empty() const noexcept { return size_ == 0; }
+
+private:
+    struct Chunk {
+        alignas(T) unsigned char slots[kChunk][sizeof(T)];
+        uint64_t mask[kChunk / 64]{};
+        size_t   count{0};
+
+        bool live(size_t j) const noexcept { return (mask[j / 64] >> (j % 64)) & 1; }
+        void set_live(size_t j, bool on) noexcept {
+            if (on) mask[j / 64] |= uint64_t{1} << (j % 64);
+            else    mask[j / 64] &= ~(uint64_t{1} << (j % 64));
+        }
+        T* at(size_t j) noexcept { return std::launder(reinterpret_cast<T*>(slots[j])); }
+    };
+
+    static size_t index(socket_t fd) noexcept {
+#ifdef _WIN32
+        return static_cast<size_t>(fd) >> 2;
+#else
+        return static_cast<size_t>(fd);
+#endif
+    }
+
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+    size_t                              size_{0};
+};
+
+} // namespace net
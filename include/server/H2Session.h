@@ -0,0 +1,163 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "http/Hpack.h"
+#include "http/HttpRequest.h"
+#include "http/HttpResponse.h"
+#include "server/OutputQueue.h"
+
+namespace net {
+
+// HTTP/2（RFC 9113）的帧类型、标志位与错误码
+namespace h2 {
+enum FrameType : uint8_t {
+    kData = 0, kHeaders = 1, kPriority = 2, kRstStream = 3, kSettings = 4, kPushPromise = 5, kPing = 6,
+    kGoaway = 7, kWindowUpdate = 8, kContinuation = 9
+};
+enum Flag : uint8_t { kEndStream = 0x1, kAck = 0x1, kEndHeaders = 0x4, kPadded = 0x8, kPriorityFlag = 0x20 };
+enum Error : uint32_t {
+    kNoError = 0, kProtocolError = 1, kInternalError = 2, kFlowControlError = 3, kStreamClosed = 5,
+    kFrameSizeError = 6, kRefusedStream = 7, kCancel = 8, kCompressionError = 9, kEnhanceYourCalm = 11
+};
+// 客户端的连接前言：prior knowledge 直接以它开头，h2c 升级则跟在 101 之后
+constexpr std::string_view kPreface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+} // namespace h2
+
+// 一个流：请求头解码进 raw（req 的视图指向这里），请求体收在 body；
+// 响应交出后 body 来源（内存 / 文件 / 生产者）按流量控制窗口一帧帧发
+struct H2Stream {
+    ~H2Stream() {
+        if (signal) signal->unbind();
+    }
+
+    uint32_t          id{0};
+    std::string       raw;
+    std::string       body;
+    http::HttpRequest req;
+    uint64_t          body_limit{0};
+    uint64_t          content_length{UINT64_MAX}; // 请求声明的长度，没有为 UINT64_MAX
+    int64_t           send_window{0};
+    int64_t           recv_window{0};
+    uint32_t          recv_unacked{0};   // 已收到、还没用 WINDOW_UPDATE 还给对端的字节
+    unsigned          reject{0};         // 不交给处理函数、由 loop 直接回的状态码（413 / 431）
+    bool              remote_done{false}; // 收到了 END_STREAM
+    bool              dispatched{false};  // 已交给 loop（pop_ready 取走）
+    bool              responded{false};
+
+    // 响应体：owner 持有 data 或 file_fd 的来源
+    std::shared_ptr<const void>      owner;
+    std::string_view                 data;
+    int                              file_fd{-1};
+    uint64_t                         file_off{0};
+    uint64_t                         file_left{0};
+    http::HttpResponse::BodyProducer    producer;
+    std::shared_ptr<http::StreamSignal> signal;         // 有 waker 的生产者：等唤醒，不重试
+    bool                                waiting{false}; // 生产者暂时没有数据
+};
+
+// 一个 h2c 连接的协议状态：连接前言、帧解析、HPACK 两个方向的动态表、流的状态，
+// 以及收发两个方向的流量控制。不碰 socket：loop 把收到的字节喂进来，
+// 要发的帧直接追加到连接的输出队列（响应体以共享段 / 文件段入队，不拷贝）。
+// 请求收齐的流由 loop 用 pop_ready 取走、照常分派给 Router，答复后 respond；
+// 多个流的响应可以任意顺序完成，互不阻塞
+class H2Session {
+public:
+    // 我们的 SETTINGS：并发流上限、每个流的接收窗口、请求头解码后的大小上限
+    static constexpr uint32_t kMaxStreams      = 100;
+    static constexpr uint32_t kStreamWindow    = 1 << 20;
+    static constexpr uint32_t kConnWindow      = 16 << 20;
+    static constexpr uint32_t kMaxHeaderList   = 64 * 1024;
+    static constexpr uint32_t kMaxFrame        = 16384; // 接收的帧长上限（协议默认值，不改）
+
+    // body_limit：请求头收齐时调用，返回该请求的请求体上限（路由的 max_body）
+    explicit H2Session(std::function<uint64_t(http::HttpRequest&)> body_limit)
+        : body_limit_(std::move(body_limit)) {}
+
+    // 连接开始（prior knowledge，或 h2c 的 101 之后）：服务端的 SETTINGS，放大连接级接收窗口
+    void start(OutputQueue& out);
+    // h2c 升级（RFC 7540 3.2）：settings 是 HTTP2-Settings 头（base64url 编码的 SETTINGS 负载）。
+    // 解不开返回 false，不升级；成功时流 1 即为这个请求，已半关闭（请求收齐），由调用方填好 req 后分派
+    bool upgrade(std::string_view settings);
+
+    // 解析收到的字节（从连接前言开始），返回消费了多少，不完整的帧留到下次。
+    // 要回的控制帧（SETTINGS ACK、PING、WINDOW_UPDATE、RST_STREAM）写进 out；
+    // 连接错误时写 GOAWAY，此后 closed() 为真、输入一律丢弃
+    size_t feed(std::string_view in, OutputQueue& out);
+    // feed 之后：请求收齐（或要直接回 reject）的流，按到达顺序
+    bool pop_ready(uint32_t& id);
+    // 已交给 loop、又被对端 RST_STREAM 撤销的流：处理中的工作要作废
+    bool pop_reset(uint32_t& id);
+    H2Stream* find(uint32_t id) noexcept;
+
+    // 答复一个流：响应头编码成 HEADERS（+ CONTINUATION）写进 out，小响应体直接跟一个 DATA；
+    // 其余的响应体由 pump 按窗口发。head_only：HEAD 请求，只发头。之后 stream 指针可能失效
+    void respond(H2Stream& s, http::HttpResponse& resp, bool head_only, OutputQueue& out);
+    // 各流待发的响应体轮流按窗口分帧写进 out，直到 out 到 high_water、窗口用完或 budget 用完
+    void pump(OutputQueue& out, size_t high_water, size_t& budget);
+    // 有流式响应的生产者（没有 waker 的）暂时没有数据：过一会儿 retry 后再 pump
+    bool waiting() const noexcept { return waiting_; }
+    void retry() noexcept;
+    // 生产者的 waker 被唤醒：这个流下次 pump 时再问
+    void wake(uint32_t id) noexcept;
+    // 还有窗口允许、没写进输出队列的响应体
+    bool sendable() const noexcept;
+
+    // 协议错误发了 GOAWAY，或对端 GOAWAY 后流都结束了：发完输出即可关闭连接
+    bool closed() const noexcept { return goaway_sent_ || (goaway_received_ && streams_.empty()); }
+    bool idle() const noexcept { return streams_.empty(); }
+    bool receiving() const noexcept; // 有流的请求还在收（超时按请求体计）
+    size_t streams() const noexcept { return streams_.size(); }
+
+private:
+    enum class State : uint8_t { Preface, Settings, Frames, Closed };
+
+    void frame_header(uint32_t len, uint8_t type, uint8_t flags, uint32_t id);
+    void flush(OutputQueue& out);
+    void goaway(uint32_t code);
+    void reset_stream(uint32_t id, uint32_t code); // 本端发起的流错误
+    void drop_stream(uint32_t id);                  // 流结束，loop 手里的交出去的随之作废
+    void window_update(uint32_t id, uint32_t n);
+    bool apply_settings(std::string_view payload); // 参数非法时已 goaway
+    void end_headers();                            // 头部块收齐：解码、建请求
+    uint32_t build_request(H2Stream& s);            // 返回流错误码，0 为成功
+    void on_data(uint32_t id, uint8_t flags, std::string_view payload);
+    void on_headers(uint32_t id, uint8_t flags, std::string_view payload);
+    void finish_request(H2Stream& s);              // END_STREAM：请求收齐
+    void close_local(H2Stream& s);                 // 响应的 END_STREAM 已写出
+    enum class Sent { Blocked, Progress, Finished };
+    Sent send_data(H2Stream& s, OutputQueue& out, size_t& budget);
+
+    std::function<uint64_t(http::HttpRequest&)>             body_limit_;
+    State                                                   state_{State::Preface};
+    std::unordered_map<uint32_t, std::unique_ptr<H2Stream>> streams_;
+    std::vector<uint32_t>                                   ready_;
+    size_t                                                  ready_head_{0};
+    std::vector<uint32_t>                                   resets_;
+    std::vector<uint32_t>                                   sending_; // 有响应体待发的流，轮流发
+    http::HpackDecoder                                      decoder_;
+    http::HpackEncoder                                      encoder_;
+    std::vector<http::HpackField>                           fields_;
+    std::string                                             block_;   // HEADERS + CONTINUATION 的头部块
+    uint32_t                                                block_stream_{0}; // 非 0：正等 CONTINUATION
+    uint8_t                                                 block_flags_{0};
+    std::string                                             wbuf_;    // 控制帧与响应头，下次 flush 入队
+    std::string                                             hbuf_;    // 编码中的响应头部块
+    uint32_t                                                last_peer_id_{0};
+    int64_t                                                 conn_send_window_{65535};
+    int64_t                                                 conn_recv_window_{65535};
+    uint32_t                                                conn_recv_unacked_{0};
+    uint32_t                                                peer_initial_window_{65535};
+    uint32_t                                                peer_max_frame_{16384};
+    bool                                                    goaway_sent_{false};
+    bool                                                    goaway_received_{false};
+    bool                                                    waiting_{false};
+};
+
+} // namespace net
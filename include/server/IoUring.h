@@ -0,0 +1,86 @@
+#pragma once
+#ifdef __linux__
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+namespace net {
+
+// 最小化的 io_uring 封装（直接走 syscall，不依赖 liburing）：
+// SQ/CQ 环映射、批量提交、带超时的等待，以及一个 provided buffer ring。
+// 只在单个线程上使用。
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // 创建 ring；内核不支持 / 被禁用（io_uring_disabled、seccomp）时返回 false
+    [[nodiscard]] bool init(unsigned entries);
+    // 在实际提交 SQE 的线程上调用一次：SINGLE_ISSUER 的 ring 以创建时处于禁用状态，
+    // 启用的线程才成为唯一的提交者（open 与 run 可能不在同一线程）
+    [[nodiscard]] bool enable();
+
+    // 取一个空闲 SQE（已清零）；SQ 满时先把已有的提交掉再取
+    io_uring_sqe* get_sqe();
+
+    // 提交所有待提交的 SQE，并等待至少一个 CQE 或超时。返回 io_uring_enter 的结果。
+    int submit_and_wait(int timeout_ms);
+
+    // 遍历已完成的 CQE，fn(const io_uring_cqe&)；返回处理数量
+    template <class Fn>
+    unsigned drain_cqes(Fn&& fn) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned n = 0;
+        for (; head != tail; ++head, ++n) fn(cqes_[head & cq_mask_]);
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return n;
+    }
+
+    // 注册 provided buffer ring：nbufs 个 buf_size 字节的缓冲区（nbufs 为 2 的幂）
+    [[nodiscard]] bool setup_buf_ring(uint16_t group, unsigned nbufs, unsigned buf_size);
+    const char* buf(uint16_t bid) const noexcept { return bufs_ + static_cast<size_t>(bid) * buf_size_; }
+    // 把用完的缓冲区还给内核
+    void recycle_buf(uint16_t bid) noexcept;
+
+    // 累计的 io_uring_enter 次数（基准测试用）
+    uint64_t enter_calls() const noexcept { return enter_calls_; }
+
+private:
+    int            ring_fd_{-1};
+    bool           disabled_{false}; // 以 IORING_SETUP_R_DISABLED 创建，等待 enable()
+    unsigned       pending_{0}; // 已填好但尚未提交的 SQE 数
+
+    void*          sq_ptr_{nullptr};
+    size_t         sq_len_{0};
+    void*          cq_ptr_{nullptr};
+    size_t         cq_len_{0};
+    io_uring_sqe*  sqes_{nullptr};
+    size_t         sqes_len_{0};
+
+    unsigned*      sq_head_{nullptr};
+    unsigned*      sq_tail_{nullptr};
+    unsigned*      sq_array_{nullptr};
+    unsigned       sq_mask_{0};
+    unsigned       sq_entries_{0};
+    unsigned*      cq_head_{nullptr};
+    unsigned*      cq_tail_{nullptr};
+    unsigned       cq_mask_{0};
+    io_uring_cqe*  cqes_{nullptr};
+
+    io_uring_buf_ring* buf_ring_{nullptr};
+    size_t             buf_ring_len_{0};
+    char*              bufs_{nullptr};
+    unsigned           buf_size_{0};
+    unsigned           buf_mask_{0};
+
+    uint64_t       enter_calls_{0};
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz);
+};
+
+} // namespace net
+#endif
@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "http/Router.h"
+
+namespace net {
+
+// 单写者计数器：只由所属 loop 线程写，抓取时任意线程读。
+// 写是 relaxed 的 load + store，不用 fetch_add（省掉 lock 前缀）；读到的值可能稍旧，但不会撕裂
+class Counter {
+public:
+    void add(uint64_t n = 1) noexcept {
+        v_.store(v_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    uint64_t get() const noexcept { return v_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> v_{0};
+};
+
+// 对数分桶（HDR 风格）的延迟直方图，单位纳秒，单写者。
+// [0, 8) 逐个计数，之后每个 2 的幂区间等分 8 桶（相对误差 < 12.5%），
+// 2^36 ns（约 69s）以上的都落在最后一桶。记录一次是两次计数器写，没有分支以外的开销
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBits  = 3;
+    static constexpr unsigned kSub      = 1u << kSubBits;
+    static constexpr unsigned kMaxShift = 36;
+    static constexpr size_t   kBuckets  = kSub + (kMaxShift - kSubBits) * kSub;
+
+    static size_t   bucket_of(uint64_t ns) noexcept;
+    static uint64_t upper_bound(size_t bucket) noexcept; // 桶内最大值（含）
+
+    void record(uint64_t ns) noexcept {
+        buckets_[bucket_of(ns)].add();
+        sum_.add(ns);
+    }
+    uint64_t bucket(size_t i) const noexcept { return buckets_[i].get(); }
+    uint64_t sum() const noexcept { return sum_.get(); }
+
+private:
+    std::array<Counter, kBuckets> buckets_{};
+    Counter                       sum_;
+};
+
+// 直方图的普通（非原子）副本：抓取时把各 loop 的同一条直方图累加到这里
+struct HistogramSnapshot {
+    std::array<uint64_t, LatencyHistogram::kBuckets> buckets{};
+    uint64_t count{0};
+    uint64_t sum{0};
+
+    void     add(const LatencyHistogram& h) noexcept;
+    uint64_t percentile(double q) const noexcept; // q ∈ [0, 1]，返回所在桶的上界（ns）
+};
+
+// 一个 loop 的全部指标，只由该 loop 线程写。按缓存行对齐，loop 之间不伪共享。
+// 延迟直方图按 (路由编号, 状态类 1xx..5xx) 分开，第一次用到时才分配；
+// 路由编号即 Route::id，槽数在创建时按 Router::routes() 定下
+struct alignas(64) LoopMetrics {
+    static constexpr unsigned kClasses = 5;
+
+    explicit LoopMetrics(size_t routes);
+    ~LoopMetrics();
+    LoopMetrics(const LoopMetrics&) = delete;
+    LoopMetrics& operator=(const LoopMetrics&) = delete;
+
+    Counter connections_accepted;
+    Counter connections_closed;
+    Counter bytes_in;
+    Counter bytes_out;
+    Counter requests;     // 已入队的响应数，含 400 / 408 / 413
+    Counter parse_errors; // 请求格式错误（400）
+    Counter too_large;    // 请求超过上限（413）
+    Counter timeouts;     // 读请求超时回 408
+    Counter idle_closes;  // 空闲 / 发送停滞超时，直接关闭
+    Counter bodies_spilled; // 超过落盘阈值、写进临时文件的请求体
+    Counter h2_connections; // 切换到 HTTP/2 的连接（prior knowledge 与 h2c 升级）
+    Counter ws_connections;   // 升级为 WebSocket 的连接
+    Counter ws_messages_in;   // 收到的完整消息
+    Counter ws_frames_out;    // 入队的帧，广播按订阅者计
+    Counter ws_slow_closes;   // 积压超过 max_backlog 被断开的连接
+
+    void count_status(unsigned status) noexcept {
+        if (status >= 100 && status < 600) status_[status - 100].add();
+    }
+    uint64_t status_count(unsigned status) const noexcept {
+        return status >= 100 && status < 600 ? status_[status - 100].get() : 0;
+    }
+
+    // 记录一个请求从开始路由到响应入队的耗时；越界的路由编号记在 kUnmatchedRoute 下
+    void observe(uint32_t route, unsigned status, uint64_t ns) noexcept {
+        if (route >= routes_) route = http::Router::kUnmatchedRoute;
+        unsigned cls = status / 100;
+        cls = cls >= 1 && cls <= kClasses ? cls - 1 : kClasses - 1;
+        std::atomic<LatencyHistogram*>& slot = hist_[route * kClasses + cls];
+        LatencyHistogram* h = slot.load(std::memory_order_relaxed); // 只有本线程会写这个槽
+        if (!h) h = create(slot);
+        h->record(ns);
+    }
+    // 抓取线程读取；还没有请求落进去时为 nullptr
+    const LatencyHistogram* histogram(uint32_t route, unsigned cls) const noexcept {
+        return route < routes_ ? hist_[route * kClasses + cls].load(std::memory_order_acquire) : nullptr;
+    }
+    size_t routes() const noexcept { return routes_; }
+
+private:
+    LatencyHistogram* create(std::atomic<LatencyHistogram*>& slot);
+
+    std::array<Counter, 500>                          status_{};
+    size_t                                            routes_;
+    std::unique_ptr<std::atomic<LatencyHistogram*>[]> hist_;
+};
+
+// 把各 loop 的指标合并成 Prometheus 文本格式（0.0.4），指标名以 http_server_ 开头。
+// router 给出路由编号对应的方法与路径（标签），可为 nullptr
+std::string render_prometheus(const std::vector<std::shared_ptr<const LoopMetrics>>& loops,
+                              const http::Router* router);
+
+// /metrics 响应的 Content-Type
+inline constexpr const char* kPrometheusContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+} // namespace net
@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+
+namespace net {
+
+// 侵入式节点：入队的对象自带 next 指针，队列本身不分配内存
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+// 无锁多生产者单消费者队列（Vyukov 的侵入式 MPSC）。
+// push 可在任意线程调用，一次 exchange 即完成；pop 只能由唯一的消费者线程调用。
+// 生产者刚交换完 head 还没链上 next 时，pop 会暂时返回 nullptr：
+// 该生产者链好之后会自己再唤醒消费者，所以不会丢。
+class MpscQueue {
+public:
+    MpscQueue() noexcept : head_(&stub_), tail_(&stub_) {}
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(MpscNode* n) noexcept {
+        n->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head_.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    MpscNode* pop() noexcept {
+        MpscNode* tail = tail_;
+        MpscNode* next = tail->next.load(std::memory_order_acquire);
+        if (tail == &stub_) {
+            if (!next) return nullptr;
+            tail_ = next;
+            tail  = next;
+            next  = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        if (tail != head_.load(std::memory_order_acquire)) return nullptr; // 有生产者正在入队
+        push(&stub_); // tail 是最后一个节点：放回哨兵才能把它摘下
+        next = tail->next.load(std::memory_order_acquire);
+        if (next) {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+private:
+    alignas(64) std::atomic<MpscNode*> head_; // 生产者竞争的一端
+    alignas(64) MpscNode*              tail_; // 只有消费者访问
+    MpscNode                           stub_;
+};
+
+} // namespace net
@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+// 链式输出队列：响应头、响应体各自成段，发送时用 writev/sendmsg 一次带出多段，
+// 首段已发送的字节用游标记录，不拼接也不做 erase(0, n) 式的整体搬移。
+// 段的内存来源有三种：
+//   - 自有：std::string 移动进来，不拷贝
+//   - 共享：shared_ptr 持有，多个连接可以同时发送同一块数据（例如缓存的文件）
+//   - 借用：只记录指针，调用方保证发送完成前有效（例如静态常量）
+// 另有文件段（fd + 区间），由 sendfile 发送，数据不经过用户态。
+class OutputQueue {
+public:
+    // 不超过这个长度的自有数据直接并入上一个自有段（上一段也不超过这个长度，或剩余容量放得下），
+    // 减少小响应的 iovec 数，又不会为一个小块拷贝大段
+    static constexpr size_t kCoalesceMax = 2048;
+    // 发完（或被合并掉）的自有段留一个缓冲给下一个响应头用，超过这个容量的不留
+    static constexpr size_t kSpareMax = 4096;
+
+    void append(std::string data);
+    void append_shared(std::shared_ptr<const std::string> data);
+    void append_shared(std::shared_ptr<const void> owner, std::string_view data);
+    void append_borrowed(std::string_view data);
+    // owner 保证 fd 在发送完成前不被关闭
+    void append_file(std::shared_ptr<const void> owner, int fd, uint64_t offset, uint64_t len);
+    // 取回收的空缓冲（没有则是空串），写好后再 append 回来：稳态下响应头不再申请内存
+    std::string take_buffer() noexcept { return std::move(spare_); }
+
+    struct FileSlice {
+        int      fd;
+        uint64_t offset;
+        size_t   len;
+    };
+    // 队首是文件段时返回 true，out 为其未发送部分（单次最多 1GB）
+    bool front_file(FileSlice& out) const noexcept;
+    // 从游标处开始，最多取 max 个内存段填入 out（遇到文件段停止），返回段数
+    size_t gather(IoSlice* out, size_t max) const noexcept;
+    // 已发送 n 字节：推进游标，释放发完的段
+    void consume(uint64_t n) noexcept;
+
+    // io_uring 发送期间内核持有前 n 段的地址：这些段不再接受合并，
+    // deque 尾部追加也不会移动已有元素
+    void pin(size_t n) noexcept { pinned_ = n; }
+    void unpin() noexcept { pinned_ = 0; }
+
+    bool   empty() const noexcept { return bytes_ == 0; }
+    uint64_t size() const noexcept { return bytes_; } // 未发送字节数
+    size_t segments() const noexcept { return segs_.size(); }
+    void   clear() noexcept;
+
+private:
+    struct Segment {
+        std::string                 owned;
+        std::shared_ptr<const void> ref;          // 共享段的持有者
+        const char*                 ptr{nullptr}; // 共享 / 借用段的数据
+        uint64_t                    len{0};       // 非自有段的长度
+        int                         file_fd{-1};  // 文件段：[file_off, file_off+len)
+        uint64_t                    file_off{0};
+        bool                        is_owned{false};
+
+        bool is_file() const noexcept { return file_fd >= 0; }
+        uint64_t size() const noexcept { return is_owned ? owned.size() : len; }
+        // 仅内存段
+        std::string_view view() const noexcept {
+            return is_owned ? std::string_view(owned) : std::string_view(ptr, static_cast<size_t>(len));
+        }
+    };
+
+    // deque 每追加几段就要换一个节点块：释放的块按大小留几个，下次直接取回，不回到 malloc
+    class BlockCache final : public std::pmr::memory_resource {
+    public:
+        BlockCache() = default;
+        ~BlockCache() override;
+        BlockCache(const BlockCache&) = delete;
+        BlockCache& operator=(const BlockCache&) = delete;
+
+    private:
+        static constexpr size_t kSlots = 4;
+        struct Slot {
+            void*  ptr{nullptr};
+            size_t size{0};
+            size_t align{0};
+        };
+
+        void* do_allocate(size_t bytes, size_t align) override;
+        void  do_deallocate(void* p, size_t bytes, size_t align) noexcept override;
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        Slot slots_[kSlots];
+    };
+
+    void push(Segment&& s);
+    void recycle(std::string&& s) noexcept;
+
+    BlockCache               cache_; // 先于 segs_ 构造、后于它析构
+    std::pmr::deque<Segment> segs_{&cache_};
+    uint64_t                 offset_{0}; // 首段已发送的字节数
+    uint64_t                 bytes_{0};
+    size_t                   pinned_{0};
+    std::string              spare_;
+};
+
+} // namespace net
@@ -22,6 +22,9 @@
 
 namespace net {
 
+// 无效句柄（POSIX 为 -1，Windows 为 INVALID_SOCKET）
+inline constexpr socket_t kInvalidSocket = static_cast<socket_t>(-1);
+
 // 初始化 / 清理（Windows 需要，POSIX 空实现）
 void socket_startup();
 void socket_cleanup();
@@ -36,7 +39,24 @@ void sys_perror(const char* where);
 
 ssize_t socket_recv(socket_t s, char* buf, size_t len);
 ssize_t socket_send(socket_t s, const char* buf, size_t len);
+
+// 一段待发送数据（与平台无关，发送时再转成 iovec / WSABUF）
+struct IoSlice {
+    const char* data;
+    size_t      len;
+};
+// 单次聚合发送最多的段数
+inline constexpr size_t kMaxIoSlices = 64;
+// 聚合发送（POSIX sendmsg / Windows WSASend），cnt 超过 kMaxIoSlices 的部分不发送
+ssize_t socket_sendv(socket_t s, const IoSlice* iov, size_t cnt);
+// 把文件 fd 的 [offset, offset+len) 直接发到 socket（Linux sendfile / BSD sendfile；
+// Windows 退化为读到栈上缓冲区再 send），返回值与 socket_send 相同
+ssize_t socket_sendfile(socket_t s, int file_fd, uint64_t offset, size_t len);
 socket_t socket_accept(socket_t s, sockaddr* addr, socklen_t* len);
+// 非阻塞 connect：已连上返回 0，进行中返回 1（可写后用 socket_error 取结果），失败返回 -1
+int socket_connect(socket_t s, const sockaddr* addr, socklen_t len);
+// 取出并清除 socket 上挂起的错误（SO_ERROR），0 表示没有
+int socket_error(socket_t s);
 bool is_would_block(int err);
 
 bool is_valid_socket(socket_t s);
@@ -44,5 +64,7 @@ bool is_valid_socket(socket_t s);
 
 // 设置非阻塞（在 Socket_posix.cpp / Socket_win.cpp 里实现）
 bool set_socket_nonblocking(socket_t s);
+// 关闭 Nagle：HTTP/2 的帧头与文件段分开发送，不关的话帧头会等对端的延迟 ACK
+bool set_socket_nodelay(socket_t s);
 
 } // namespace net
@@ -0,0 +1,57 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+// 事件循环后端
+// IoUring 不是 Poller（完成模型），由 EventLoop 直接驱动，不可用时回退到 Auto
+enum class Backend { Auto, Select, Epoll, IoUring };
+
+const char* backend_name(Backend b) noexcept;
+
+struct PollEvent {
+    socket_t fd{};
+    bool     readable{false};
+    bool     writable{false};
+    bool     hangup{false}; // 对端关闭 / 出错，按可读处理即可（recv 会返回 0 或错误）
+};
+
+// I/O 多路复用抽象。每次 wait 只返回就绪的 fd，调用方的工作量与就绪数成正比。
+//
+// 连接 fd 的语义按后端不同：
+//  - epoll：边沿触发（EPOLLET），注册一次读+写，调用方必须读/写到 EAGAIN；
+//           set_want_write / set_want_read 为空操作。
+//  - select：电平触发，只在 set_want_write(fd, true) 后关心可写；
+//            set_want_read(fd, false) 暂停关心可读（调用方暂时不读，避免空转）。
+// 监听 fd 始终是电平触发，accept 出错（如 EMFILE）时不会丢失唤醒。
+// watch 用于协程等待的其他 fd：只关心一个方向，就绪报告一次后调用方 remove。
+class Poller {
+public:
+    virtual ~Poller() = default;
+
+    [[nodiscard]] virtual bool add_listener(socket_t fd) = 0;
+    [[nodiscard]] virtual bool add(socket_t fd) = 0;
+    [[nodiscard]] virtual bool watch(socket_t fd, bool write) = 0;
+    virtual void set_want_write(socket_t fd, bool on) = 0;
+    virtual void set_want_read(socket_t fd, bool on) = 0;
+    virtual void remove(socket_t fd) = 0;
+
+    // 等待事件，结果写入 out（会先清空）。返回就绪数量，出错返回 -1。
+    virtual int wait(std::vector<PollEvent>& out, int timeout_ms) = 0;
+
+    virtual Backend backend() const noexcept = 0;
+};
+
+// 按后端创建 Poller；Auto 在 Linux 上选 epoll，其余平台选 select。
+// 所请求的后端不可用（或为 IoUring）时返回 nullptr。
+std::unique_ptr<Poller> make_poller(Backend b);
+
+std::unique_ptr<Poller> make_select_poller();
+#ifdef __linux__
+std::unique_ptr<Poller> make_epoll_poller();
+#endif
+
+} // namespace net
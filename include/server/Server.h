@@ -1,22 +1,21 @@
 #pragma once
 #include <atomic>
-#include <unordered_map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "http/Router.h"
-#include "http/HttpParser.h"
+#include "server/EventLoop.h"
+#include "server/Metrics.h"
+#include "server/Trace.h"
+#include "server/WebSocket.h"
 #include "server/PlatformSocket.h" // 提供 socket_t / is_valid_socket / closesocket / set_socket_nonblocking
+#include "server/Poller.h"
 
 namespace net {
 
-struct Connection {
-    socket_t         fd{};           // 默认初始化
-    std::string      inbuf;
-    std::string      outbuf;
-    http::HttpParser parser;
-    bool             keep_alive{true};
-};
-
 class Server {
 public:
     explicit Server(uint16_t port);
@@ -28,24 +27,75 @@ public:
     Server(Server&&) = delete;
     Server& operator=(Server&&) = delete;
 
+    // Router 在所有 loop 之间只读共享，listen_and_serve 期间不要再修改
     void set_router(const http::Router* r) noexcept { router_ = r; }
+    // 选择事件循环后端，需在 listen_and_serve 之前调用；默认 Auto（Linux 上为 epoll）
+    void set_backend(Backend b) noexcept { backend_ = b; }
+    // 多 reactor 模式：n 个独立 loop 各占一个线程，通过 SO_REUSEPORT 共享端口。
+    // 0 表示按 CPU 核数；默认 1（单线程，跑在调用 listen_and_serve 的线程上）
+    void set_threads(unsigned n) noexcept { threads_ = n; }
+    // 把第 i 个 loop 绑定到第 i 个 CPU（仅 Linux 生效）
+    void set_cpu_affinity(bool on) noexcept { pin_cpus_ = on; }
+    // blocking 路由（RouteOptions::blocking）的工作线程数，所有 loop 共用一个池；
+    // 默认 0：不建池，blocking 路由也在 loop 线程上直接执行
+    void set_workers(unsigned n) noexcept { workers_ = n; }
+    // 连接超时（空闲 / 读请求头 / 读请求体 / 发送停滞），各 loop 相同；0 表示不限制
+    void set_timeouts(const Timeouts& t) noexcept { timeouts_ = t; }
+    // 超过 RouteOptions::spill_threshold 的请求体写到这个目录下的匿名临时文件，默认系统临时目录
+    void set_spill_dir(std::string dir) { spill_dir_ = std::move(dir); }
+    // HTTP/2 明文（h2c）：以连接前言开头的连接（prior knowledge）和带 Upgrade: h2c 的请求
+    // 切换到 HTTP/2，路由与处理函数不变。默认开启
+    void set_http2(bool on) noexcept { http2_ = on; }
+    // WebSocket 端点：到 path 的 GET 请求带 Upgrade: websocket 时升级，在路由之前匹配，
+    // 连接此后留在接受它的 loop 上，回调都在那个线程上调用。广播见 WsChannel
+    void add_websocket(std::string path, WsHandlers handlers) {
+        ws_routes_.emplace_back(std::move(path), std::make_shared<const WsHandlers>(std::move(handlers)));
+    }
 
-    [[nodiscard]] bool listen_and_serve(); // 失败返回 false
+    // 内置指标端点：对 GET path 返回 metrics()，在路由之前匹配。默认关闭（空串）
+    void set_metrics_path(std::string path) { metrics_path_ = std::move(path); }
+    // 请求分阶段追踪（采样 / 慢请求），默认关闭。转储方式：trace() / dump_trace()、
+    // 内置端点 set_trace_path()，或者收到 set_trace_signal() 的信号时写到文件
+    void set_tracing(const TraceOptions& opts) noexcept { trace_opts_ = opts; }
+    void set_trace_path(std::string path) { trace_path_ = std::move(path); }
+    // 收到 signo（例如 SIGUSR2）后由 loop 0 把 trace() 写进 file，最迟延迟一个 poll 超时。
+    // 会替换该信号原有的处理函数
+    void set_trace_signal(int signo, std::string file);
+
+    [[nodiscard]] bool listen_and_serve(); // 失败返回 false；阻塞直到 stop()
     void stop() noexcept;
 
-private:
-    [[nodiscard]] bool setup_socket();
-    static void        close_socket(socket_t s) noexcept;
-    static bool        set_nonblocking(socket_t s) noexcept;
-    [[nodiscard]] bool handle_read(Connection& c);
-    [[nodiscard]] bool handle_write(Connection& c);
+    // 所有 loop 的计数之和，listen_and_serve 返回后有效
+    const LoopStats& stats() const noexcept { return stats_; }
+    // 所有 loop 的指标，Prometheus 文本格式。任意线程随时调用：只读各 loop 的计数器，
+    // 不打断它们；listen_and_serve 返回后仍是最后一次运行的累计值
+    std::string metrics() const;
+    // 各 loop 环形缓冲里的追踪记录，Chrome trace JSON。任意线程随时调用，同 metrics()
+    std::string trace() const;
+    [[nodiscard]] bool dump_trace(const std::string& file) const;
 
 private:
-    uint16_t                                 port_{};
-    socket_t                                 listen_fd_{};
-    std::unordered_map<socket_t, Connection> conns_;
-    std::atomic<bool>                        running_{false};
-    const http::Router*                      router_{nullptr};
+    uint16_t                                port_{};
+    std::atomic<bool>                       running_{false};
+    const http::Router*                     router_{nullptr};
+    Backend                                 backend_{Backend::Auto};
+    unsigned                                threads_{1};
+    bool                                    pin_cpus_{false};
+    unsigned                                workers_{0};
+    Timeouts                                timeouts_;
+    std::string                             spill_dir_;
+    bool                                    http2_{true};
+    std::vector<std::pair<std::string, std::shared_ptr<const WsHandlers>>> ws_routes_;
+    std::unique_ptr<WorkerPool>             pool_;    // 先于 loops_ 停止，晚于 loops_ 销毁
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    LoopStats                               stats_;
+    std::string                             metrics_path_;
+    TraceOptions                            trace_opts_;
+    std::string                             trace_path_;
+    std::string                             trace_file_;  // 信号触发时写到这里
+    mutable std::mutex                      metrics_mu_; // 只保护下面两个列表，请求路径上不碰
+    std::vector<std::shared_ptr<const LoopMetrics>> metrics_;
+    std::vector<std::shared_ptr<const TraceRing>>   traces_;
 };
 
 } // namespace net
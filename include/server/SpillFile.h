@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace net {
+
+// 落盘的请求体（RouteOptions::spill_threshold）：临时目录下的匿名文件，
+// Linux 上用 O_TMPFILE，其他平台创建后立即删除（Windows 为关闭时删除），关闭即释放磁盘空间。
+// 由请求共享持有（HttpRequest::body_file.owner），交给工作线程、连接中途关闭都安全
+class SpillFile {
+public:
+    // dir 为空时用系统临时目录；失败返回 nullptr
+    static std::shared_ptr<SpillFile> create(const std::string& dir);
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    // 追加写入，写不完（磁盘满等）返回 false
+    bool write(std::string_view data) noexcept;
+
+    int      fd() const noexcept { return fd_; }
+    uint64_t size() const noexcept { return size_; }
+
+private:
+    explicit SpillFile(int fd) noexcept : fd_(fd) {}
+
+    int      fd_;
+    uint64_t size_{0};
+};
+
+} // namespace net
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+
+namespace net {
+
+// 侵入式定时器节点：嵌在拥有者（连接、协程调用）里，挂上 / 摘下都是 O(1)，不分配内存。
+// 拥有者销毁时节点自动摘下；移动得到的是一个未挂上的新节点。
+struct TimerNode {
+    TimerNode* prev{nullptr};
+    TimerNode* next{nullptr};
+    uint64_t   expires{0}; // 到期 tick
+    uint64_t   data{0};    // 由使用者解释（EventLoop 里是类型 + gen + fd）
+    uint8_t    level{0};
+    uint8_t    slot{0};
+
+    TimerNode() = default;
+    TimerNode(TimerNode&& o) noexcept : data(o.data) {}
+    TimerNode& operator=(TimerNode&&) = delete;
+    ~TimerNode() { unlink(); }
+
+    bool linked() const noexcept { return next != nullptr; }
+    void unlink() noexcept {
+        if (!next) return;
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+    }
+};
+
+// 分层时间轮：4 层 x 64 槽，tick 由调用方定义（EventLoop 用毫秒），覆盖 2^24 个 tick
+// （约 4.6 小时），更远的定时器先挂在最远处，到时按 expires 重新挂。
+// 定时器落在与当前 tick 最高几位相同的那一层：到期前只在跨层边界时下移（级联）一次，
+// 所以挂上、摘下、到期都是 O(1)；advance 用每层的占用位图跳过空槽。
+// 只在单个线程上使用。
+class TimerWheel {
+public:
+    explicit TimerWheel(uint64_t now = 0) noexcept;
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // 已在轮上的节点先摘下再挂；expires <= 当前 tick 的在下一个 tick 到期
+    void schedule(TimerNode& n, uint64_t expires) noexcept;
+    void cancel(TimerNode& n) noexcept;
+
+    // 推进到 now：到期的节点移进到期队列，由 pop_expired 逐个取出（取出时已摘下，
+    // 处理时可以重新 schedule 或直接销毁其拥有者）
+    void       advance(uint64_t now) noexcept;
+    TimerNode* pop_expired() noexcept;
+
+    // 下一次需要 advance 的 tick（有节点到期或要级联），没有定时器时为 UINT64_MAX
+    uint64_t next_tick() const noexcept;
+    uint64_t now() const noexcept { return cur_; }
+
+private:
+    static constexpr unsigned kBits   = 6;
+    static constexpr unsigned kSlots  = 1u << kBits;
+    static constexpr unsigned kLevels = 4;
+
+    void place(TimerNode& n) noexcept;
+    void cascade(unsigned level) noexcept;
+    void expire(TimerNode& n) noexcept;
+    void expire_slot(unsigned slot) noexcept;
+
+    uint64_t  cur_;
+    uint64_t  mask_[kLevels]{};          // 非空槽位图（摘下节点时可能残留，扫描到时清掉）
+    TimerNode slots_[kLevels][kSlots];   // 每个槽一条带哨兵的循环链表
+    TimerNode expired_;
+};
+
+} // namespace net
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "http/Router.h"
+
+namespace net {
+
+// 请求追踪的开关（Server::set_tracing）。两个条件任一满足就把请求记进环形缓冲：
+// 按采样间隔抽中，或者从第一个字节到达到响应发完超过 slow_us。两个都为 0 时不追踪，
+// 热路径上只剩一次空指针判断
+struct TraceOptions {
+    uint32_t sample_every{0}; // 每 N 个请求记一个，1 为全记，0 为不采样
+    uint32_t slow_us{0};      // 慢请求阈值（微秒），0 为不按耗时捕获
+    uint32_t capacity{4096};  // 每个 loop 保留的最近记录数，向上取 2 的幂
+};
+
+// 追踪时间戳：x86-64 上读 TSC（不进内核，比 steady_clock 便宜几倍），
+// 其他平台是 steady_clock 的纳秒数。换算系数在第一次用到时校准一次
+uint64_t trace_ticks() noexcept;
+double   trace_ns_per_tick() noexcept;
+
+// 一个请求各阶段的时间戳（tick），共 128 字节：
+//   start      请求的第一个字节到达（那次 recv 返回时）
+//   parsed     请求完整；parse_ticks 是其间花在解析器里的时间
+//   routed     响应交回 loop（处理函数返回，工作线程 / 协程的时间也算在路由里）
+//   serialized 响应头写好、响应进了输出队列
+//   sent       最后一个字节交给内核
+struct TraceRecord {
+    static constexpr uint8_t kSampled = 1;
+
+    uint64_t start{0};
+    uint64_t parsed{0};
+    uint64_t routed{0};
+    uint64_t serialized{0};
+    uint64_t sent{0};
+    uint64_t parse_ticks{0};
+    uint64_t end_offset{0}; // 响应在连接输出流里的结束位置，发到这里即发完
+    uint32_t route{0};      // Route::id
+    uint32_t fd{0};
+    uint16_t status{0};
+    uint8_t  method{0};     // http::Method
+    uint8_t  flags{0};
+    char     path[60]{};    // 截断，以 '\0' 结尾
+};
+static_assert(sizeof(TraceRecord) == 128);
+
+// 一个 loop 的追踪记录：单写者（loop 线程）、多读者的无锁环形缓冲，新记录覆盖最旧的。
+// 每个槽带序号（seqlock）：写时先置为奇数，写完置为偶数；读者前后两次读序号一致
+// 且为偶数才采用，否则丢弃（正被覆盖）。写一条记录不加锁、不分配
+class TraceRing {
+public:
+    TraceRing(const TraceOptions& opts, unsigned loop_index);
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    // loop 线程：新请求是否抽中采样
+    bool sample() noexcept {
+        return sample_every_ && ++seq_ % sample_every_ == 0;
+    }
+    // loop 线程：请求发完，满足采样或慢请求条件就写进环
+    void finish(const TraceRecord& r) noexcept {
+        if ((r.flags & TraceRecord::kSampled) || (slow_ticks_ && r.sent - r.start >= slow_ticks_)) push(r);
+    }
+
+    // 任意线程：按写入顺序取出当前的全部记录
+    void snapshot(std::vector<TraceRecord>& out) const;
+    unsigned loop_index() const noexcept { return loop_; }
+
+private:
+    static constexpr size_t kWords = sizeof(TraceRecord) / sizeof(uint64_t);
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> words[kWords];
+    };
+
+    void push(const TraceRecord& r) noexcept;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t                  mask_;
+    std::atomic<uint64_t>   head_{0}; // 已写入的记录总数
+    uint64_t                seq_{0};
+    uint32_t                sample_every_;
+    uint64_t                slow_ticks_;
+    unsigned                loop_;
+};
+
+// 把各 loop 的记录合成 Chrome trace JSON（chrome://tracing、Perfetto 可直接打开）：
+// 进程为 loop，线程为连接 fd；每个请求一个总跨度，下面是 recv / parse / route / serialize / send
+std::string render_chrome_trace(const std::vector<std::shared_ptr<const TraceRing>>& loops,
+                                const http::Router* router);
+
+// 异步信号安全：在信号处理函数里登记一次转储请求，由 loop 0 在下一轮事件里执行
+void request_trace_dump() noexcept;
+bool take_trace_dump_request() noexcept;
+
+} // namespace net
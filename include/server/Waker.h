@@ -0,0 +1,28 @@
+#pragma once
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+// 从其他线程唤醒事件循环：一个可注册进 Poller / io_uring 的可读句柄。
+// Linux 上是 eventfd，其他 POSIX 平台是非阻塞 pipe，Windows 上是连向自己的回环 UDP socket。
+class Waker {
+public:
+    Waker() = default;
+    ~Waker();
+    Waker(const Waker&) = delete;
+    Waker& operator=(const Waker&) = delete;
+
+    [[nodiscard]] bool open();
+    // 注册进 Poller（电平触发的可读）或在 io_uring 上挂 READ 的句柄
+    socket_t fd() const noexcept { return read_fd_; }
+    // 任意线程调用：让 fd() 变为可读
+    void notify() noexcept;
+    // loop 线程调用：读空，直到下一次 notify 前不再可读
+    void drain() noexcept;
+
+private:
+    socket_t read_fd_{kInvalidSocket};
+    socket_t write_fd_{kInvalidSocket}; // eventfd 时与 read_fd_ 相同
+};
+
+} // namespace net
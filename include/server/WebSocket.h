@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "http/HttpRequest.h"
+#include "http/WebSocket.h"
+#include "server/PlatformSocket.h"
+
+namespace net {
+
+class EventLoop;
+
+// 升级成 WebSocket 的连接交给回调的句柄。只在连接所属 loop 的线程上使用，
+// 从 on_open 到 on_close 返回为止有效；要从别的线程发消息用 WsChannel::publish。
+// 发送只是入队，本轮事件处理完统一发出
+class WebSocket {
+public:
+    void send_text(std::string_view text);
+    void send_binary(std::string_view data);
+    // 已序列化的消息：只排一个共享段，不拷贝
+    void send(const http::WsMessage& m);
+    void ping(std::string_view payload = {});
+    // 发起关闭握手：发出 Close 后不再发送，等对端回 Close 再断开（最多等 kCloseWaitMs）
+    void close(uint16_t code = http::kWsCloseNormal, std::string_view reason = {});
+
+    // 在本 loop 上唯一，可作为应用自己的表的键
+    uint64_t id() const noexcept { return (static_cast<uint64_t>(gen_) << 32) | static_cast<uint32_t>(fd_); }
+    // 已入队未发出的字节数
+    uint64_t buffered() const noexcept;
+
+    static constexpr uint32_t kCloseWaitMs = 5000;
+
+private:
+    friend class EventLoop;
+    friend class WsChannel;
+    WebSocket(EventLoop* loop, socket_t fd, uint32_t gen) noexcept : loop_(loop), fd_(fd), gen_(gen) {}
+
+    EventLoop* loop_;
+    socket_t   fd_;
+    uint32_t   gen_;
+};
+
+// 一个 WebSocket 端点的回调与限制，各 loop 共享（回调可能在多个线程上同时被调用）
+struct WsHandlers {
+    // 升级完成：req 是升级请求，只在回调期间有效。要拒绝可在这里 close()
+    std::function<void(WebSocket&, const http::HttpRequest&)>       on_open;
+    // 完整的消息（分片已拼好、文本已校验 UTF-8），data 只在回调期间有效
+    std::function<void(WebSocket&, std::string_view data, bool binary)> on_message;
+    // 每个连接恰好一次：对端的 Close 码、协议错误时发出的码，没收到 Close 就断开为 1006
+    std::function<void(WebSocket&, uint16_t code)>                 on_close;
+    // 支持的子协议：按这里的顺序取第一个客户端在 Sec-WebSocket-Protocol 里也给出的
+    std::vector<std::string> protocols;
+    size_t   max_message{1 << 20}; // 超过回 1009 并关闭
+    // 待发超过这么多（对端读得比广播慢）直接断开，广播的内存不会被一个慢客户端撑大
+    uint64_t max_backlog{4 << 20};
+    uint32_t idle_ms{0};           // 这么久没收到任何帧就断开，0 为不限制（应用自己 ping）
+};
+
+// 广播频道：消息序列化一次，所有订阅者的输出队列共享同一块缓冲
+// （OutputQueue::append_shared），不按客户端拷贝。
+// 订阅表按 loop 分开：订阅 / 退订在连接所属 loop 上进行，不加锁；发布可在任意线程，
+// 本线程的 loop 当场分发，其他 loop 经各自的无锁队列 + Waker 在自己的线程上分发。
+// 频道要比 Server 活得久（同 Router）
+class WsChannel {
+public:
+    WsChannel() = default;
+    WsChannel(const WsChannel&) = delete;
+    WsChannel& operator=(const WsChannel&) = delete;
+
+    // 连接所属 loop 的线程上调用（回调里）；重复订阅没有效果，连接关闭时自动退订
+    void subscribe(WebSocket& ws);
+    void unsubscribe(WebSocket& ws);
+
+    // 任意线程调用
+    void publish(const http::WsMessage& m);
+    void publish_text(std::string_view text) { publish(http::WsMessage::text(text)); }
+    void publish_binary(std::string_view data) { publish(http::WsMessage::binary(data)); }
+
+    // 所有 loop 上的订阅者数，近似值
+    size_t subscribers() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+private:
+    friend class EventLoop;
+
+    std::mutex              mu_;    // 只保护 loops_：新 loop 加入、loop 销毁、跨线程发布
+    std::vector<EventLoop*> loops_; // 有过订阅者的 loop
+    std::atomic<size_t>     count_{0};
+};
+
+} // namespace net
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "server/MpscQueue.h"
+
+namespace net {
+
+// 交给 WorkerPool 的任务。池不拥有任务：run 之后由任务自己决定去向
+// （例如挂回事件循环的完成队列），池停止时尚未执行的任务收到 cancel
+struct Task : MpscNode {
+    virtual ~Task() = default;
+    virtual void run() noexcept = 0;
+    virtual void cancel() noexcept = 0;
+};
+
+// 固定大小的工作线程池，给会阻塞的处理函数用，事件循环线程只负责投递。
+// 每个线程一个双端队列：投递按轮转分散到各队列，线程从自己的队头取（先到先服务），
+// 自己的空了就去别的队列尾部偷，慢任务堆在一个队列里时其余线程会把它分走。
+// 队列短且只在投递 / 取任务时加锁，不在处理函数执行期间持有。
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads);
+    ~WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void start();
+    // 等正在执行的任务结束后返回，未开始的任务被 cancel
+    void stop() noexcept;
+    // 任意线程调用
+    void submit(Task* t);
+
+    unsigned size() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex        mu;
+        std::deque<Task*> tasks;
+    };
+
+    void  worker(unsigned self);
+    Task* take(unsigned self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread>            threads_;
+    std::atomic<unsigned>               next_{0};
+    std::atomic<size_t>                 pending_{0}; // 所有队列里的任务数
+    std::mutex                          sleep_mu_;
+    std::condition_variable             sleep_cv_;
+    std::atomic<bool>                   stop_{false};
+};
+
+} // namespace net
@@ -0,0 +1,106 @@
+#include "http/BodyDecoder.h"
+
+namespace http {
+
+void BodyDecoder::reset_length(uint64_t n) noexcept {
+    chunked_   = false;
+    remaining_ = n;
+    size_      = 0;
+    state_     = n > 0 ? State::Data : State::Done;
+}
+
+void BodyDecoder::reset_chunked() noexcept {
+    chunked_    = true;
+    remaining_  = 0;
+    size_       = 0;
+    digits_     = 0;
+    framing_    = 0;
+    line_empty_ = true;
+    state_      = State::Size;
+}
+
+static int hex_value(char c) noexcept {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+size_t BodyDecoder::next(std::string_view in, std::string_view& data) noexcept {
+    data = {};
+    size_t i = 0;
+    // 帧结构逐字节走状态机；数据部分整段切出，不逐字节看
+    while (i < in.size()) {
+        const char ch = in[i];
+        switch (state_) {
+            case State::Data: {
+                const size_t n = remaining_ < in.size() - i ? static_cast<size_t>(remaining_) : in.size() - i;
+                data = in.substr(i, n);
+                i += n;
+                remaining_ -= n;
+                size_ += n;
+                if (remaining_ == 0) state_ = chunked_ ? State::DataCr : State::Done;
+                return i;
+            }
+            case State::Size: {
+                const int v = hex_value(ch);
+                if (v >= 0) {
+                    if (++digits_ > 15) { state_ = State::Error; return i; } // 超过 2^60，必然超限
+                    remaining_ = remaining_ * 16 + static_cast<uint64_t>(v);
+                    break;
+                }
+                if (digits_ == 0) { state_ = State::Error; return i; }
+                if (ch == '\r')                  state_ = State::SizeLf;
+                else if (ch == ';' || ch == ' ' || ch == '\t') state_ = State::Ext;
+                else { state_ = State::Error; return i; }
+                break;
+            }
+            case State::Ext:
+                if (ch == '\r')              state_ = State::SizeLf;
+                else if (++framing_ > kMaxFraming) { state_ = State::Error; return i; }
+                break;
+            case State::SizeLf:
+                if (ch != '\n') { state_ = State::Error; return i; }
+                digits_ = 0;
+                if (remaining_ == 0) { // last-chunk：后面是 trailer 和空行
+                    line_empty_ = true;
+                    state_      = State::Trailer;
+                } else {
+                    state_ = State::Data;
+                }
+                break;
+            case State::DataCr:
+                if (ch != '\r') { state_ = State::Error; return i; }
+                state_ = State::DataLf;
+                break;
+            case State::DataLf:
+                if (ch != '\n') { state_ = State::Error; return i; }
+                state_ = State::Size;
+                break;
+            case State::Trailer:
+                if (ch == '\r') {
+                    state_ = State::TrailerLf;
+                } else {
+                    line_empty_ = false;
+                    if (++framing_ > kMaxFraming) { state_ = State::Error; return i; }
+                }
+                break;
+            case State::TrailerLf:
+                if (ch != '\n') { state_ = State::Error; return i; }
+                if (line_empty_) {
+                    state_ = State::Done;
+                    return i + 1;
+                }
+                line_empty_ = true;
+                state_      = State::Trailer;
+                break;
+            case State::Done:
+            case State::Error:
+                return i;
+        }
+        ++i;
+    }
+    return i;
+}
+
+} // namespace http
@@ -0,0 +1,262 @@
+#include "http/Compression.h"
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace http {
+
+namespace {
+
+std::string_view trim_ows(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// q 值是否大于 0（"0"、"0.0"、"0.000" 都是 0）
+bool q_positive(std::string_view params) {
+    while (!params.empty()) {
+        const size_t semi = params.find(';');
+        const std::string_view p = trim_ows(params.substr(0, semi));
+        if (p.size() >= 2 && (p[0] == 'q' || p[0] == 'Q') && p[1] == '=') {
+            for (char ch : p.substr(2))
+                if (ch >= '1' && ch <= '9') return true;
+            return false;
+        }
+        if (semi == std::string_view::npos) break;
+        params.remove_prefix(semi + 1);
+    }
+    return true; // 没写 q 即 q=1
+}
+
+#ifdef HAVE_ZLIB
+// 每个线程一个 z_stream，deflateReset 复用内部窗口与哈希表
+struct GzipState {
+    z_stream zs{};
+    bool     ready{false};
+    int      level{-1};
+
+    ~GzipState() {
+        if (ready) deflateEnd(&zs);
+    }
+    bool prepare(int lvl) {
+        if (!ready) {
+            // windowBits 15 + 16：带 gzip 头尾
+            if (deflateInit2(&zs, lvl, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+            ready = true;
+            level = lvl;
+            return true;
+        }
+        if (deflateReset(&zs) != Z_OK) return false;
+        if (lvl != level) {
+            if (deflateParams(&zs, lvl, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+            level = lvl;
+        }
+        return true;
+    }
+};
+thread_local GzipState t_gzip;
+#endif
+
+#ifdef HAVE_BROTLI
+// brotli 的编码器实例不能复用，但它的内存可以：分配走一个线程内的 bump arena，
+// free 不做事，实例销毁后整块回卷，之后的压缩不再向 malloc 申请内存
+class Arena {
+public:
+    static void* alloc(void* self, size_t n) { return static_cast<Arena*>(self)->take(n); }
+    static void  release(void*, void*) {}
+
+    void rewind() noexcept {
+        cur_ = 0;
+        used_ = 0;
+    }
+
+private:
+    static constexpr size_t kBlock = 1 << 20;
+
+    void* take(size_t n) {
+        n = (n + 15) & ~size_t{15};
+        while (cur_ < blocks_.size()) {
+            if (used_ + n <= sizes_[cur_]) {
+                void* p = blocks_[cur_].get() + used_;
+                used_ += n;
+                return p;
+            }
+            ++cur_;
+            used_ = 0;
+        }
+        const size_t sz = n > kBlock ? n : kBlock;
+        blocks_.emplace_back(new (std::nothrow) char[sz]);
+        if (!blocks_.back()) { blocks_.pop_back(); return nullptr; }
+        sizes_.push_back(sz);
+        cur_  = blocks_.size() - 1;
+        used_ = n;
+        return blocks_.back().get();
+    }
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    std::vector<size_t>                  sizes_;
+    size_t                               cur_{0};
+    size_t                               used_{0};
+};
+thread_local Arena t_brotli_arena;
+#endif
+
+} // namespace
+
+std::string_view encoding_token(Encoding e) noexcept {
+    switch (e) {
+        case Encoding::Gzip:   return "gzip";
+        case Encoding::Brotli: return "br";
+        default:               return "identity";
+    }
+}
+
+bool accepts_encoding(std::string_view ae, std::string_view coding) noexcept {
+    bool star = false;
+    while (!ae.empty()) {
+        const size_t comma = ae.find(',');
+        const std::string_view item = ae.substr(0, comma);
+        const size_t semi = item.find(';');
+        const std::string_view token = trim_ows(item.substr(0, semi));
+        const std::string_view params = semi == std::string_view::npos ? std::string_view{} : item.substr(semi + 1);
+        if (iequals(token, coding)) return q_positive(params); // 明确列出的以它为准
+        if (token == "*") star = q_positive(params);
+        if (comma == std::string_view::npos) break;
+        ae.remove_prefix(comma + 1);
+    }
+    return star;
+}
+
+bool compressible_type(std::string_view ct) noexcept {
+    const std::string_view t = trim_ows(ct.substr(0, ct.find(';')));
+    if (t.size() >= 5 && iequals(t.substr(0, 5), "text/")) return true;
+    for (std::string_view sub : {"json", "javascript", "xml", "svg", "ecmascript", "wasm"}) {
+        if (t.size() < sub.size()) continue;
+        for (size_t i = 0; i + sub.size() <= t.size(); ++i)
+            if (iequals(t.substr(i, sub.size()), sub)) return true;
+    }
+    return false;
+}
+
+bool codec_available(Encoding e) noexcept {
+    switch (e) {
+#ifdef HAVE_ZLIB
+        case Encoding::Gzip: return true;
+#endif
+#ifdef HAVE_BROTLI
+        case Encoding::Brotli: return true;
+#endif
+        case Encoding::Identity: return true;
+        default: return false;
+    }
+}
+
+bool gzip_compress(std::string_view in, std::string& out, int level) {
+#ifdef HAVE_ZLIB
+    GzipState& g = t_gzip;
+    if (!g.prepare(level)) return false;
+    const size_t base = out.size();
+    out.resize(base + deflateBound(&g.zs, static_cast<uLong>(in.size())));
+    g.zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    g.zs.avail_in  = static_cast<uInt>(in.size());
+    g.zs.next_out  = reinterpret_cast<Bytef*>(out.data() + base);
+    g.zs.avail_out = static_cast<uInt>(out.size() - base);
+    const int rc = deflate(&g.zs, Z_FINISH); // 输出空间按 deflateBound 给足，一次完成
+    if (rc != Z_STREAM_END) { out.resize(base); return false; }
+    out.resize(base + g.zs.total_out);
+    return true;
+#else
+    (void)in; (void)out; (void)level;
+    return false;
+#endif
+}
+
+bool brotli_compress(std::string_view in, std::string& out, int quality) {
+#ifdef HAVE_BROTLI
+    Arena& arena = t_brotli_arena;
+    BrotliEncoderState* st = BrotliEncoderCreateInstance(&Arena::alloc, &Arena::release, &arena);
+    if (!st) { arena.rewind(); return false; }
+    // 窗口按输入大小收窄，小响应不必为 4MB 窗口付出内存
+    int lgwin = BROTLI_MIN_WINDOW_BITS;
+    while (lgwin < BROTLI_MAX_WINDOW_BITS && (size_t{1} << lgwin) < in.size()) ++lgwin;
+    BrotliEncoderSetParameter(st, BROTLI_PARAM_QUALITY, static_cast<uint32_t>(quality));
+    BrotliEncoderSetParameter(st, BROTLI_PARAM_LGWIN, static_cast<uint32_t>(lgwin));
+    BrotliEncoderSetParameter(st, BROTLI_PARAM_SIZE_HINT, static_cast<uint32_t>(in.size()));
+
+    const size_t base  = out.size();
+    size_t       bound = BrotliEncoderMaxCompressedSize(in.size());
+    if (bound == 0) bound = in.size() + 1024;
+    out.resize(base + bound);
+    size_t         avail_in  = in.size();
+    const uint8_t* next_in   = reinterpret_cast<const uint8_t*>(in.data());
+    size_t         avail_out = bound;
+    uint8_t*       next_out  = reinterpret_cast<uint8_t*>(out.data() + base);
+    const bool ok = BrotliEncoderCompressStream(st, BROTLI_OPERATION_FINISH, &avail_in, &next_in, &avail_out,
+                                                &next_out, nullptr) &&
+                    BrotliEncoderIsFinished(st);
+    BrotliEncoderDestroyInstance(st);
+    arena.rewind();
+    out.resize(ok ? base + (bound - avail_out) : base);
+    return ok;
+#else
+    (void)in; (void)out; (void)quality;
+    return false;
+#endif
+}
+
+void add_vary(HttpResponse& resp, std::string_view field) {
+    std::pmr::string& v = resp.headers["Vary"];
+    std::string_view rest = v;
+    while (!rest.empty()) {
+        const size_t comma = rest.find(',');
+        if (iequals(trim_ows(rest.substr(0, comma)), field)) return;
+        if (comma == std::string_view::npos) break;
+        rest.remove_prefix(comma + 1);
+    }
+    if (!v.empty()) v += ", ";
+    v += field;
+}
+
+bool compress_response(const HttpRequest& req, HttpResponse& resp, const CompressOptions& opts) {
+    if (!opts.enabled || resp.status != 200 || req.method == Method::HEAD) return false;
+    if (resp.file.fd >= 0 || resp.shared_body || resp.stream || resp.body.size() < opts.min_size) return false;
+    if (resp.headers.count("Content-Encoding")) return false;
+    auto ct = resp.headers.find("Content-Type");
+    if (ct == resp.headers.end() || !compressible_type(ct->second)) return false;
+
+    // 表示会随 Accept-Encoding 变化：无论这次是否压缩都要告诉缓存
+    add_vary(resp, "Accept-Encoding");
+    const std::string_view ae = req.header("Accept-Encoding");
+    if (ae.empty()) return false;
+
+    Encoding enc = Encoding::Identity;
+    if (codec_available(Encoding::Brotli) && accepts_encoding(ae, "br"))        enc = Encoding::Brotli;
+    else if (codec_available(Encoding::Gzip) && accepts_encoding(ae, "gzip"))   enc = Encoding::Gzip;
+    if (enc == Encoding::Identity) return false;
+
+    std::string out;
+    const bool ok = enc == Encoding::Brotli ? brotli_compress(resp.body, out, opts.brotli_quality)
+                                            : gzip_compress(resp.body, out, opts.gzip_level);
+    if (!ok || out.size() >= resp.body.size()) return false;
+
+    resp.body = std::move(out);
+    resp.set_header("Content-Encoding", encoding_token(enc));
+    // 强 ETag 标识的是未压缩的表示，压缩后换一个
+    if (auto et = resp.headers.find("ETag"); et != resp.headers.end() && et->second.size() >= 2 &&
+                                             et->second.front() == '"' && et->second.back() == '"') {
+        et->second.insert(et->second.size() - 1, "-" + std::string(encoding_token(enc)));
+    }
+    return true;
+}
+
+} // namespace http
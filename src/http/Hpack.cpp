@@ -0,0 +1,409 @@
+#include "http/Hpack.h"
+
+#include <algorithm>
+#include <array>
+
+namespace http {
+
+namespace {
+
+// RFC 7541 Appendix B：每个符号（0-255 与 EOS）的码字与位数
+constexpr uint32_t kHuffCode[257] = {
+    0x00001ff8, 0x007fffd8, 0x0fffffe2, 0x0fffffe3, 0x0fffffe4, 0x0fffffe5, 0x0fffffe6, 0x0fffffe7,
+    0x0fffffe8, 0x00ffffea, 0x3ffffffc, 0x0fffffe9, 0x0fffffea, 0x3ffffffd, 0x0fffffeb, 0x0fffffec,
+    0x0fffffed, 0x0fffffee, 0x0fffffef, 0x0ffffff0, 0x0ffffff1, 0x0ffffff2, 0x3ffffffe, 0x0ffffff3,
+    0x0ffffff4, 0x0ffffff5, 0x0ffffff6, 0x0ffffff7, 0x0ffffff8, 0x0ffffff9, 0x0ffffffa, 0x0ffffffb,
+    0x00000014, 0x000003f8, 0x000003f9, 0x00000ffa, 0x00001ff9, 0x00000015, 0x000000f8, 0x000007fa,
+    0x000003fa, 0x000003fb, 0x000000f9, 0x000007fb, 0x000000fa, 0x00000016, 0x00000017, 0x00000018,
+    0x00000000, 0x00000001, 0x00000002, 0x00000019, 0x0000001a, 0x0000001b, 0x0000001c, 0x0000001d,
+    0x0000001e, 0x0000001f, 0x0000005c, 0x000000fb, 0x00007ffc, 0x00000020, 0x00000ffb, 0x000003fc,
+    0x00001ffa, 0x00000021, 0x0000005d, 0x0000005e, 0x0000005f, 0x00000060, 0x00000061, 0x00000062,
+    0x00000063, 0x00000064, 0x00000065, 0x00000066, 0x00000067, 0x00000068, 0x00000069, 0x0000006a,
+    0x0000006b, 0x0000006c, 0x0000006d, 0x0000006e, 0x0000006f, 0x00000070, 0x00000071, 0x00000072,
+    0x000000fc, 0x00000073, 0x000000fd, 0x00001ffb, 0x0007fff0, 0x00001ffc, 0x00003ffc, 0x00000022,
+    0x00007ffd, 0x00000003, 0x00000023, 0x00000004, 0x00000024, 0x00000005, 0x00000025, 0x00000026,
+    0x00000027, 0x00000006, 0x00000074, 0x00000075, 0x00000028, 0x00000029, 0x0000002a, 0x00000007,
+    0x0000002b, 0x00000076, 0x0000002c, 0x00000008, 0x00000009, 0x0000002d, 0x00000077, 0x00000078,
+    0x00000079, 0x0000007a, 0x0000007b, 0x00007ffe, 0x000007fc, 0x00003ffd, 0x00001ffd, 0x0ffffffc,
+    0x000fffe6, 0x003fffd2, 0x000fffe7, 0x000fffe8, 0x003fffd3, 0x003fffd4, 0x003fffd5, 0x007fffd9,
+    0x003fffd6, 0x007fffda, 0x007fffdb, 0x007fffdc, 0x007fffdd, 0x007fffde, 0x00ffffeb, 0x007fffdf,
+    0x00ffffec, 0x00ffffed, 0x003fffd7, 0x007fffe0, 0x00ffffee, 0x007fffe1, 0x007fffe2, 0x007fffe3,
+    0x007fffe4, 0x001fffdc, 0x003fffd8, 0x007fffe5, 0x003fffd9, 0x007fffe6, 0x007fffe7, 0x00ffffef,
+    0x003fffda, 0x001fffdd, 0x000fffe9, 0x003fffdb, 0x003fffdc, 0x007fffe8, 0x007fffe9, 0x001fffde,
+    0x007fffea, 0x003fffdd, 0x003fffde, 0x00fffff0, 0x001fffdf, 0x003fffdf, 0x007fffeb, 0x007fffec,
+    0x001fffe0, 0x001fffe1, 0x003fffe0, 0x001fffe2, 0x007fffed, 0x003fffe1, 0x007fffee, 0x007fffef,
+    0x000fffea, 0x003fffe2, 0x003fffe3, 0x003fffe4, 0x007ffff0, 0x003fffe5, 0x003fffe6, 0x007ffff1,
+    0x03ffffe0, 0x03ffffe1, 0x000fffeb, 0x0007fff1, 0x003fffe7, 0x007ffff2, 0x003fffe8, 0x01ffffec,
+    0x03ffffe2, 0x03ffffe3, 0x03ffffe4, 0x07ffffde, 0x07ffffdf, 0x03ffffe5, 0x00fffff1, 0x01ffffed,
+    0x0007fff2, 0x001fffe3, 0x03ffffe6, 0x07ffffe0, 0x07ffffe1, 0x03ffffe7, 0x07ffffe2, 0x00fffff2,
+    0x001fffe4, 0x001fffe5, 0x03ffffe8, 0x03ffffe9, 0x0ffffffd, 0x07ffffe3, 0x07ffffe4, 0x07ffffe5,
+    0x000fffec, 0x00fffff3, 0x000fffed, 0x001fffe6, 0x003fffe9, 0x001fffe7, 0x001fffe8, 0x007ffff3,
+    0x003fffea, 0x003fffeb, 0x01ffffee, 0x01ffffef, 0x00fffff4, 0x00fffff5, 0x03ffffea, 0x007ffff4,
+    0x03ffffeb, 0x07ffffe6, 0x03ffffec, 0x03ffffed, 0x07ffffe7, 0x07ffffe8, 0x07ffffe9, 0x07ffffea,
+    0x07ffffeb, 0x0ffffffe, 0x07ffffec, 0x07ffffed, 0x07ffffee, 0x07ffffef, 0x07fffff0, 0x03ffffee,
+    0x3fffffff,
+};
+constexpr uint8_t kHuffLen[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+     6, 10, 10, 12, 13,  6,  8, 11, 10, 10,  8, 11,  8,  6,  6,  6,
+     5,  5,  5,  6,  6,  6,  6,  6,  6,  6,  7,  8, 15,  6, 12, 10,
+    13,  6,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,  7,
+     7,  7,  7,  7,  7,  7,  7,  7,  8,  7,  8, 13, 19, 13, 14,  6,
+    15,  5,  6,  5,  6,  5,  6,  6,  6,  5,  7,  7,  6,  6,  6,  5,
+     6,  7,  6,  5,  5,  6,  7,  7,  7,  7,  7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+// 码表是规范 Huffman 码：同一长度的码字连续递增。按 (位数, 码字) 排好的符号与各长度的码字数，
+// 解码时逐个长度比较即可，不需要展开成树或大表
+constexpr uint16_t kHuffSymbols[257] = {
+     48,  49,  50,  97,  99, 101, 105, 111, 115, 116,  32,  37,  45,  46,  47,  51,
+     52,  53,  54,  55,  56,  57,  61,  65,  95,  98, 100, 102, 103, 104, 108, 109,
+    110, 112, 114, 117,  58,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+     77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  89, 106, 107, 113, 118,
+    119, 120, 121, 122,  38,  42,  44,  59,  88,  90,  33,  34,  40,  41,  63,  39,
+     43, 124,  35,  62,   0,  36,  64,  91,  93, 126,  94, 125,  60,  96, 123,  92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161, 167, 172, 176, 177,
+    179, 209, 216, 217, 227, 229, 230, 129, 132, 133, 134, 136, 146, 154, 156, 160,
+    163, 164, 169, 170, 173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233,   1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150, 151, 152, 155, 157,
+    158, 165, 166, 168, 174, 175, 180, 182, 183, 188, 191, 197, 231, 239,   9, 142,
+    144, 145, 148, 159, 171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243, 255, 203, 204, 211,
+    212, 214, 221, 222, 223, 241, 244, 245, 246, 247, 248, 250, 251, 252, 253, 254,
+      2,   3,   4,   5,   6,   7,   8,  11,  12,  14,  15,  16,  17,  18,  19,  20,
+     21,  23,  24,  25,  26,  27,  28,  29,  30,  31, 127, 220, 249,  10,  13,  22,
+    256,
+};
+constexpr uint16_t kHuffCount[31] = {
+     0,  0,  0,  0,  0, 10, 26, 32,  6,  0,  5,  3,  2,  6,  2,  3,
+     0,  0,  0,  3,  8, 13, 26, 29, 12,  4, 15, 19, 29,  0,  4,
+};
+
+struct HuffDecodeTables {
+    uint32_t first[31];  // 该长度的第一个码字
+    uint16_t offset[31]; // 该长度的第一个符号在 kHuffSymbols 里的位置
+};
+
+constexpr HuffDecodeTables make_decode_tables() {
+    HuffDecodeTables t{};
+    uint32_t code = 0;
+    uint16_t off  = 0;
+    for (int len = 1; len <= 30; ++len) {
+        t.first[len]  = code;
+        t.offset[len] = off;
+        code = (code + kHuffCount[len]) << 1;
+        off  = static_cast<uint16_t>(off + kHuffCount[len]);
+    }
+    return t;
+}
+constexpr HuffDecodeTables kHuffDecode = make_decode_tables();
+
+constexpr uint16_t kEos = 256;
+
+struct StaticEntry {
+    std::string_view name;
+    std::string_view value;
+};
+
+// RFC 7541 Appendix A，下标 0 对应索引 1
+constexpr std::array<StaticEntry, 61> kStaticTable{{
+    {":authority", ""}, {":method", "GET"}, {":method", "POST"}, {":path", "/"}, {":path", "/index.html"},
+    {":scheme", "http"}, {":scheme", "https"}, {":status", "200"}, {":status", "204"}, {":status", "206"},
+    {":status", "304"}, {":status", "400"}, {":status", "404"}, {":status", "500"}, {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"}, {"accept-language", ""}, {"accept-ranges", ""}, {"accept", ""},
+    {"access-control-allow-origin", ""}, {"age", ""}, {"allow", ""}, {"authorization", ""},
+    {"cache-control", ""}, {"content-disposition", ""}, {"content-encoding", ""}, {"content-language", ""},
+    {"content-length", ""}, {"content-location", ""}, {"content-range", ""}, {"content-type", ""},
+    {"cookie", ""}, {"date", ""}, {"etag", ""}, {"expect", ""}, {"expires", ""}, {"from", ""}, {"host", ""},
+    {"if-match", ""}, {"if-modified-since", ""}, {"if-none-match", ""}, {"if-range", ""},
+    {"if-unmodified-since", ""}, {"last-modified", ""}, {"link", ""}, {"location", ""}, {"max-forwards", ""},
+    {"proxy-authenticate", ""}, {"proxy-authorization", ""}, {"range", ""}, {"referer", ""}, {"refresh", ""},
+    {"retry-after", ""}, {"server", ""}, {"set-cookie", ""}, {"strict-transport-security", ""},
+    {"transfer-encoding", ""}, {"user-agent", ""}, {"vary", ""}, {"via", ""}, {"www-authenticate", ""},
+}};
+constexpr size_t kStaticCount = kStaticTable.size();
+
+// 5.1：prefix 位的整数，first 是首字节里前缀以外的标志位
+void encode_int(uint64_t v, unsigned prefix, uint8_t first, std::string& out) {
+    const uint64_t max = (1u << prefix) - 1;
+    if (v < max) {
+        out += static_cast<char>(first | v);
+        return;
+    }
+    out += static_cast<char>(first | max);
+    v -= max;
+    while (v >= 128) {
+        out += static_cast<char>(0x80 | (v & 0x7F));
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+bool decode_int(std::string_view in, size_t& pos, unsigned prefix, uint64_t& v) {
+    if (pos >= in.size()) return false;
+    const uint64_t max = (1u << prefix) - 1;
+    v = static_cast<uint8_t>(in[pos++]) & max;
+    if (v < max) return true;
+    for (unsigned shift = 0; pos < in.size(); shift += 7) {
+        if (shift > 28) return false; // 超过 2^32：不会是合法的长度或索引
+        const auto b = static_cast<uint8_t>(in[pos++]);
+        v += static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// 5.2：比原文短时用 Huffman
+void encode_string(std::string_view s, std::string& out) {
+    const size_t h = huffman_size(s);
+    if (h < s.size()) {
+        encode_int(h, 7, 0x80, out);
+        huffman_encode(s, out);
+    } else {
+        encode_int(s.size(), 7, 0x00, out);
+        out.append(s.data(), s.size());
+    }
+}
+
+bool decode_string(std::string_view in, size_t& pos, std::string& out) {
+    if (pos >= in.size()) return false;
+    const bool huff = static_cast<uint8_t>(in[pos]) & 0x80;
+    uint64_t   len;
+    if (!decode_int(in, pos, 7, len) || len > in.size() - pos) return false;
+    const std::string_view s = in.substr(pos, static_cast<size_t>(len));
+    pos += static_cast<size_t>(len);
+    if (huff) return huffman_decode(s, out);
+    out.append(s.data(), s.size());
+    return true;
+}
+
+// 每个响应都不一样的值：不进动态表，免得把能复用的条目挤出去
+bool never_reused(std::string_view name) {
+    return name == "content-length" || name == "date" || name == "etag" || name == "last-modified" ||
+           name == "set-cookie" || name == "content-range" || name == "location" || name == "expires" ||
+           name == "age";
+}
+
+} // namespace
+
+// —— Huffman ——
+
+size_t huffman_size(std::string_view s) noexcept {
+    uint64_t bits = 0;
+    for (const char ch : s) bits += kHuffLen[static_cast<uint8_t>(ch)];
+    return static_cast<size_t>((bits + 7) / 8);
+}
+
+void huffman_encode(std::string_view s, std::string& out) {
+    uint64_t acc  = 0; // 最多 7 位剩余 + 30 位码字，放得下
+    unsigned bits = 0;
+    for (const char ch : s) {
+        const auto sym = static_cast<uint8_t>(ch);
+        acc   = (acc << kHuffLen[sym]) | kHuffCode[sym];
+        bits += kHuffLen[sym];
+        while (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>(acc >> bits);
+        }
+    }
+    if (bits > 0) out += static_cast<char>((acc << (8 - bits)) | (0xFF >> bits)); // 用 EOS 的前缀（全 1）补齐
+}
+
+bool huffman_decode(std::string_view s, std::string& out) {
+    uint64_t acc  = 0;
+    unsigned bits = 0;
+    for (const char ch : s) {
+        acc   = (acc << 8) | static_cast<uint8_t>(ch);
+        bits += 8;
+        // 规范码：从最短的长度试起，码字落在该长度的区间里就是它
+        while (bits >= 5) {
+            bool found = false;
+            for (unsigned len = 5; len <= 30 && len <= bits; ++len) {
+                const uint32_t code = static_cast<uint32_t>(acc >> (bits - len)) & ((1u << len) - 1);
+                const uint32_t rel  = code - kHuffDecode.first[len];
+                if (code < kHuffDecode.first[len] || rel >= kHuffCount[len]) continue;
+                const uint16_t sym = kHuffSymbols[kHuffDecode.offset[len] + rel];
+                if (sym == kEos) return false;
+                out += static_cast<char>(sym);
+                bits -= len;
+                found = true;
+                break;
+            }
+            if (!found) {
+                if (bits >= 30) return false;
+                break; // 码字还没到齐
+            }
+        }
+        acc &= (uint64_t{1} << bits) - 1;
+    }
+    // 结尾的填充：不超过 7 位，且全为 1
+    return bits < 8 && (acc & ((1u << bits) - 1)) == (1u << bits) - 1;
+}
+
+// —— 动态表 ——
+
+void HpackTable::insert(std::string_view name, std::string_view value) {
+    const size_t need = name.size() + value.size() + 32;
+    if (need > max_) { // 放不下：清空表（4.4）
+        evict(0);
+        return;
+    }
+    evict(max_ - need);
+    entries_.push_front(Entry{std::string(name), std::string(value)});
+    size_ += need;
+}
+
+void HpackTable::resize(size_t max_size) {
+    max_ = max_size;
+    evict(max_size);
+}
+
+void HpackTable::evict(size_t max_size) {
+    while (size_ > max_size && !entries_.empty()) {
+        const Entry& e = entries_.back();
+        size_ -= e.name.size() + e.value.size() + 32;
+        entries_.pop_back();
+    }
+}
+
+// —— 解码 ——
+
+bool HpackDecoder::lookup(size_t index, std::string_view& name, std::string_view& value) const noexcept {
+    if (index == 0) return false;
+    if (index <= kStaticCount) {
+        name  = kStaticTable[index - 1].name;
+        value = kStaticTable[index - 1].value;
+        return true;
+    }
+    index -= kStaticCount + 1;
+    if (index >= table_.count()) return false;
+    name  = table_.name(index);
+    value = table_.value(index);
+    return true;
+}
+
+bool HpackDecoder::decode(std::string_view block, std::string& buf, std::vector<HpackField>& fields,
+                          size_t max_bytes) {
+    size_t pos = 0;
+    bool   first = true; // 表大小更新只能出现在块开头
+    while (pos < block.size()) {
+        const auto b = static_cast<uint8_t>(block[pos]);
+        uint64_t   index;
+        if ((b & 0xE0) == 0x20) { // 001xxxxx：动态表大小更新
+            if (!first || !decode_int(block, pos, 5, index) || index > limit_) return false;
+            table_.resize(static_cast<size_t>(index));
+            continue;
+        }
+        first = false;
+
+        HpackField f{};
+        f.name_off = static_cast<uint32_t>(buf.size());
+        if (b & 0x80) { // 1xxxxxxx：索引
+            std::string_view name, value;
+            if (!decode_int(block, pos, 7, index) || !lookup(static_cast<size_t>(index), name, value)) return false;
+            buf.append(name.data(), name.size());
+            f.name_len  = static_cast<uint32_t>(name.size());
+            f.value_off = static_cast<uint32_t>(buf.size());
+            buf.append(value.data(), value.size());
+            f.value_len = static_cast<uint32_t>(value.size());
+        } else {
+            // 01xxxxxx：带增量索引；0000xxxx / 0001xxxx：不索引 / 永不索引
+            const bool     indexing = (b & 0xC0) == 0x40;
+            const unsigned prefix   = indexing ? 6 : 4;
+            if (!decode_int(block, pos, prefix, index)) return false;
+            if (index == 0) {
+                if (!decode_string(block, pos, buf)) return false;
+            } else {
+                std::string_view name, value;
+                if (!lookup(static_cast<size_t>(index), name, value)) return false;
+                buf.append(name.data(), name.size());
+            }
+            f.name_len  = static_cast<uint32_t>(buf.size() - f.name_off);
+            f.value_off = static_cast<uint32_t>(buf.size());
+            if (!decode_string(block, pos, buf)) return false;
+            f.value_len = static_cast<uint32_t>(buf.size() - f.value_off);
+            if (indexing) table_.insert(f.name(buf), f.value(buf));
+        }
+        if (buf.size() > max_bytes) return false;
+        fields.push_back(f);
+    }
+    return true;
+}
+
+// —— 编码 ——
+
+void HpackEncoder::set_max_table_size(size_t n) {
+    n            = std::min(n, HpackDecoder::kDefaultTableSize);
+    min_pending_ = std::min(min_pending_, n);
+    next_size_   = n;
+}
+
+void HpackEncoder::begin(std::string& out) {
+    if (min_pending_ == SIZE_MAX) return;
+    // 期间先缩后放：最小的那次和最终大小都要告诉对端（4.2）
+    if (min_pending_ < table_.max_size()) {
+        table_.resize(min_pending_);
+        encode_int(min_pending_, 5, 0x20, out);
+    }
+    if (next_size_ != table_.max_size()) {
+        table_.resize(next_size_);
+        encode_int(next_size_, 5, 0x20, out);
+    }
+    min_pending_ = SIZE_MAX;
+}
+
+void HpackEncoder::status(int code, std::string& out) {
+    switch (code) {
+        case 200: out += static_cast<char>(0x80 | 8); return;
+        case 204: out += static_cast<char>(0x80 | 9); return;
+        case 206: out += static_cast<char>(0x80 | 10); return;
+        case 304: out += static_cast<char>(0x80 | 11); return;
+        case 400: out += static_cast<char>(0x80 | 12); return;
+        case 404: out += static_cast<char>(0x80 | 13); return;
+        case 500: out += static_cast<char>(0x80 | 14); return;
+        default: break;
+    }
+    char digits[3] = {static_cast<char>('0' + code / 100 % 10), static_cast<char>('0' + code / 10 % 10),
+                      static_cast<char>('0' + code % 10)};
+    field(":status", std::string_view(digits, 3), out);
+}
+
+void HpackEncoder::field(std::string_view name, std::string_view value, std::string& out) {
+    size_t name_index = 0;
+    for (size_t i = 0; i < kStaticCount; ++i) {
+        if (kStaticTable[i].name != name) continue;
+        if (kStaticTable[i].value == value) {
+            encode_int(i + 1, 7, 0x80, out);
+            return;
+        }
+        if (!name_index) name_index = i + 1;
+    }
+    const bool reused = !never_reused(name);
+    if (reused) {
+        for (size_t i = 0; i < table_.count(); ++i) {
+            if (table_.name(i) != name) continue;
+            if (table_.value(i) == value) {
+                encode_int(kStaticCount + 1 + i, 7, 0x80, out);
+                return;
+            }
+            if (!name_index) name_index = kStaticCount + 1 + i;
+        }
+    }
+    const bool indexing = reused && name.size() + value.size() + 32 <= table_.max_size();
+    if (indexing) encode_int(name_index, 6, 0x40, out);
+    else          encode_int(name_index, 4, 0x00, out);
+    if (!name_index) encode_string(name, out);
+    encode_string(value, out);
+    if (indexing) table_.insert(name, value);
+}
+
+} // namespace http
@@ -1,20 +1,45 @@
 #include "http/HttpParser.h"
+#include "http/HttpScan.h"
 #include "http/HttpResponse.h"
-#include "http/Router.h"
-#include <algorithm>
 #include <cctype>
-#include <sstream>
+#include <charconv>
+#include <cstdint>
 
 namespace http {
 
-static inline std::string trim(const std::string& s) {
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t';
+}
+
+static inline std::string_view trim(std::string_view s) {
     size_t b = 0, e = s.size();
-    while (b < e && std::isspace(static_cast<unsigned char>(s[b]))) ++b;
-    while (e > b && std::isspace(static_cast<unsigned char>(s[e-1]))) --e;
+    while (b < e && is_space(s[b])) ++b;
+    while (e > b && is_space(s[e-1])) --e;
     return s.substr(b, e - b);
 }
 
-Method parse_method(const std::string& s) {
+bool iequals(std::string_view a, std::string_view b) noexcept {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x + ('a' - 'A'));
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y + ('a' - 'A'));
+        if (x != y) return false;
+    }
+    return true;
+}
+
+bool has_token(std::string_view list, std::string_view token) noexcept {
+    while (!list.empty()) {
+        const size_t comma = list.find(',');
+        if (iequals(trim(list.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+Method parse_method(std::string_view s) {
     if (s == "GET") return Method::GET;
     if (s == "POST") return Method::POST;
     if (s == "PUT") return Method::PUT;
@@ -26,68 +51,151 @@ Method parse_method(const std::string& s) {
 }
 
 bool HttpRequest::keep_alive() const {
-    auto it = headers.find("Connection");
-    if (it != headers.end()) {
-        std::string v = it->second; std::transform(v.begin(), v.end(), v.begin(), ::tolower);
-        if (v == "close") return false;
-        if (v == "keep-alive") return true;
+    if (const std::string_view* v = headers.find("Connection")) {
+        if (iequals(*v, "close")) return false;
+        if (iequals(*v, "keep-alive")) return true;
     }
     // HTTP/1.1 default keep-alive
     return version == "HTTP/1.1";
 }
 
+void HttpRequest::clear() noexcept {
+    method  = Method::UNKNOWN;
+    uri = path = query = body = {};
+    version = "HTTP/1.1";
+    body_file = BodyFile{};
+    headers.clear();
+    params.clear();
+}
+
+void HttpRequest::rebase(const char* from, size_t len, const char* to) noexcept {
+    auto move = [&](std::string_view& v) {
+        if (v.data() >= from && v.data() + v.size() <= from + len && !v.empty())
+            v = std::string_view(to + (v.data() - from), v.size());
+    };
+    for (std::string_view* v : {&uri, &path, &query, &version, &body}) move(*v);
+    for (Header& h : headers) {
+        move(h.name);
+        move(h.value);
+    }
+    for (Param& p : params) move(p.value);
+}
+
 HttpParser::HttpParser() = default;
 
-bool HttpParser::parse_request_line(const std::string& line) {
-    std::istringstream iss(line);
-    std::string method, uri, version;
-    if (!(iss >> method >> uri >> version)) return false;
-    req_.method = parse_method(method);
-    req_.uri = uri;
+bool HttpParser::parse_request_line(std::string_view line) {
+    // METHOD SP request-target SP HTTP-version
+    const size_t sp1 = scan_token(line.data(), line.size());
+    if (sp1 == 0 || sp1 == line.size() || line[sp1] != ' ') return false;
+    const size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos || sp2 == sp1 + 1) return false;
+    const std::string_view version = trim(line.substr(sp2 + 1));
+    if (version.empty()) return false;
+
+    req_.method  = parse_method(line.substr(0, sp1));
+    req_.uri     = line.substr(sp1 + 1, sp2 - sp1 - 1);
     req_.version = version;
     // split path and query
-    auto pos = uri.find('?');
-    if (pos == std::string::npos) req_.path = uri; else { req_.path = uri.substr(0, pos); req_.query = uri.substr(pos+1); }
+    auto pos = req_.uri.find('?');
+    if (pos == std::string_view::npos) req_.path = req_.uri;
+    else { req_.path = req_.uri.substr(0, pos); req_.query = req_.uri.substr(pos+1); }
     return true;
 }
 
-bool HttpParser::parse_header_line(const std::string& line) {
-    auto pos = line.find(':');
-    if (pos == std::string::npos) return false;
-    auto key = trim(line.substr(0, pos));
-    auto val = trim(line.substr(pos+1));
-    req_.headers[key] = val;
-    return true;
+bool HttpParser::parse_header_line(std::string_view line) {
+    // field-name is a token immediately followed by ':' (no whitespace allowed before it);
+    // the value's characters were already validated while looking for the line end
+    const size_t pos = scan_token(line.data(), line.size());
+    if (pos == 0 || pos == line.size() || line[pos] != ':') return false;
+    return req_.headers.add(line.substr(0, pos), trim(line.substr(pos+1)));
+}
+
+// The caller's buffer may have been reallocated since the last call (it grows as
+// data arrives); move the views collected so far onto the new storage.
+void HttpParser::rebase(const char* from, const char* to) {
+    auto fix = [&](std::string_view& v) {
+        if (v.data() == nullptr) return;
+        const auto off = reinterpret_cast<uintptr_t>(v.data()) - reinterpret_cast<uintptr_t>(from);
+        v = std::string_view(to + off, v.size());
+    };
+    if (state_ == State::REQUEST_LINE) return;
+    fix(req_.uri); fix(req_.path); fix(req_.query); fix(req_.version);
+    for (Header& h : req_.headers) { fix(h.name); fix(h.value); }
 }
 
-bool HttpParser::parse(const std::string& data) {
-    // naive parsing: expect CRLF line endings
-    size_t i = consumed_;
-    auto read_line = [&](std::string& out)->bool{
-        size_t j = data.find("\r\n", i);
-        if (j == std::string::npos) return false;
-        out = data.substr(i, j - i);
-        i = j + 2;
-        return true;
+HttpParser::Status HttpParser::feed(std::string_view data) {
+    if (base_ != nullptr && base_ != data.data()) rebase(base_, data.data());
+    base_ = data.data();
+    if (state_ == State::COMPLETE) return Status::Complete;
+    if (state_ == State::ERROR) return Status::Error;
+
+    // CRLF line endings; the vectorized scan stops at the first CR/LF/control byte,
+    // so anything other than a CRLF there is a malformed line.
+    // Scanning resumes at scan_ (not at the line start), so every byte is looked at once
+    // no matter how many pieces the line arrives in.
+    enum { kLine, kMore, kBad };
+    auto read_line = [&](std::string_view& out)->int{
+        const size_t j = scan_ + scan_line_end(data.data() + scan_, data.size() - scan_);
+        if (j == data.size()) { scan_ = j; return kMore; }
+        if (data[j] != '\r') return kBad;
+        if (j + 1 == data.size()) { scan_ = j; return kMore; } // re-check the lone CR next time
+        if (data[j+1] != '\n') return kBad;
+        out = data.substr(consumed_, j - consumed_);
+        consumed_ = scan_ = j + 2;
+        return kLine;
     };
 
     if (state_ == State::REQUEST_LINE) {
-        std::string line;
-        if (!read_line(line)) return false;
-        if (!parse_request_line(line)) { state_ = State::ERROR; return false; }
+        std::string_view line;
+        const int r = read_line(line);
+        if (r == kMore) return Status::NeedMore;
+        if (r == kBad || !parse_request_line(line)) { state_ = State::ERROR; return Status::Error; }
         state_ = State::HEADERS;
     }
 
     if (state_ == State::HEADERS) {
-        std::string line;
+        std::string_view line;
         while (true) {
-            if (!read_line(line)) { consumed_ = i; return false; }
+            const int r = read_line(line);
+            if (r == kMore) return Status::NeedMore;
+            if (r == kBad) { state_ = State::ERROR; return Status::Error; }
             if (line.empty()) break; // end headers
-            if (!parse_header_line(line)) { state_ = State::ERROR; return false; }
+            if (!parse_header_line(line)) {
+                if (req_.headers.size() == HeaderList::kMaxHeaders) error_status_ = 431;
+                state_ = State::ERROR;
+                return Status::Error;
+            }
+        }
+        // Content-Length may repeat only with one value (RFC 9110 section 8.6): taking the
+        // first of two different lengths while a proxy takes the last splits the stream
+        // somewhere else than the proxy does
+        bool has_length = false;
+        size_t codings = 0;
+        for (const Header& h : req_.headers) {
+            if (iequals(h.name, "Transfer-Encoding")) ++codings;
+            if (!iequals(h.name, "Content-Length")) continue;
+            size_t n = 0;
+            const auto [p, ec] = std::from_chars(h.value.data(), h.value.data() + h.value.size(), n);
+            if (ec != std::errc{} || p != h.value.data() + h.value.size() || (has_length && n != expected_body_len_)) {
+                state_ = State::ERROR;
+                return Status::Error;
+            }
+            expected_body_len_ = n;
+            has_length = true;
         }
-        // body?
-        if (auto it = req_.headers.find("Content-Length"); it != req_.headers.end()) {
-            expected_body_len_ = static_cast<size_t>(std::stoul(it->second));
+        // body? Transfer-Encoding wins over Content-Length (RFC 9112 section 6.3), but a
+        // request carrying both is a smuggling attempt and is rejected, as is any coding
+        // other than chunked. A second Transfer-Encoding field extends the coding list, so
+        // it is rejected too rather than judged by its first field only
+        if (const std::string_view* te = req_.headers.find("Transfer-Encoding")) {
+            if (codings > 1 || !iequals(trim(*te), "chunked") || has_length) {
+                state_ = State::ERROR;
+                return Status::Error;
+            }
+            expected_body_len_ = 0;
+            decoder_.reset_chunked();
+            state_ = State::BODY;
+        } else if (has_length) {
             state_ = expected_body_len_ > 0 ? State::BODY : State::COMPLETE;
         } else {
             expected_body_len_ = 0;
@@ -95,104 +203,148 @@ bool HttpParser::parse(const std::string& data) {
         }
     }
 
+    if (state_ == State::BODY && decoder_.chunked()) {
+        std::string_view rest = data.substr(consumed_ + body_raw_), piece;
+        while (!rest.empty() && !decoder_.done()) {
+            const size_t n = decoder_.next(rest, piece);
+            if (decoder_.error()) { state_ = State::ERROR; return Status::Error; }
+            if (n == 0) break;
+            chunked_body_.append(piece.data(), piece.size());
+            body_raw_ += n;
+            rest.remove_prefix(n);
+        }
+        if (!decoder_.done()) return Status::NeedMore;
+        req_.body = chunked_body_;
+        consumed_ += body_raw_;
+        state_ = State::COMPLETE;
+    }
+
     if (state_ == State::BODY) {
-        size_t remain = data.size() - i;
-        if (remain < expected_body_len_) { consumed_ = i; return false; }
-        req_.body = data.substr(i, expected_body_len_);
-        i += expected_body_len_;
+        // only the received length matters; the body bytes themselves are never scanned
+        if (data.size() - consumed_ < expected_body_len_) return Status::NeedMore;
+        req_.body = data.substr(consumed_, expected_body_len_);
+        consumed_ += expected_body_len_;
         state_ = State::COMPLETE;
     }
 
-    consumed_ = i;
-    return state_ == State::COMPLETE;
+    return Status::Complete;
+}
+
+void HttpParser::finish_body(std::string_view body) {
+    req_.body = body;
+    state_ = State::COMPLETE;
 }
 
 void HttpParser::reset() {
     state_ = State::REQUEST_LINE;
-    req_ = HttpRequest{};
+    error_status_ = 400;
+    req_.clear();
     expected_body_len_ = 0;
+    decoder_.reset_length(0);
+    body_raw_ = 0;
+    // a pooled connection keeps a modest decode buffer, not the largest body it ever saw
+    if (chunked_body_.capacity() > 64 * 1024) std::string().swap(chunked_body_);
+    else                                      chunked_body_.clear();
     consumed_ = 0;
+    scan_ = 0;
+    base_ = nullptr;
+}
+
+void StreamSignal::wake() {
+    if (pending_.exchange(true, std::memory_order_acq_rel)) return; // already on its way
+    std::lock_guard<std::mutex> lock(mu_);
+    if (sink_) sink_(target_, conn_, stream_);
+}
+
+void StreamSignal::bind(Sink sink, void* target, uint64_t conn, uint32_t stream) noexcept {
+    std::lock_guard<std::mutex> lock(mu_);
+    sink_   = sink;
+    target_ = target;
+    conn_   = conn;
+    stream_ = stream;
+}
+
+void StreamSignal::unbind() noexcept {
+    std::lock_guard<std::mutex> lock(mu_);
+    sink_   = nullptr;
+    target_ = nullptr;
 }
 
 void HttpResponse::set_keep_alive(bool on) {
-    headers["Connection"] = on ? "keep-alive" : "close";
+    set_header("Connection", on ? "keep-alive" : "close");
 }
 
-static std::string status_reason(int status) {
+static std::string_view status_reason(int status) {
     switch (status) {
         case 200: return "OK";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
         case 400: return "Bad Request";
         case 404: return "Not Found";
         case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
         case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
         default: return "";
     }
 }
 
-std::string HttpResponse::to_string() const {
+static void append_uint(std::string& out, uint64_t v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, static_cast<size_t>(r.ptr - buf));
+}
+
+std::string HttpResponse::head() const {
     std::string out;
-    std::string r = reason.empty() ? status_reason(status) : reason;
-    out += "HTTP/1.1 " + std::to_string(status) + " " + r + "\r\n";
+    write_head(out);
+    return out;
+}
+
+void HttpResponse::write_head(std::string& out) const {
+    out += "HTTP/1.1 ";
+    append_uint(out, static_cast<uint64_t>(status));
+    out += ' ';
+    out += reason.empty() ? status_reason(status) : std::string_view(reason);
+    out += "\r\n";
     // ensure Content-Length
     bool has_len = false;
     for (auto const& kv : headers) {
         if (kv.first == "Content-Length") has_len = true;
     }
-    if (!has_len) {
-        out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+    // 1xx / 204 / 304 never carry a body or Content-Length
+    const bool bodiless = status < 200 || status == 204 || status == 304;
+    if (!has_len && !bodiless) {
+        if (!stream) {
+            out += "Content-Length: ";
+            append_uint(out, body_size());
+            out += "\r\n";
+        } else if (stream_length >= 0) {
+            out += "Content-Length: ";
+            append_uint(out, static_cast<uint64_t>(stream_length));
+            out += "\r\n";
+        } else if (stream_length == kChunked) {
+            out += "Transfer-Encoding: chunked\r\n";
+        }
     }
     for (auto const& kv : headers) {
-        out += kv.first + ": " + kv.second + "\r\n";
+        out += kv.first;
+        out += ": ";
+        out += kv.second;
+        out += "\r\n";
     }
+    if (raw_headers) out += *raw_headers;
     out += "\r\n";
-    out += body;
-    return out;
 }
 
-bool Router::route(const HttpRequest& req, HttpResponse& resp) const {
-    auto it = routes_.find(RouteKey{req.method, req.path});
-    if (it != routes_.end()) { it->second(req, resp); return true; } // 拿到这处理函数it->second并调用
-    // static files
-    if (!static_prefix_.empty() && !static_root_.empty()) {
-        if (req.path.rfind(static_prefix_, 0) == 0) {
-            std::string rel = req.path.substr(static_prefix_.size());
-            if (!rel.empty() && rel[0] == '/') rel.erase(0,1);
-            std::string full = static_root_ + "/" + rel;
-            // very basic path guard
-            if (full.find("..") != std::string::npos) {
-                resp.status = 400; resp.reason = "Bad Request"; resp.body = "Bad path"; return true;
-            }
-            // read file
-            FILE* f = fopen(full.c_str(), "rb");
-            if (!f) { resp.status = 404; resp.reason = "Not Found"; resp.body = "Not Found"; return true; }
-            std::string data;
-            char buf[8192]; size_t n;
-            while ((n = fread(buf,1,sizeof(buf),f))>0) data.append(buf, buf+n);
-            fclose(f);
-            resp.status = 200; resp.reason = "OK"; resp.body = std::move(data);
-            // naive content-type by extension
-            auto lower = [](std::string s){ for (auto& ch : s) ch = (char)std::tolower((unsigned char)ch); return s; };
-            std::string ext = lower(full);
-
-            if      (ext.rfind(".html") != std::string::npos) resp.set_content_type("text/html; charset=utf-8");
-            else if (ext.rfind(".json") != std::string::npos) resp.set_content_type("application/json");
-            else if (ext.rfind(".css")  != std::string::npos) resp.set_content_type("text/css");
-            else if (ext.rfind(".js")   != std::string::npos) resp.set_content_type("application/javascript");
-            else if (ext.rfind(".pdf")  != std::string::npos) {
-                resp.set_content_type("application/pdf");
-                resp.set_header("Content-Disposition", "inline"); // 确保内联预览而非下载
-            }
-            //（常见图片/字体）
-            else if (ext.rfind(".png")  != std::string::npos) resp.set_content_type("image/png");
-            else if (ext.rfind(".jpg")  != std::string::npos || ext.rfind(".jpeg") != std::string::npos) resp.set_content_type("image/jpeg");
-            else if (ext.rfind(".svg")  != std::string::npos) resp.set_content_type("image/svg+xml");
-            else if (ext.rfind(".woff2")!= std::string::npos) resp.set_content_type("font/woff2");
-            else resp.set_content_type("application/octet-stream");
-
-            return true;
-        }
-    }
-    return false;
+std::string HttpResponse::to_string() const {
+    std::string out = head();
+    if (stream)           return out;
+    if (shared_body) out += *shared_body;
+    else             out += body;
+    return out;
 }
 
 } // namespace http
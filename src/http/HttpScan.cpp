@@ -0,0 +1,202 @@
+#include "http/HttpScan.h"
+
+#include <array>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HTTP_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace http {
+
+namespace {
+
+constexpr bool is_tchar(unsigned c) {
+    if (c >= '0' && c <= '9') return true;
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') return true;
+    switch (c) {
+        case '!': case '#': case '$': case '%': case '&': case '\'': case '*': case '+':
+        case '-': case '.': case '^': case '_': case '`': case '|': case '~':
+            return true;
+        default:
+            return false;
+    }
+}
+
+constexpr bool is_line_stop(unsigned c) {
+    return (c < 0x20 && c != '\t') || c == 0x7F;
+}
+
+constexpr std::array<bool, 256> make_table(bool (*pred)(unsigned)) {
+    std::array<bool, 256> t{};
+    for (unsigned c = 0; c < 256; ++c) t[c] = pred(c);
+    return t;
+}
+
+constexpr auto kTchar    = make_table(is_tchar);
+constexpr auto kLineStop = make_table(is_line_stop);
+
+size_t line_end_scalar(const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (kLineStop[static_cast<unsigned char>(p[i])]) return i;
+    return n;
+}
+
+size_t token_scalar(const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        if (!kTchar[static_cast<unsigned char>(p[i])]) return i;
+    return n;
+}
+
+#ifdef HTTP_SCAN_X86
+
+// Nibble lookup for the tchar class: byte c is a tchar iff
+// kTokLo[c & 0xF] & kTokHi[c >> 4] != 0 (all tchars are < 0x80, so 8 bits suffice).
+struct NibbleLut {
+    alignas(16) uint8_t lo[16]{};
+    alignas(16) uint8_t hi[16]{};
+};
+
+constexpr NibbleLut make_token_lut() {
+    NibbleLut l{};
+    for (unsigned h = 0; h < 8; ++h) {
+        l.hi[h] = static_cast<uint8_t>(1u << h);
+        for (unsigned lo = 0; lo < 16; ++lo)
+            if (is_tchar(h * 16 + lo)) l.lo[lo] = static_cast<uint8_t>(l.lo[lo] | (1u << h));
+    }
+    return l;
+}
+
+constexpr NibbleLut kTokenLut = make_token_lut();
+
+// SSE4.2: PCMPESTRI with byte ranges [00-08] [0A-1F] [7F-7F].
+__attribute__((target("sse4.2")))
+size_t line_end_sse42(const char* p, size_t n) {
+    alignas(16) static const char kRanges[16] = {0x00, 0x08, 0x0A, 0x1F, 0x7F, 0x7F};
+    const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(kRanges));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const int idx = _mm_cmpestri(ranges, 6, v, 16,
+                                     _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+        if (idx != 16) return i + static_cast<size_t>(idx);
+    }
+    return i + line_end_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.2")))
+size_t token_sse42(const char* p, size_t n) {
+    const __m128i lut_lo = _mm_load_si128(reinterpret_cast<const __m128i*>(kTokenLut.lo));
+    const __m128i lut_hi = _mm_load_si128(reinterpret_cast<const __m128i*>(kTokenLut.hi));
+    const __m128i nib    = _mm_set1_epi8(0x0F);
+    const __m128i zero   = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(v, nib));
+        const __m128i hi = _mm_shuffle_epi8(lut_hi, _mm_and_si128(_mm_srli_epi16(v, 4), nib));
+        const int mask   = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), zero));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+    }
+    return i + token_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t line_end_avx2(const char* p, size_t n) {
+    const __m256i c1f = _mm256_set1_epi8(0x1F);
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i del = _mm256_set1_epi8(0x7F);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i ctl  = _mm256_cmpeq_epi8(_mm256_max_epu8(v, c1f), c1f); // v <= 0x1F
+        const __m256i stop = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl),
+                                             _mm256_cmpeq_epi8(v, del));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(stop));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return i + line_end_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2")))
+size_t token_avx2(const char* p, size_t n) {
+    const __m256i lut_lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kTokenLut.lo)));
+    const __m256i lut_hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(kTokenLut.hi)));
+    const __m256i nib    = _mm256_set1_epi8(0x0F);
+    const __m256i zero   = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i lo = _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(v, nib));
+        const __m256i hi = _mm256_shuffle_epi8(lut_hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nib));
+        const unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), zero)));
+        if (mask) return i + static_cast<size_t>(__builtin_ctz(mask));
+    }
+    return i + token_sse42(p + i, n - i);
+}
+
+bool cpu_has(ScanImpl impl) {
+    __builtin_cpu_init();
+    switch (impl) {
+        case ScanImpl::Scalar: return true;
+        case ScanImpl::SSE42:  return __builtin_cpu_supports("sse4.2");
+        case ScanImpl::AVX2:   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2");
+    }
+    return false;
+}
+
+#else
+
+bool cpu_has(ScanImpl impl) { return impl == ScanImpl::Scalar; }
+
+#endif // HTTP_SCAN_X86
+
+struct Dispatch {
+    ScanImpl impl;
+    size_t (*line_end)(const char*, size_t);
+    size_t (*token)(const char*, size_t);
+};
+
+Dispatch make_dispatch(ScanImpl impl) {
+    switch (impl) {
+#ifdef HTTP_SCAN_X86
+        case ScanImpl::AVX2:  return {impl, line_end_avx2, token_avx2};
+        case ScanImpl::SSE42: return {impl, line_end_sse42, token_sse42};
+#endif
+        default:              return {ScanImpl::Scalar, line_end_scalar, token_scalar};
+    }
+}
+
+Dispatch detect() {
+    if (cpu_has(ScanImpl::AVX2)) return make_dispatch(ScanImpl::AVX2);
+    if (cpu_has(ScanImpl::SSE42)) return make_dispatch(ScanImpl::SSE42);
+    return make_dispatch(ScanImpl::Scalar);
+}
+
+Dispatch g_scan = detect();
+
+} // namespace
+
+size_t scan_line_end(const char* p, size_t n) { return g_scan.line_end(p, n); }
+size_t scan_token(const char* p, size_t n) { return g_scan.token(p, n); }
+
+ScanImpl scan_impl() noexcept { return g_scan.impl; }
+
+const char* scan_impl_name(ScanImpl impl) noexcept {
+    switch (impl) {
+        case ScanImpl::Scalar: return "scalar";
+        case ScanImpl::SSE42:  return "sse4.2";
+        case ScanImpl::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+bool scan_select(ScanImpl impl) noexcept {
+    if (!cpu_has(impl)) return false;
+    g_scan = make_dispatch(impl);
+    return true;
+}
+
+} // namespace http
@@ -0,0 +1,95 @@
+#include "http/RequestArena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace http {
+
+namespace {
+
+#if defined(__SANITIZE_ADDRESS__)
+constexpr bool kKeepWarm = false; // 每次回卷都把块还给堆，ASan 才查得出越过回卷的访问
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+constexpr bool kKeepWarm = false;
+#else
+constexpr bool kKeepWarm = true;
+#endif
+#else
+constexpr bool kKeepWarm = true;
+#endif
+
+constexpr size_t kHeader = (sizeof(void*) * 2 + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+} // namespace
+
+RequestArena::~RequestArena() {
+    while (head_) {
+        Block* next = head_->next;
+        ::operator delete(head_);
+        head_ = next;
+    }
+}
+
+void RequestArena::enter(Block* b) noexcept {
+    cur_ = b;
+    ptr_ = reinterpret_cast<char*>(b) + kHeader;
+    end_ = reinterpret_cast<char*>(b) + b->size;
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t align) {
+    for (;;) {
+        if (cur_) {
+            const auto p  = reinterpret_cast<uintptr_t>(ptr_);
+            const auto at = (p + align - 1) & ~static_cast<uintptr_t>(align - 1);
+            if (at + bytes <= reinterpret_cast<uintptr_t>(end_)) {
+                ptr_ = reinterpret_cast<char*>(at + bytes);
+                used_ += bytes;
+                return reinterpret_cast<void*>(at);
+            }
+            if (cur_->next) { // 上一轮留下的热块
+                enter(cur_->next);
+                continue;
+            }
+        }
+        // 块用完了：按标准大小追加一块，超大的分配单独占一块（回卷时释放）
+        const size_t need = kHeader + bytes + (align > alignof(std::max_align_t) ? align : 0);
+        const size_t size = need > kBlockSize ? need : kBlockSize;
+        auto* b = static_cast<Block*>(::operator new(size));
+        b->next = nullptr;
+        b->size = size;
+        if (cur_) cur_->next = b;
+        else      head_ = b;
+        enter(b);
+    }
+}
+
+void RequestArena::rewind() noexcept {
+    size_t kept = 0;
+    Block** link = &head_;
+    while (Block* b = *link) {
+        if (kKeepWarm && kept < kWarmBlocks && b->size == kBlockSize) {
+            ++kept;
+            link = &b->next;
+        } else {
+            *link = b->next;
+            ::operator delete(b);
+        }
+    }
+    used_ = 0;
+    if (head_) {
+        enter(head_);
+    } else {
+        cur_ = nullptr;
+        ptr_ = end_ = nullptr;
+    }
+}
+
+size_t RequestArena::blocks() const noexcept {
+    size_t n = 0;
+    for (const Block* b = head_; b; b = b->next) ++n;
+    return n;
+}
+
+} // namespace http
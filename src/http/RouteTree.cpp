@@ -0,0 +1,149 @@
+#include "http/RouteTree.h"
+
+namespace http {
+
+namespace {
+
+// ':' 和 '*' 只能出现在段首，'*' 必须是最后一段，参数必须有名字
+bool valid_pattern(std::string_view p) {
+    if (p.empty() || p[0] != '/') return false;
+    for (size_t i = 0; i < p.size(); ++i) {
+        if (p[i] != ':' && p[i] != '*') continue;
+        if (p[i - 1] != '/') return false;
+        const size_t end = p.find('/', i);
+        if (end == i + 1 || i + 1 == p.size()) return false;
+        if (p[i] == '*' && end != std::string_view::npos) return false;
+        const std::string_view name = p.substr(i + 1, end - i - 1);
+        if (name.find_first_of(":*") != std::string_view::npos) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void RouteTree::split(Node& n, size_t at) {
+    // 节点前缀只有前 at 字节是共用的：后半段连同全部子树下移成一个子节点
+    auto tail = std::make_unique<Node>();
+    tail->prefix         = n.prefix.substr(at);
+    tail->indices        = std::move(n.indices);
+    tail->children       = std::move(n.children);
+    tail->param          = std::move(n.param);
+    tail->param_name     = std::move(n.param_name);
+    tail->catch_all_name = std::move(n.catch_all_name);
+    tail->catch_all      = std::move(n.catch_all);
+    tail->route          = std::move(n.route);
+
+    n.prefix.resize(at);
+    n.indices.assign(1, tail->prefix[0]);
+    n.children.clear();
+    n.children.push_back(std::move(tail));
+    n.param.reset();
+    n.param_name.clear();
+    n.catch_all_name.clear();
+    n.catch_all.reset();
+    n.route.reset();
+}
+
+bool RouteTree::insert(std::string_view pat, Handler h, const RouteOptions& opts, uint32_t id) {
+    if (!h) return false;
+    auto r = std::make_unique<Route>();
+    r->handler = std::move(h);
+    r->opts    = opts;
+    r->id      = id;
+    return insert_route(pat, std::move(r));
+}
+
+bool RouteTree::insert(std::string_view pat, AsyncHandler h, const RouteOptions& opts, uint32_t id) {
+    if (!h) return false;
+    auto r = std::make_unique<Route>();
+    r->async = std::move(h);
+    r->opts  = opts;
+    r->id    = id;
+    return insert_route(pat, std::move(r));
+}
+
+bool RouteTree::insert_route(std::string_view pat, std::unique_ptr<Route> r) {
+    if (!valid_pattern(pat)) return false;
+    Node* n = &root_;
+    for (;;) {
+        size_t l = 0;
+        while (l < n->prefix.size() && l < pat.size() && n->prefix[l] == pat[l]) ++l;
+        if (l < n->prefix.size()) split(*n, l);
+        pat.remove_prefix(l);
+
+        if (pat.empty()) {
+            if (!n->route) ++routes_;
+            n->route = std::move(r);
+            return true;
+        }
+        if (pat[0] == ':') {
+            const std::string_view name = pat.substr(1, pat.find('/') - 1);
+            if (!n->param) {
+                n->param      = std::make_unique<Node>();
+                n->param_name = std::string(name);
+            } else if (n->param_name != name) {
+                return false; // 同一位置的参数只能有一个名字
+            }
+            n = n->param.get();
+            pat.remove_prefix(1 + name.size());
+            continue;
+        }
+        if (pat[0] == '*') {
+            const std::string_view name = pat.substr(1);
+            if (n->catch_all && n->catch_all_name != name) return false;
+            if (!n->catch_all) ++routes_;
+            n->catch_all_name = std::string(name);
+            n->catch_all      = std::move(r);
+            return true;
+        }
+        const size_t i = n->indices.find(pat[0]);
+        if (i != std::string::npos) {
+            n = n->children[i].get();
+            continue;
+        }
+        // 没有同首字节的子节点：新建一个，前缀一直到下一个参数为止
+        auto child    = std::make_unique<Node>();
+        child->prefix = std::string(pat.substr(0, pat.find_first_of(":*")));
+        n->indices += pat[0];
+        n->children.push_back(std::move(child));
+        n = n->children.back().get();
+    }
+}
+
+const Route* RouteTree::match(const Node& n, std::string_view path, ParamList& params) {
+    if (path.compare(0, n.prefix.size(), n.prefix) != 0) return nullptr;
+    path.remove_prefix(n.prefix.size());
+
+    if (path.empty()) {
+        if (n.route) return n.route.get();
+    } else {
+        // 字面子节点优先
+        const size_t i = n.indices.find(path[0]);
+        if (i != std::string::npos) {
+            if (const Route* r = match(*n.children[i], path, params)) return r;
+        }
+        // 其次是参数：吃掉一个非空路径段
+        if (n.param) {
+            const size_t end = path.find('/');
+            const size_t len = end == std::string_view::npos ? path.size() : end;
+            const size_t mark = params.size();
+            if (len > 0 && params.add(n.param_name, path.substr(0, len))) {
+                if (const Route* r = match(*n.param, path.substr(len), params)) return r;
+                params.truncate(mark);
+            }
+        }
+    }
+    // 最后是 catch-all：剩下的整段路径（可以为空）
+    if (n.catch_all && params.add(n.catch_all_name, path)) return n.catch_all.get();
+    return nullptr;
+}
+
+const Route* RouteTree::find(std::string_view path, ParamList& params) const {
+    if (routes_ == 0) return nullptr;
+    const size_t mark = params.size();
+    const Route* r = match(root_, path, params);
+    if (!r) params.truncate(mark);
+    return r;
+}
+
+} // namespace http
@@ -0,0 +1,217 @@
+#include "http/Router.h"
+
+#include <algorithm>
+
+namespace http {
+
+namespace {
+
+// 静态文件与编译期路由表没有 Route 对象，给它们各一个只带编号的替身
+const Route kStaticPseudo{{}, {}, {}, Router::kStaticRoute};
+const Route kTablePseudo{{}, {}, {}, Router::kTableRoute};
+
+} // namespace
+
+std::string_view method_name(Method m) noexcept {
+    switch (m) {
+        case Method::GET:     return "GET";
+        case Method::POST:    return "POST";
+        case Method::PUT:     return "PUT";
+        case Method::DELETE_: return "DELETE";
+        case Method::HEAD:    return "HEAD";
+        case Method::OPTIONS: return "OPTIONS";
+        case Method::PATCH:   return "PATCH";
+        default:              return "";
+    }
+}
+
+uint32_t Router::route_id(Method m, const std::string& path) const {
+    for (size_t i = kTableRoute + 1; i < infos_.size(); ++i) // 重复注册同一路由沿用原编号
+        if (infos_[i].method == m && infos_[i].pattern == path) return static_cast<uint32_t>(i);
+    return static_cast<uint32_t>(infos_.size());
+}
+
+void Router::name_route(uint32_t id, Method m, const std::string& path) {
+    if (id == infos_.size()) infos_.push_back(RouteInfo{m, path});
+}
+
+bool Router::add(Method m, const std::string& path, Handler h, const RouteOptions& opts) {
+    const size_t i = static_cast<size_t>(m);
+    if (i >= kMethods) return false;
+    const uint32_t id = route_id(m, path);
+    if (!trees_[i].insert(path, std::move(h), opts, id)) return false;
+    name_route(id, m, path);
+    if (opts.max_body || opts.spill_threshold) body_options_ = true;
+    return true;
+}
+
+bool Router::add(Method m, const std::string& path, AsyncHandler h, const RouteOptions& opts) {
+    const size_t i = static_cast<size_t>(m);
+    if (i >= kMethods) return false;
+    const uint32_t id = route_id(m, path);
+    if (!trees_[i].insert(path, std::move(h), opts, id)) return false;
+    name_route(id, m, path);
+    coroutines_ = true;
+    if (opts.max_body || opts.spill_threshold || opts.stream_body) body_options_ = true;
+    return true;
+}
+
+void Router::set_static(const std::string& url_prefix, const std::string& dir_root) {
+    std::string prefix = url_prefix;
+    while (!prefix.empty() && prefix.back() == '/') prefix.pop_back(); // "/" 挂载在根上
+    for (StaticMount& m : mounts_) {
+        if (m.prefix == prefix) { m.root = dir_root; return; }
+    }
+    mounts_.push_back(StaticMount{std::move(prefix), dir_root});
+    std::stable_sort(mounts_.begin(), mounts_.end(), [](const StaticMount& a, const StaticMount& b) {
+        return a.prefix.size() > b.prefix.size();
+    });
+}
+
+const Router::StaticMount* Router::find_mount(std::string_view path) const {
+    for (const StaticMount& m : mounts_) {
+        // 前缀必须止于段边界："/static" 不匹配 "/staticky"
+        if (path.compare(0, m.prefix.size(), m.prefix) != 0) continue;
+        if (path.size() == m.prefix.size() || path[m.prefix.size()] == '/') return &m;
+    }
+    return nullptr;
+}
+
+void Router::method_not_allowed(std::string_view path, HttpResponse& resp) const {
+    std::string allow;
+    ParamList scratch;
+    const unsigned from_table = table_ ? table_allowed_(table_, path) : 0;
+    for (size_t i = 0; i < kMethods; ++i) {
+        scratch.clear();
+        if (!(from_table & (1u << i)) && !trees_[i].find(path, scratch)) continue;
+        if (!allow.empty()) allow += ", ";
+        allow += method_name(static_cast<Method>(i));
+    }
+    resp.status = 405;
+    resp.reason = "Method Not Allowed";
+    resp.body   = "Method Not Allowed";
+    resp.set_content_type("text/plain; charset=utf-8");
+    resp.set_header("Allow", allow);
+}
+
+bool Router::route(HttpRequest& req, HttpResponse& resp) const {
+    const Route* coro = nullptr;
+    const Dispatch d = dispatch_impl(req, resp, coro, false);
+    if (d == Dispatch::Coroutine) {
+        // 没有事件循环：只能同步跑到第一次挂起，挂起了就没有谁来恢复它
+        Task<HttpResponse> t = coro->async(req);
+        t.resume();
+        if (t.done() && !t.failed()) {
+            resp = t.result();
+            finish(req, resp);
+        } else {
+            resp        = HttpResponse{};
+            resp.status = 500;
+            resp.reason = "Internal Server Error";
+            resp.body   = "Internal Server Error";
+            resp.set_content_type("text/plain; charset=utf-8");
+        }
+    }
+    return d != Dispatch::NotFound;
+}
+
+const Route* Router::match_route(HttpRequest& req) const {
+    const size_t mi = static_cast<size_t>(req.method);
+    if (mi >= kMethods) return nullptr;
+    // 编译期路由表优先于树：表里有的路径不能在这里被树抢走
+    if (table_ && (table_allowed_(table_, req.path) & (1u << mi))) return nullptr;
+    req.params.clear();
+    const Route* r = trees_[mi].find(req.path, req.params);
+    if (!r) req.params.clear();
+    return r;
+}
+
+const Route* Router::match_coroutine(HttpRequest& req) const {
+    if (!coroutines_) return nullptr;
+    const Route* r = match_route(req);
+    if (r && r->async) return r;
+    req.params.clear();
+    return nullptr;
+}
+
+Router::Dispatch Router::dispatch(HttpRequest& req, HttpResponse& resp, const Route*& route,
+                                  bool offload) const {
+    return dispatch_impl(req, resp, route, offload);
+}
+
+void Router::run_deferred(const Route& r, const HttpRequest& req, HttpResponse& resp) const {
+    r.handler(req, resp);
+    compress_response(req, resp, compress_);
+    cancel_deferred(r);
+}
+
+Router::Dispatch Router::dispatch_impl(HttpRequest& req, HttpResponse& resp, const Route*& route,
+                                       bool offload) const {
+    route = nullptr;
+    const size_t mi = static_cast<size_t>(req.method);
+    req.params.clear();
+    if (table_ && table_dispatch_(table_, req, resp)) { // 编译期路由表优先
+        compress_response(req, resp, compress_);
+        route = &kTablePseudo;
+        return Dispatch::Done;
+    }
+    if (mi < kMethods) {
+        if (const Route* r = trees_[mi].find(req.path, req.params)) {
+            route = r;
+            if (r->async) return Dispatch::Coroutine;
+            if (offload && r->opts.blocking) {
+                // 交给工作线程池：先占一个名额，占不到说明该路由已排满，直接 503
+                if (r->inflight.fetch_add(1, std::memory_order_relaxed) >= r->opts.max_queue) {
+                    cancel_deferred(*r);
+                    resp.status = 503;
+                    resp.reason = "Service Unavailable";
+                    resp.body   = "Service Unavailable";
+                    resp.set_content_type("text/plain; charset=utf-8");
+                    resp.set_header("Retry-After", "1");
+                    return Dispatch::Done;
+                }
+                return Dispatch::Deferred;
+            }
+            r->handler(req, resp); // 拿到处理函数并调用
+            compress_response(req, resp, compress_); // 静态文件走预压缩的兄弟文件，这里只管动态响应
+            return Dispatch::Done;
+        }
+    }
+
+    // static files
+    if (const StaticMount* m = find_mount(req.path)) {
+        if (req.method != Method::GET && req.method != Method::HEAD) {
+            resp.status = 405;
+            resp.reason = "Method Not Allowed";
+            resp.body   = "Method Not Allowed";
+            resp.set_content_type("text/plain; charset=utf-8");
+            resp.set_header("Allow", "GET, HEAD");
+            return Dispatch::Done;
+        }
+        route = &kStaticPseudo;
+        std::string_view rel = req.path.substr(m->prefix.size());
+        while (!rel.empty() && rel[0] == '/') rel.remove_prefix(1);
+        // very basic path guard
+        if (rel.find("..") != std::string_view::npos) {
+            resp.status = 400; resp.reason = "Bad Request"; resp.body = "Bad path"; return Dispatch::Done;
+        }
+        std::string full;
+        full.reserve(m->root.size() + 1 + rel.size());
+        full.append(m->root).append(1, '/').append(rel);
+        serve_file(req, resp, full, static_opts_); // 内存缓存 / sendfile + Range + 304
+        return Dispatch::Done;
+    }
+
+    // 路径存在但方法不对：405 + Allow，而不是 404
+    const unsigned from_table = table_ ? table_allowed_(table_, req.path) : 0;
+    ParamList scratch;
+    for (size_t i = 0; i < kMethods; ++i) {
+        if (i != mi && ((from_table & (1u << i)) || trees_[i].find(req.path, scratch))) {
+            method_not_allowed(req.path, resp);
+            return Dispatch::Done;
+        }
+    }
+    return Dispatch::NotFound;
+}
+
+} // namespace http
@@ -0,0 +1,564 @@
+#include "http/StaticFile.h"
+#include "http/Compression.h"
+
+#include <cctype>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace http {
+
+namespace {
+
+#ifdef _WIN32
+using stat_t = struct _stat64;
+int  file_stat(const char* p, stat_t* st) { return ::_stat64(p, st); }
+int  file_fstat(int fd, stat_t* st) { return ::_fstat64(fd, st); }
+int  file_open(const char* p) { return ::_open(p, _O_RDONLY | _O_BINARY); }
+void file_close(int fd) { ::_close(fd); }
+int64_t mtime_ns(const stat_t& st) { return static_cast<int64_t>(st.st_mtime) * 1000000000; }
+#else
+using stat_t = struct stat;
+int  file_stat(const char* p, stat_t* st) { return ::stat(p, st); }
+int  file_fstat(int fd, stat_t* st) { return ::fstat(fd, st); }
+int  file_open(const char* p) { return ::open(p, O_RDONLY | O_CLOEXEC); }
+void file_close(int fd) { ::close(fd); }
+int64_t mtime_ns(const stat_t& st) {
+#ifdef __APPLE__
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+#endif
+
+bool is_regular(const stat_t& st) { return (st.st_mode & S_IFMT) == S_IFREG; }
+
+std::string to_hex(uint64_t v) {
+    char buf[16];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v, 16);
+    return std::string(buf, r.ptr);
+}
+
+// 读取整个小文件（缓存装载用）
+bool read_all(int fd, uint64_t size, std::string& out) {
+    out.resize(static_cast<size_t>(size));
+    size_t got = 0;
+    while (got < out.size()) {
+#ifdef _WIN32
+        if (::_lseeki64(fd, static_cast<__int64>(got), SEEK_SET) < 0) return false;
+        const int n = ::_read(fd, out.data() + got, static_cast<unsigned>(out.size() - got));
+#else
+        const ssize_t n = ::pread(fd, out.data() + got, out.size() - got, static_cast<off_t>(got));
+#endif
+        if (n <= 0) return false;
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// —— 变更通知 ——
+// Linux 下用一个后台线程阻塞读 inotify，被监视目录里有任何变化就把 epoch 加一。
+// 缓存项记录自己上次验证时的 epoch：相同则直接信任（命中路径没有系统调用），
+// 不同则 stat 重新验证一次。epoch 为 0 表示没有监视，每次命中都 stat。
+#ifdef __linux__
+class DirWatcher {
+public:
+    static DirWatcher* instance() {
+        static DirWatcher* w = [] {
+            auto* d = new DirWatcher; // 不析构：后台线程阻塞在 read 上，随进程退出
+            if (d->fd_ < 0) { delete d; return static_cast<DirWatcher*>(nullptr); }
+            std::thread([d] { d->run(); }).detach();
+            return d;
+        }();
+        return w;
+    }
+
+    uint64_t epoch() const noexcept { return epoch_.load(std::memory_order_acquire); }
+
+    // 必须在 stat / open 之前调用，保证之后的变化一定能被看到
+    bool watch_dir_of(const std::string& path) {
+        const size_t slash = path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+        std::lock_guard<std::mutex> lock(mu_);
+        if (dirs_.count(dir)) return true;
+        if (dirs_.size() >= kMaxDirs) return false;
+        constexpr uint32_t kMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                   IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+        if (::inotify_add_watch(fd_, dir.c_str(), kMask) < 0) return false;
+        dirs_.insert(dir);
+        return true;
+    }
+
+private:
+    static constexpr size_t kMaxDirs = 4096;
+
+    DirWatcher() : fd_(::inotify_init1(IN_CLOEXEC)) {}
+
+    void run() {
+        alignas(inotify_event) char buf[4096];
+        for (;;) {
+            const ssize_t n = ::read(fd_, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            // 不区分具体文件：任何变化都让所有缓存项重新验证一次
+            epoch_.fetch_add(1, std::memory_order_acq_rel);
+        }
+        epoch_.store(0, std::memory_order_release); // 监视失效：退回每次 stat
+    }
+
+    int                             fd_;
+    std::atomic<uint64_t>           epoch_{1};
+    std::mutex                      mu_;
+    std::unordered_set<std::string> dirs_;
+};
+
+// 返回 0 表示不能依赖通知（每次都要 stat）
+uint64_t watch(const std::string& path) {
+    DirWatcher* w = DirWatcher::instance();
+    if (!w || !w->watch_dir_of(path)) return 0;
+    return w->epoch();
+}
+uint64_t current_epoch() {
+    DirWatcher* w = DirWatcher::instance();
+    return w ? w->epoch() : 0;
+}
+#else
+uint64_t watch(const std::string&) { return 0; }
+uint64_t current_epoch() { return 0; }
+#endif
+
+// 文件身份：mtime / size / inode 任一变化即视为新版本
+struct FileId {
+    int64_t  mtime{0}; // ns
+    uint64_t size{0};
+    uint64_t ino{0};
+
+    static FileId of(const stat_t& st) {
+        return FileId{mtime_ns(st), static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(st.st_ino)};
+    }
+    bool operator==(const FileId& o) const { return mtime == o.mtime && size == o.size && ino == o.ino; }
+};
+
+// 打开的文件描述符及由它得出的校验器；最后一个引用释放时关闭
+struct OpenFile {
+    int         fd{-1};
+    FileId      id;
+    std::string etag;
+    std::string last_modified;
+
+    ~OpenFile() {
+        if (fd >= 0) file_close(fd);
+    }
+    uint64_t size() const noexcept { return id.size; }
+};
+
+// 缓存项是否仍有效：epoch 没变直接信任，否则 stat 一次并更新 epoch
+template <class Entry>
+bool still_valid(Entry& e, const std::string& path, const FileId& id) {
+    const uint64_t ep = current_epoch();
+    if (ep != 0 && e.epoch == ep) return true;
+    stat_t st{};
+    if (file_stat(path.c_str(), &st) != 0 || !is_regular(st) || !(FileId::of(st) == id)) return false;
+    e.epoch = ep;
+    return true;
+}
+
+// 每个线程一份（每个 event loop 一份），查找不加锁。
+// 响应持有 shared_ptr，被淘汰或替换的文件会保持打开直到正在进行的发送完成。
+class FdCache {
+public:
+    static constexpr size_t kMaxFiles = 256;
+
+    std::shared_ptr<const OpenFile> get(const std::string& path) {
+        auto it = files_.find(path);
+        if (it != files_.end()) {
+            if (still_valid(it->second, path, it->second.file->id))
+                return it->second.file; // 命中：省掉 open / fstat / close
+            files_.erase(it);           // 文件已变化：重新打开
+        }
+        // 不存在的文件也记下来（例如没有 .br / .gz 兄弟文件），目录没变化就不再尝试打开
+        if (auto m = missing_.find(path); m != missing_.end()) {
+            const uint64_t ep = current_epoch();
+            if (ep != 0 && m->second == ep) return nullptr;
+            missing_.erase(m);
+        }
+
+        const uint64_t ep = watch(path);
+        auto f = std::make_shared<OpenFile>();
+        f->fd = file_open(path.c_str());
+        stat_t fst{};
+        // 以打开的 fd 为准
+        if (f->fd < 0 || file_fstat(f->fd, &fst) != 0 || !is_regular(fst)) {
+            if (ep != 0) {
+                if (missing_.size() >= kMaxFiles) missing_.clear();
+                missing_.emplace(path, ep);
+            }
+            return nullptr;
+        }
+        f->id            = FileId::of(fst);
+        f->etag          = "\"" + to_hex(static_cast<uint64_t>(f->id.mtime)) + "-" + to_hex(f->id.size) + "\"";
+        f->last_modified = http_date(f->id.mtime / 1000000000);
+
+        if (files_.size() >= kMaxFiles) files_.erase(files_.begin());
+        files_.emplace(path, Entry{f, ep});
+        return f;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<const OpenFile> file;
+        uint64_t                        epoch{0};
+    };
+    std::unordered_map<std::string, Entry>    files_;
+    std::unordered_map<std::string, uint64_t> missing_; // path -> 确认不存在时的 epoch
+};
+
+// 内存中的小文件：响应体与预先序列化好的头部行
+struct Asset {
+    FileId      id;
+    std::string body;
+    std::string etag;
+    std::string headers;    // Content-Type / Content-Encoding / Vary / ETag / Last-Modified / Accept-Ranges，每行以 CRLF 结尾
+    std::string validators; // 304 用：ETag / Last-Modified / Vary
+    int64_t     mtime_sec{0};
+};
+
+// 按字节数限额的 LRU；每个线程一份
+class AssetCache {
+public:
+    std::shared_ptr<const Asset> find(const std::string& path) {
+        auto it = index_.find(path);
+        if (it == index_.end()) return nullptr;
+        Node& n = *it->second;
+        if (!still_valid(n, path, n.asset->id)) {
+            erase(it->second);
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second); // 移到最近使用
+        return n.asset;
+    }
+
+    void insert(const std::string& path, std::shared_ptr<const Asset> a, uint64_t epoch, size_t budget) {
+        if (auto it = index_.find(path); it != index_.end()) erase(it->second);
+        const size_t cost = charge(*a, path);
+        if (cost > budget) return;
+        while (bytes_ + cost > budget && !lru_.empty()) erase(std::prev(lru_.end()));
+        lru_.push_front(Node{path, std::move(a), epoch});
+        index_.emplace(lru_.front().path, lru_.begin());
+        bytes_ += cost;
+    }
+
+private:
+    struct Node {
+        std::string                  path;
+        std::shared_ptr<const Asset> asset;
+        uint64_t                     epoch{0};
+    };
+    using List = std::list<Node>;
+
+    static size_t charge(const Asset& a, const std::string& path) {
+        return a.body.size() + a.headers.size() + a.validators.size() + 2 * path.size() + 128;
+    }
+    void erase(List::iterator it) {
+        bytes_ -= charge(*it->asset, it->path);
+        index_.erase(std::string_view(it->path));
+        lru_.erase(it);
+    }
+
+    List                                               lru_;
+    std::unordered_map<std::string_view, List::iterator> index_; // 键指向 lru_ 节点里的 path
+    size_t                                             bytes_{0};
+};
+
+thread_local FdCache    t_fds;
+thread_local AssetCache t_assets;
+
+// If-Range 只接受强校验器：强 ETag 完全相等，或与 Last-Modified 完全相同的日期
+bool if_range_matches(std::string_view v, const OpenFile& f) {
+    if (v.empty()) return true;
+    if (v.front() == '"') return v == f.etag;
+    if (v.rfind("W/", 0) == 0) return false;
+    return v == f.last_modified;
+}
+
+bool parse_u64(std::string_view s, uint64_t& out) {
+    if (s.empty()) return false;
+    const auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && p == s.data() + s.size();
+}
+
+std::string_view trim_ows(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// 1970-01-01 起的天数（Howard Hinnant 的 days_from_civil）
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t  era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+void respond_asset(const HttpRequest& req, HttpResponse& resp, const std::shared_ptr<const Asset>& a) {
+    if (not_modified(req, a->etag, a->mtime_sec)) {
+        resp.status      = 304;
+        resp.reason      = "Not Modified";
+        resp.raw_headers = std::shared_ptr<const std::string>(a, &a->validators);
+        return;
+    }
+    resp.status      = 200;
+    resp.reason      = "OK";
+    resp.raw_headers = std::shared_ptr<const std::string>(a, &a->headers);
+    if (req.method == Method::HEAD) {
+        resp.set_header("Content-Length", std::to_string(a->body.size()));
+        return;
+    }
+    resp.shared_body = std::shared_ptr<const std::string>(a, &a->body); // 与缓存共享，不拷贝
+}
+
+} // namespace
+
+std::string_view mime_type(std::string_view path) {
+    const size_t dot = path.rfind('.');
+    if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos)
+        return "application/octet-stream";
+    char ext[8];
+    const std::string_view e = path.substr(dot + 1);
+    if (e.size() > sizeof(ext)) return "application/octet-stream";
+    for (size_t i = 0; i < e.size(); ++i) ext[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(e[i])));
+    const std::string_view x(ext, e.size());
+
+    if (x == "html" || x == "htm") return "text/html; charset=utf-8";
+    if (x == "json")               return "application/json";
+    if (x == "css")                return "text/css";
+    if (x == "js" || x == "mjs")   return "application/javascript";
+    if (x == "txt")                return "text/plain; charset=utf-8";
+    if (x == "pdf")                return "application/pdf";
+    //（常见图片/字体/音视频）
+    if (x == "png")                return "image/png";
+    if (x == "jpg" || x == "jpeg") return "image/jpeg";
+    if (x == "gif")                return "image/gif";
+    if (x == "webp")               return "image/webp";
+    if (x == "svg")                return "image/svg+xml";
+    if (x == "ico")                return "image/x-icon";
+    if (x == "woff2")              return "font/woff2";
+    if (x == "woff")               return "font/woff";
+    if (x == "mp4")                return "video/mp4";
+    if (x == "webm")               return "video/webm";
+    if (x == "mp3")                return "audio/mpeg";
+    return "application/octet-stream";
+}
+
+std::string http_date(int64_t unix_seconds) {
+    static const char* const kDays[]   = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    const std::time_t t = static_cast<std::time_t>(unix_seconds);
+    std::tm tm{};
+#ifdef _WIN32
+    ::gmtime_s(&tm, &t);
+#else
+    ::gmtime_r(&t, &tm);
+#endif
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT", kDays[tm.tm_wday], tm.tm_mday,
+                  kMonths[tm.tm_mon], tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return buf;
+}
+
+int64_t parse_http_date(std::string_view s) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    static constexpr std::string_view kMonths = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    if (s.size() != 29 || s[3] != ',' || s[4] != ' ' || s[7] != ' ' || s[11] != ' ' || s[16] != ' ' ||
+        s[19] != ':' || s[22] != ':' || s.substr(25) != " GMT")
+        return -1;
+    auto num = [&](size_t pos, size_t len, unsigned& out) {
+        const auto [p, ec] = std::from_chars(s.data() + pos, s.data() + pos + len, out);
+        return ec == std::errc{} && p == s.data() + pos + len;
+    };
+    unsigned day = 0, year = 0, hh = 0, mm = 0, ss = 0;
+    if (!num(5, 2, day) || !num(12, 4, year) || !num(17, 2, hh) || !num(20, 2, mm) || !num(23, 2, ss)) return -1;
+    const size_t mon = kMonths.find(s.substr(8, 3));
+    if (mon == std::string_view::npos || mon % 3 != 0) return -1;
+    if (day < 1 || day > 31 || hh > 23 || mm > 59 || ss > 60) return -1;
+    return days_from_civil(year, static_cast<unsigned>(mon / 3 + 1), day) * 86400 + hh * 3600 + mm * 60 + ss;
+}
+
+bool not_modified(const HttpRequest& req, std::string_view etag, int64_t mtime_seconds) {
+    if (req.method != Method::GET && req.method != Method::HEAD) return false;
+    if (const std::string_view* inm = req.headers.find("If-None-Match")) {
+        // 弱比较：忽略 W/ 前缀
+        auto opaque = [](std::string_view t) { return t.rfind("W/", 0) == 0 ? t.substr(2) : t; };
+        const std::string_view mine = opaque(etag);
+        std::string_view list = *inm;
+        while (!list.empty()) {
+            const size_t comma = list.find(',');
+            const std::string_view tag = trim_ows(list.substr(0, comma));
+            if (tag == "*" || opaque(tag) == mine) return true;
+            if (comma == std::string_view::npos) break;
+            list.remove_prefix(comma + 1);
+        }
+        return false; // 有 If-None-Match 时忽略 If-Modified-Since
+    }
+    if (const std::string_view* ims = req.headers.find("If-Modified-Since")) {
+        const int64_t t = parse_http_date(*ims);
+        return t >= 0 && mtime_seconds <= t;
+    }
+    return false;
+}
+
+RangeResult parse_range(std::string_view v, uint64_t size, uint64_t& first, uint64_t& last) {
+    constexpr std::string_view kUnit = "bytes=";
+    if (v.size() < kUnit.size() || !iequals(v.substr(0, kUnit.size()), kUnit)) return RangeResult::None;
+    v.remove_prefix(kUnit.size());
+    if (v.find(',') != std::string_view::npos) return RangeResult::None; // 不支持 multipart/byteranges
+    const size_t dash = v.find('-');
+    if (dash == std::string_view::npos) return RangeResult::None;
+    const std::string_view a = v.substr(0, dash), b = v.substr(dash + 1);
+
+    if (a.empty()) { // bytes=-N：最后 N 个字节
+        uint64_t n = 0;
+        if (!parse_u64(b, n)) return RangeResult::None;
+        if (n == 0 || size == 0) return RangeResult::Unsatisfiable;
+        first = n >= size ? 0 : size - n;
+        last  = size - 1;
+        return RangeResult::Ok;
+    }
+    uint64_t from = 0, to = UINT64_MAX;
+    if (!parse_u64(a, from)) return RangeResult::None;
+    if (!b.empty() && (!parse_u64(b, to) || to < from)) return RangeResult::None;
+    if (from >= size) return RangeResult::Unsatisfiable;
+    first = from;
+    last  = to < size ? to : size - 1;
+    return RangeResult::Ok;
+}
+
+void serve_file(const HttpRequest& req, HttpResponse& resp, const std::string& path, const StaticOptions& opts) {
+    const bool get_or_head = req.method == Method::GET || req.method == Method::HEAD;
+    const std::string_view range = req.header("Range");
+    const bool use_cache = opts.cache_bytes > 0 && get_or_head && range.empty();
+
+    const std::string_view type = mime_type(path);
+    const bool pdf  = type == "application/pdf"; // 确保内联预览而非下载
+    // 可压缩的类型可能有压缩变体：响应随 Accept-Encoding 变化，缓存需要知道
+    const bool vary = opts.precompressed && compressible_type(type);
+
+    // 预压缩的兄弟文件 x.js.br / x.js.gz：客户端接受时直接发送，请求时不耗 CPU
+    std::shared_ptr<const OpenFile> f;
+    std::string                     variant;
+    Encoding                        enc = Encoding::Identity;
+    const std::string_view ae = req.header("Accept-Encoding");
+    if (vary && get_or_head && !ae.empty()) {
+        for (Encoding e : {Encoding::Brotli, Encoding::Gzip}) {
+            if (!accepts_encoding(ae, encoding_token(e))) continue;
+            std::string cand = path + (e == Encoding::Brotli ? ".br" : ".gz");
+            if (use_cache) {
+                if (std::shared_ptr<const Asset> a = t_assets.find(cand)) { respond_asset(req, resp, a); return; }
+            }
+            if ((f = t_fds.get(cand))) {
+                variant = std::move(cand);
+                enc     = e;
+                break;
+            }
+        }
+    }
+    if (!f) {
+        if (use_cache) {
+            if (std::shared_ptr<const Asset> a = t_assets.find(path)) { respond_asset(req, resp, a); return; }
+        }
+        f = t_fds.get(path);
+    }
+    if (!f) { resp.status = 404; resp.reason = "Not Found"; resp.body = "Not Found"; return; }
+    const std::string& served = enc == Encoding::Identity ? path : variant;
+
+    // 小文件装入缓存，之后的请求直接从内存返回
+    if (use_cache && f->size() <= opts.cache_max_file) {
+        const uint64_t ep = watch(served);
+        auto a = std::make_shared<Asset>();
+        if (read_all(f->fd, f->size(), a->body)) {
+            a->id         = f->id;
+            a->etag       = f->etag;
+            a->mtime_sec  = f->id.mtime / 1000000000;
+            a->validators = "ETag: " + f->etag + "\r\nLast-Modified: " + f->last_modified + "\r\n" +
+                            (vary ? "Vary: Accept-Encoding\r\n" : "");
+            a->headers    = "Content-Type: " + std::string(type) + "\r\n" +
+                            (enc != Encoding::Identity ? "Content-Encoding: " + std::string(encoding_token(enc)) + "\r\n"
+                                                       : std::string()) +
+                            (pdf ? "Content-Disposition: inline\r\n" : "") +
+                            "Accept-Ranges: bytes\r\n" + a->validators;
+            std::shared_ptr<const Asset> ca = std::move(a);
+            t_assets.insert(served, ca, ep, opts.cache_bytes);
+            respond_asset(req, resp, ca);
+            return;
+        }
+    }
+
+    resp.set_header("ETag", f->etag);
+    resp.set_header("Last-Modified", f->last_modified);
+    if (vary) resp.set_header("Vary", "Accept-Encoding");
+    if (not_modified(req, f->etag, f->id.mtime / 1000000000)) {
+        resp.status = 304;
+        resp.reason = "Not Modified";
+        return;
+    }
+    resp.set_content_type(std::string(type));
+    if (enc != Encoding::Identity) resp.set_header("Content-Encoding", std::string(encoding_token(enc)));
+    if (pdf) resp.set_header("Content-Disposition", "inline");
+    resp.set_header("Accept-Ranges", "bytes");
+
+    uint64_t first = 0, last = 0;
+    bool partial = false;
+    if (!range.empty() && get_or_head && if_range_matches(req.header("If-Range"), *f)) {
+        switch (parse_range(range, f->size(), first, last)) {
+            case RangeResult::None: break;
+            case RangeResult::Ok:   partial = true; break;
+            case RangeResult::Unsatisfiable:
+                resp.status = 416;
+                resp.reason = "Range Not Satisfiable";
+                resp.set_header("Content-Range", "bytes */" + std::to_string(f->size()));
+                return;
+        }
+    }
+
+    const uint64_t offset = partial ? first : 0;
+    const uint64_t length = partial ? last - first + 1 : f->size();
+    if (partial) {
+        resp.status = 206;
+        resp.reason = "Partial Content";
+        resp.set_header("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+                                             std::to_string(f->size()));
+    } else {
+        resp.status = 200;
+        resp.reason = "OK";
+    }
+    if (req.method == Method::HEAD) { // 只发头部，长度照实给出
+        resp.set_header("Content-Length", std::to_string(length));
+        return;
+    }
+    if (length > 0) resp.file = FileRange{f, f->fd, offset, length};
+}
+
+} // namespace http
@@ -0,0 +1,76 @@
+#include "http/Task.h"
+
+#include <new>
+#include <utility>
+
+namespace http {
+
+namespace {
+
+#if defined(__SANITIZE_ADDRESS__)
+constexpr bool kPooled = false; // 让 ASan 看得到每个帧的释放，use-after-free 才报得出来
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+constexpr bool kPooled = false;
+#else
+constexpr bool kPooled = true;
+#endif
+#else
+constexpr bool kPooled = true;
+#endif
+
+constexpr size_t kGranule  = 64;
+constexpr size_t kClasses  = 32;         // 64B .. 2KB
+constexpr size_t kMaxCache = 256 * 1024; // 每个尺寸类最多缓存的字节数，超出的直接释放
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+// 每个线程一份：loop 线程上创建、销毁的帧都在这里循环使用，不加锁
+struct FrameCache {
+    FreeBlock* head[kClasses]{};
+    size_t     bytes[kClasses]{};
+
+    ~FrameCache() {
+        for (FreeBlock*& h : head) {
+            while (h) ::operator delete(std::exchange(h, h->next));
+        }
+    }
+};
+
+thread_local FrameCache t_cache;
+
+size_t size_class(size_t n) noexcept { return (n + kGranule - 1) / kGranule - 1; }
+
+} // namespace
+
+void* FramePool::allocate(size_t n) {
+    const size_t c = size_class(n);
+    if (!kPooled || c >= kClasses) return ::operator new(n);
+    if (FreeBlock* b = t_cache.head[c]) {
+        t_cache.head[c]   = b->next;
+        t_cache.bytes[c] -= (c + 1) * kGranule;
+        return b;
+    }
+    return ::operator new((c + 1) * kGranule);
+}
+
+void FramePool::deallocate(void* p, size_t n) noexcept {
+    const size_t c = size_class(n);
+    if (!kPooled || c >= kClasses) {
+        ::operator delete(p);
+        return;
+    }
+    const size_t sz = (c + 1) * kGranule;
+    if (t_cache.bytes[c] + sz > kMaxCache) {
+        ::operator delete(p);
+        return;
+    }
+    auto* b           = static_cast<FreeBlock*>(p);
+    b->next           = t_cache.head[c];
+    t_cache.head[c]   = b;
+    t_cache.bytes[c] += sz;
+}
+
+} // namespace http
@@ -0,0 +1,413 @@
+#include "http/WebSocket.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HTTP_WS_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define HTTP_WS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace http {
+
+namespace {
+
+// —— 握手：SHA-1 + base64，只用于 Sec-WebSocket-Accept ——
+
+constexpr std::string_view kWsGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+uint32_t rotl(uint32_t x, unsigned n) { return (x << n) | (x >> (32 - n)); }
+
+void sha1_block(uint32_t h[5], const unsigned char* b) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i)
+        w[i] = (uint32_t(b[4 * i]) << 24) | (uint32_t(b[4 * i + 1]) << 16) | (uint32_t(b[4 * i + 2]) << 8) | b[4 * i + 3];
+    for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    uint32_t a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+        uint32_t f, k;
+        if (i < 20)      { f = (bb & c) | (~bb & d);          k = 0x5A827999; }
+        else if (i < 40) { f = bb ^ c ^ d;                    k = 0x6ED9EBA1; }
+        else if (i < 60) { f = (bb & c) | (bb & d) | (c & d); k = 0x8F1BBCDC; }
+        else             { f = bb ^ c ^ d;                    k = 0xCA62C1D6; }
+        const uint32_t t = rotl(a, 5) + f + e + k + w[i];
+        e = d; d = c; c = rotl(bb, 30); bb = a; a = t;
+    }
+    h[0] += a; h[1] += bb; h[2] += c; h[3] += d; h[4] += e;
+}
+
+void sha1(std::string_view msg, unsigned char out[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const auto* p = reinterpret_cast<const unsigned char*>(msg.data());
+    size_t      n = msg.size();
+    for (; n >= 64; p += 64, n -= 64) sha1_block(h, p);
+    // 末尾：0x80、补零，最后 8 字节是按位计的总长（大端）
+    unsigned char tail[128] = {};
+    std::memcpy(tail, p, n);
+    tail[n] = 0x80;
+    const size_t   blocks = n + 9 > 64 ? 2 : 1;
+    const uint64_t bits   = static_cast<uint64_t>(msg.size()) * 8;
+    for (int i = 0; i < 8; ++i) tail[blocks * 64 - 1 - i] = static_cast<unsigned char>(bits >> (8 * i));
+    for (size_t i = 0; i < blocks; ++i) sha1_block(h, tail + 64 * i);
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 4; ++j) out[4 * i + j] = static_cast<unsigned char>(h[i] >> (24 - 8 * j));
+}
+
+std::string base64(const unsigned char* p, size_t n) {
+    static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((n + 2) / 3 * 4);
+    for (size_t i = 0; i < n; i += 3) {
+        const uint32_t v = (uint32_t(p[i]) << 16) | (i + 1 < n ? uint32_t(p[i + 1]) << 8 : 0) | (i + 2 < n ? p[i + 2] : 0);
+        out += kAlphabet[(v >> 18) & 63];
+        out += kAlphabet[(v >> 12) & 63];
+        out += i + 1 < n ? kAlphabet[(v >> 6) & 63] : '=';
+        out += i + 2 < n ? kAlphabet[v & 63] : '=';
+    }
+    return out;
+}
+
+// —— 解掩码：key 已按起始相位轮转好，按内存顺序装进一个 32 位字 ——
+
+void unmask_scalar(char* p, size_t n, uint32_t key) {
+    const uint64_t k8 = (static_cast<uint64_t>(key) << 32) | key; // 两半相同，与字节序无关
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        w ^= k8;
+        std::memcpy(p + i, &w, 8);
+    }
+    unsigned char kb[4];
+    std::memcpy(kb, &key, 4);
+    for (; i < n; ++i) p[i] = static_cast<char>(p[i] ^ kb[i & 3]); // i 是 8 的倍数起步，相位不变
+}
+
+#ifdef HTTP_WS_X86
+
+__attribute__((target("sse2")))
+void unmask_sse2(char* p, size_t n, uint32_t key) {
+    const __m128i k = _mm_set1_epi32(static_cast<int>(key));
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i* q = reinterpret_cast<__m128i*>(p + i);
+        const __m128i a = _mm_loadu_si128(q), b = _mm_loadu_si128(q + 1);
+        const __m128i c = _mm_loadu_si128(q + 2), d = _mm_loadu_si128(q + 3);
+        _mm_storeu_si128(q, _mm_xor_si128(a, k));
+        _mm_storeu_si128(q + 1, _mm_xor_si128(b, k));
+        _mm_storeu_si128(q + 2, _mm_xor_si128(c, k));
+        _mm_storeu_si128(q + 3, _mm_xor_si128(d, k));
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128i* q = reinterpret_cast<__m128i*>(p + i);
+        _mm_storeu_si128(q, _mm_xor_si128(_mm_loadu_si128(q), k));
+    }
+    unmask_scalar(p + i, n - i, key);
+}
+
+__attribute__((target("avx2")))
+void unmask_avx2(char* p, size_t n, uint32_t key) {
+    const __m256i k = _mm256_set1_epi32(static_cast<int>(key));
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i* q = reinterpret_cast<__m256i*>(p + i);
+        const __m256i a = _mm256_loadu_si256(q), b = _mm256_loadu_si256(q + 1);
+        _mm256_storeu_si256(q, _mm256_xor_si256(a, k));
+        _mm256_storeu_si256(q + 1, _mm256_xor_si256(b, k));
+    }
+    if (i + 32 <= n) {
+        __m256i* q = reinterpret_cast<__m256i*>(p + i);
+        _mm256_storeu_si256(q, _mm256_xor_si256(_mm256_loadu_si256(q), k));
+        i += 32;
+    }
+    if (i + 16 <= n) {
+        __m128i* q = reinterpret_cast<__m128i*>(p + i);
+        _mm_storeu_si128(q, _mm_xor_si128(_mm_loadu_si128(q), _mm256_castsi256_si128(k)));
+        i += 16;
+    }
+    // 尾调用进非 VEX 代码时编译器不会补 vzeroupper，ymm 高半脏着会让之后所有 SSE 指令都付过渡代价
+    _mm256_zeroupper();
+    unmask_scalar(p + i, n - i, key);
+}
+
+bool cpu_has(UnmaskImpl impl) {
+    __builtin_cpu_init();
+    switch (impl) {
+        case UnmaskImpl::Scalar: return true;
+        case UnmaskImpl::SSE2:   return __builtin_cpu_supports("sse2");
+        case UnmaskImpl::AVX2:   return __builtin_cpu_supports("avx2");
+        case UnmaskImpl::NEON:   return false;
+    }
+    return false;
+}
+
+#elif defined(HTTP_WS_NEON)
+
+void unmask_neon(char* p, size_t n, uint32_t key) {
+    const uint8x16_t k = vreinterpretq_u8_u32(vdupq_n_u32(key));
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        auto* q = reinterpret_cast<uint8_t*>(p + i);
+        vst1q_u8(q, veorq_u8(vld1q_u8(q), k));
+        vst1q_u8(q + 16, veorq_u8(vld1q_u8(q + 16), k));
+    }
+    for (; i + 16 <= n; i += 16) {
+        auto* q = reinterpret_cast<uint8_t*>(p + i);
+        vst1q_u8(q, veorq_u8(vld1q_u8(q), k));
+    }
+    unmask_scalar(p + i, n - i, key);
+}
+
+bool cpu_has(UnmaskImpl impl) { return impl == UnmaskImpl::Scalar || impl == UnmaskImpl::NEON; }
+
+#else
+
+bool cpu_has(UnmaskImpl impl) { return impl == UnmaskImpl::Scalar; }
+
+#endif
+
+struct Dispatch {
+    UnmaskImpl impl;
+    void (*unmask)(char*, size_t, uint32_t);
+};
+
+Dispatch make_dispatch(UnmaskImpl impl) {
+    switch (impl) {
+#ifdef HTTP_WS_X86
+        case UnmaskImpl::AVX2: return {impl, unmask_avx2};
+        case UnmaskImpl::SSE2: return {impl, unmask_sse2};
+#elif defined(HTTP_WS_NEON)
+        case UnmaskImpl::NEON: return {impl, unmask_neon};
+#endif
+        default:               return {UnmaskImpl::Scalar, unmask_scalar};
+    }
+}
+
+Dispatch detect() {
+    for (UnmaskImpl impl : {UnmaskImpl::AVX2, UnmaskImpl::NEON, UnmaskImpl::SSE2})
+        if (cpu_has(impl)) return make_dispatch(impl);
+    return make_dispatch(UnmaskImpl::Scalar);
+}
+
+Dispatch g_unmask = detect();
+
+bool valid_close_code(unsigned code) {
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1014) || (code >= 3000 && code <= 4999);
+}
+
+} // namespace
+
+std::string ws_accept_key(std::string_view key) {
+    std::string s;
+    s.reserve(key.size() + kWsGuid.size());
+    s.append(key).append(kWsGuid);
+    unsigned char digest[20];
+    sha1(s, digest);
+    return base64(digest, sizeof(digest));
+}
+
+void ws_unmask(char* p, size_t n, const uint8_t key[4], size_t phase) noexcept {
+    const uint8_t rotated[4] = {key[phase & 3], key[(phase + 1) & 3], key[(phase + 2) & 3], key[(phase + 3) & 3]};
+    uint32_t k;
+    std::memcpy(&k, rotated, 4);
+    g_unmask.unmask(p, n, k);
+}
+
+UnmaskImpl unmask_impl() noexcept { return g_unmask.impl; }
+
+const char* unmask_impl_name(UnmaskImpl impl) noexcept {
+    switch (impl) {
+        case UnmaskImpl::Scalar: return "scalar";
+        case UnmaskImpl::SSE2:   return "sse2";
+        case UnmaskImpl::AVX2:   return "avx2";
+        case UnmaskImpl::NEON:   return "neon";
+    }
+    return "unknown";
+}
+
+bool unmask_select(UnmaskImpl impl) noexcept {
+    if (!cpu_has(impl)) return false;
+    g_unmask = make_dispatch(impl);
+    return true;
+}
+
+bool utf8_valid(std::string_view s) noexcept {
+    const auto* p = reinterpret_cast<const unsigned char*>(s.data());
+    const size_t n = s.size();
+    size_t i = 0;
+    while (i < n) {
+        if (i + 8 <= n) { // 纯 ASCII 的一段按 8 字节整块跳过
+            uint64_t w;
+            std::memcpy(&w, p + i, 8);
+            if (!(w & 0x8080808080808080ULL)) {
+                i += 8;
+                continue;
+            }
+        }
+        const unsigned c = p[i];
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t   len;
+        uint32_t cp;
+        if (c >= 0xC2 && c <= 0xDF)  { len = 2; cp = c & 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { len = 3; cp = c & 0x0F; }
+        else if (c >= 0xF0 && c <= 0xF4) { len = 4; cp = c & 0x07; }
+        else return false; // 续字节打头、C0 / C1（必为超长编码）、F5 以上
+        if (n - i < len) return false;
+        for (size_t k = 1; k < len; ++k) {
+            const unsigned cc = p[i + k];
+            if ((cc & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (cc & 0x3F);
+        }
+        if (len == 3 && (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF))) return false;
+        if (len == 4 && (cp < 0x10000 || cp > 0x10FFFF)) return false;
+        i += len;
+    }
+    return true;
+}
+
+void ws_frame_header(WsOpcode op, uint64_t len, std::string& out, bool fin) {
+    char   h[10];
+    size_t n = 2;
+    h[0] = static_cast<char>((fin ? 0x80 : 0) | static_cast<uint8_t>(op));
+    if (len < 126) {
+        h[1] = static_cast<char>(len);
+    } else if (len <= 0xFFFF) {
+        h[1] = 126;
+        h[2] = static_cast<char>(len >> 8);
+        h[3] = static_cast<char>(len);
+        n    = 4;
+    } else {
+        h[1] = 127;
+        for (int i = 0; i < 8; ++i) h[2 + i] = static_cast<char>(len >> (56 - 8 * i));
+        n = 10;
+    }
+    out.append(h, n);
+}
+
+void ws_frame(WsOpcode op, std::string_view payload, std::string& out) {
+    ws_frame_header(op, payload.size(), out);
+    out.append(payload);
+}
+
+void ws_close_frame(uint16_t code, std::string_view reason, std::string& out) {
+    if (code == 0) {
+        ws_frame_header(WsOpcode::Close, 0, out);
+        return;
+    }
+    // 控制帧最多 125 字节：原因截短时不切断 UTF-8 序列
+    size_t cut = reason.size() < 123 ? reason.size() : 123;
+    while (cut < reason.size() && cut > 0 && (static_cast<unsigned char>(reason[cut]) & 0xC0) == 0x80) --cut;
+    ws_frame_header(WsOpcode::Close, 2 + cut, out);
+    out += static_cast<char>(code >> 8);
+    out += static_cast<char>(code);
+    out.append(reason.substr(0, cut));
+}
+
+WsMessage::WsMessage(WsOpcode op, std::string_view payload) {
+    auto f = std::make_shared<std::string>();
+    f->reserve(payload.size() + 10);
+    ws_frame(op, payload, *f);
+    frame_ = std::move(f);
+}
+
+size_t WsParser::parse(char* p, size_t n, WsEvent& ev) {
+    ev = WsEvent{};
+    // 上一个分片消息已交出：大缓冲不留在空闲连接上
+    if (!fragmented_ && !message_.empty()) {
+        if (message_.capacity() > 64 * 1024) std::string().swap(message_);
+        else                                 message_.clear();
+    }
+    const auto fail = [&ev](uint16_t code) {
+        ev.kind = WsEvent::Kind::Error;
+        ev.code = code;
+        return size_t{0};
+    };
+    size_t used = 0; // 本次已消费的非末尾分片
+    for (;;) {
+        char* const  f = p + used;
+        const size_t m = n - used;
+        if (m < 2) return used;
+        const auto     b0      = static_cast<uint8_t>(f[0]);
+        const auto     b1      = static_cast<uint8_t>(f[1]);
+        const bool     fin     = b0 & 0x80;
+        const unsigned op      = b0 & 0x0F;
+        const bool     control = op & 0x8;
+        if (b0 & 0x70) return fail(kWsCloseProtocol);   // 没有协商扩展，RSV 必须为 0
+        if (!(b1 & 0x80)) return fail(kWsCloseProtocol); // 客户端的帧必须带掩码
+        if (op > 0xA || (op > 0x2 && op < 0x8)) return fail(kWsCloseProtocol);
+
+        uint64_t len = b1 & 0x7F;
+        size_t   hdr = 2;
+        if (len == 126) {
+            if (m < 4) return used;
+            len = (uint64_t(uint8_t(f[2])) << 8) | uint8_t(f[3]);
+            hdr = 4;
+        } else if (len == 127) {
+            if (m < 10) return used;
+            len = 0;
+            for (int i = 0; i < 8; ++i) len = (len << 8) | uint8_t(f[2 + i]);
+            if (len >> 63) return fail(kWsCloseProtocol);
+            hdr = 10;
+        }
+        if (control) {
+            if (!fin || len > 125) return fail(kWsCloseProtocol);
+        } else {
+            if ((op == 0) != fragmented_) return fail(kWsCloseProtocol); // 无头的续帧，或分片中间插进新消息
+            if (len > max_ - message_.size()) return fail(kWsCloseTooBig); // 看到头就拒绝，不等负载
+        }
+        if (m - hdr < 4 + len) return used;
+        uint8_t key[4];
+        std::memcpy(key, f + hdr, 4);
+        char* const payload = f + hdr + 4;
+        ws_unmask(payload, static_cast<size_t>(len), key);
+        const std::string_view data(payload, static_cast<size_t>(len));
+        used += hdr + 4 + static_cast<size_t>(len);
+
+        if (control) {
+            if (op == static_cast<unsigned>(WsOpcode::Ping)) {
+                ev.kind = WsEvent::Kind::Ping;
+            } else if (op == static_cast<unsigned>(WsOpcode::Pong)) {
+                ev.kind = WsEvent::Kind::Pong;
+            } else {
+                ev.kind = WsEvent::Kind::Close;
+                ev.code = kWsCloseNoStatus;
+                if (len == 1) return fail(kWsCloseProtocol);
+                if (len >= 2) {
+                    ev.code = static_cast<uint16_t>((uint8_t(data[0]) << 8) | uint8_t(data[1]));
+                    if (!valid_close_code(ev.code)) return fail(kWsCloseProtocol);
+                    if (!utf8_valid(data.substr(2))) return fail(kWsCloseInvalidData);
+                    ev.data = data.substr(2);
+                }
+                return used;
+            }
+            ev.data = data;
+            return used;
+        }
+        if (!fragmented_ && fin) { // 单帧消息：直接交出 inbuf 里解掩码后的负载
+            ev.binary = op == static_cast<unsigned>(WsOpcode::Binary);
+            if (!ev.binary && !utf8_valid(data)) return fail(kWsCloseInvalidData);
+            ev.kind = WsEvent::Kind::Message;
+            ev.data = data;
+            return used;
+        }
+        if (!fragmented_) {
+            fragmented_ = true;
+            binary_     = op == static_cast<unsigned>(WsOpcode::Binary);
+        }
+        message_.append(data);
+        if (!fin) continue;
+        fragmented_ = false;
+        if (!binary_ && !utf8_valid(message_)) return fail(kWsCloseInvalidData);
+        ev.kind   = WsEvent::Kind::Message;
+        ev.binary = binary_;
+        ev.data   = message_;
+        return used;
+    }
+}
+
+} // namespace http
@@ -0,0 +1,158 @@
+#ifdef __linux__
+#include "server/IoUring.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace net {
+
+namespace {
+
+// 头文件里的 bufs 是 __DECLARE_FLEX_ARRAY，在 C++ 下空结构体占 1 字节会把数组整体后移，
+// 所以按 C 的布局手工寻址：第 i 项就在 ring 起始处 + i * sizeof(io_uring_buf)
+inline io_uring_buf& ring_entry(io_uring_buf_ring* ring, unsigned i) {
+    return reinterpret_cast<io_uring_buf*>(ring)[i];
+}
+
+} // namespace
+
+IoUring::~IoUring() {
+    if (buf_ring_) ::munmap(buf_ring_, buf_ring_len_);
+    std::free(bufs_);
+    if (sqes_) ::munmap(sqes_, sqes_len_);
+    if (cq_ptr_ && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_len_);
+    if (sq_ptr_) ::munmap(sq_ptr_, sq_len_);
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+}
+
+bool IoUring::init(unsigned entries) {
+    io_uring_params p{};
+    // 只有 loop 线程提交，允许内核省掉跨线程的同步；提交者在 enable() 时确定
+    p.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_R_DISABLED;
+    ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    disabled_ = ring_fd_ >= 0;
+    if (ring_fd_ < 0 && errno == EINVAL) { // 老内核不认识上面的 flags
+        p = io_uring_params{};
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    }
+    if (ring_fd_ < 0) return false;
+    // 需要：单次 mmap、EXT_ARG（带超时等待）
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_EXT_ARG)) return false;
+
+    sq_len_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_len_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    if (cq_len_ > sq_len_) sq_len_ = cq_len_;
+    sq_ptr_ = ::mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) { sq_ptr_ = nullptr; return false; }
+    cq_ptr_ = sq_ptr_;
+
+    sqes_len_ = p.sq_entries * sizeof(io_uring_sqe);
+    void* s = ::mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQES);
+    if (s == MAP_FAILED) return false;
+    sqes_ = static_cast<io_uring_sqe*>(s);
+
+    auto* sq = static_cast<char*>(sq_ptr_);
+    sq_head_    = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sq_tail_    = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sq_array_   = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    sq_mask_    = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sq_entries_ = p.sq_entries;
+
+    auto* cq = static_cast<char*>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    return true;
+}
+
+bool IoUring::enable() {
+    if (!disabled_) return true;
+    if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) < 0) return false;
+    disabled_ = false;
+    return true;
+}
+
+int IoUring::enter(unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t argsz) {
+    ++enter_calls_;
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                                      flags, arg, argsz));
+}
+
+io_uring_sqe* IoUring::get_sqe() {
+    unsigned tail = *sq_tail_;
+    if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+        // SQ 已满：先提交，不等待完成
+        if (enter(pending_, 0, 0, nullptr, 0) < 0) return nullptr;
+        pending_ = 0;
+        if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) return nullptr;
+    }
+    const unsigned idx = tail & sq_mask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array_[idx] = idx;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++pending_;
+    return sqe;
+}
+
+int IoUring::submit_and_wait(int timeout_ms) {
+    __kernel_timespec ts{};
+    ts.tv_sec  = timeout_ms / 1000;
+    ts.tv_nsec = static_cast<long long>(timeout_ms % 1000) * 1000000;
+    io_uring_getevents_arg arg{};
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+
+    // 已有完成事件时不阻塞，只提交
+    const bool have_cqe = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) != *cq_head_;
+    const unsigned wait_nr = have_cqe ? 0 : 1;
+    const int ret = enter(pending_, wait_nr, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                          &arg, sizeof(arg));
+    if (ret >= 0) pending_ = 0;
+    else if (errno == ETIME || errno == EINTR) return 0;
+    return ret;
+}
+
+bool IoUring::setup_buf_ring(uint16_t group, unsigned nbufs, unsigned buf_size) {
+    buf_ring_len_ = nbufs * sizeof(io_uring_buf);
+    void* r = ::mmap(nullptr, buf_ring_len_, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (r == MAP_FAILED) return false;
+    buf_ring_ = static_cast<io_uring_buf_ring*>(r);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr    = reinterpret_cast<uint64_t>(buf_ring_);
+    reg.ring_entries = nbufs;
+    reg.bgid         = group;
+    if (::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) return false;
+
+    bufs_ = static_cast<char*>(std::malloc(static_cast<size_t>(nbufs) * buf_size));
+    if (!bufs_) return false;
+    buf_size_ = buf_size;
+    buf_mask_ = nbufs - 1;
+    for (unsigned i = 0; i < nbufs; ++i) {
+        io_uring_buf& b = ring_entry(buf_ring_, i);
+        b.addr = reinterpret_cast<uint64_t>(bufs_ + static_cast<size_t>(i) * buf_size);
+        b.len  = buf_size;
+        b.bid  = static_cast<uint16_t>(i);
+    }
+    __atomic_store_n(&buf_ring_->tail, static_cast<uint16_t>(nbufs), __ATOMIC_RELEASE);
+    return true;
+}
+
+void IoUring::recycle_buf(uint16_t bid) noexcept {
+    const uint16_t tail = buf_ring_->tail;
+    io_uring_buf& b = ring_entry(buf_ring_, tail & buf_mask_);
+    b.addr = reinterpret_cast<uint64_t>(bufs_ + static_cast<size_t>(bid) * buf_size_);
+    b.len  = buf_size_;
+    b.bid  = bid;
+    __atomic_store_n(&buf_ring_->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
+
+} // namespace net
+#endif
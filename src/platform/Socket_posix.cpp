@@ -1,6 +1,13 @@
 #ifndef _WIN32
 #include "server/PlatformSocket.h"
 #include <cstdio>
+#include <netinet/tcp.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <sys/socket.h>
+#endif
 
 namespace net {
 
@@ -31,9 +38,54 @@ ssize_t socket_recv(socket_t s, char* buf, size_t len) {
 ssize_t socket_send(socket_t s, const char* buf, size_t len) {
     return ::send(s, buf, len, 0);
 }
+ssize_t socket_sendv(socket_t s, const IoSlice* iov, size_t cnt) {
+    iovec v[kMaxIoSlices];
+    if (cnt > kMaxIoSlices) cnt = kMaxIoSlices;
+    for (size_t i = 0; i < cnt; ++i) {
+        v[i].iov_base = const_cast<char*>(iov[i].data);
+        v[i].iov_len  = iov[i].len;
+    }
+    msghdr msg{};
+    msg.msg_iov    = v;
+    msg.msg_iovlen = cnt;
+#ifdef MSG_NOSIGNAL
+    return ::sendmsg(s, &msg, MSG_NOSIGNAL); // 对端已关闭时返回 EPIPE 而不是触发 SIGPIPE
+#else
+    return ::sendmsg(s, &msg, 0);
+#endif
+}
+ssize_t socket_sendfile(socket_t s, int file_fd, uint64_t offset, size_t len) {
+#if defined(__linux__)
+    off_t off = static_cast<off_t>(offset);
+    return ::sendfile(s, file_fd, &off, len);
+#elif defined(__APPLE__)
+    off_t n = static_cast<off_t>(len);
+    if (::sendfile(file_fd, s, static_cast<off_t>(offset), &n, nullptr, 0) < 0 && n == 0) return -1;
+    return static_cast<ssize_t>(n); // EAGAIN 时可能已经发出一部分
+#elif defined(__FreeBSD__)
+    off_t n = 0;
+    if (::sendfile(file_fd, s, static_cast<off_t>(offset), len, nullptr, &n, 0) < 0 && n == 0) return -1;
+    return static_cast<ssize_t>(n);
+#else
+    char buf[65536];
+    const ssize_t r = ::pread(file_fd, buf, len < sizeof(buf) ? len : sizeof(buf), static_cast<off_t>(offset));
+    if (r <= 0) return r == 0 ? -1 : r;
+    return ::send(s, buf, static_cast<size_t>(r), 0);
+#endif
+}
 socket_t socket_accept(socket_t s, sockaddr* addr, socklen_t* len) {
     return ::accept(s, addr, len);
 }
+int socket_connect(socket_t s, const sockaddr* addr, socklen_t len) {
+    if (::connect(s, addr, len) == 0) return 0;
+    return errno == EINPROGRESS ? 1 : -1;
+}
+int socket_error(socket_t s) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (::getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &len) < 0) return errno;
+    return err;
+}
 bool is_would_block(int err) {
     return err == EAGAIN || err == EWOULDBLOCK;
 }
@@ -48,5 +100,10 @@ bool set_socket_nonblocking(socket_t s) {
     return fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
 }
 
+bool set_socket_nodelay(socket_t s) {
+    int on = 1;
+    return ::setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) == 0;
+}
+
 } // namespace net
 #endif
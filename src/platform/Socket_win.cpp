@@ -1,6 +1,7 @@
 #ifdef _WIN32
 #include "server/PlatformSocket.h"
 #include <ws2def.h>
+#include <io.h>
 #include <iostream>
 
 namespace net {
@@ -38,9 +39,39 @@ ssize_t socket_send(socket_t s, const char* buf, size_t len) {
     int r = ::send(s, buf, static_cast<int>(len), 0);
     return r;
 }
+ssize_t socket_sendv(socket_t s, const IoSlice* iov, size_t cnt) {
+    WSABUF v[kMaxIoSlices];
+    if (cnt > kMaxIoSlices) cnt = kMaxIoSlices;
+    for (size_t i = 0; i < cnt; ++i) {
+        v[i].buf = const_cast<char*>(iov[i].data);
+        v[i].len = static_cast<ULONG>(iov[i].len);
+    }
+    DWORD sent = 0;
+    if (::WSASend(s, v, static_cast<DWORD>(cnt), &sent, 0, nullptr, nullptr) == SOCKET_ERROR) return -1;
+    return static_cast<ssize_t>(sent);
+}
+ssize_t socket_sendfile(socket_t s, int file_fd, uint64_t offset, size_t len) {
+    // TransmitFile 需要重叠 I/O 才能配合非阻塞 socket，这里简单地读一块再发
+    char buf[65536];
+    if (::_lseeki64(file_fd, static_cast<__int64>(offset), SEEK_SET) < 0) return -1;
+    const int r = ::_read(file_fd, buf, static_cast<unsigned>(len < sizeof(buf) ? len : sizeof(buf)));
+    if (r <= 0) return -1;
+    return ::send(s, buf, r, 0);
+}
 socket_t socket_accept(socket_t s, sockaddr* addr, socklen_t* len) {
     return ::accept(s, addr, len);
 }
+int socket_connect(socket_t s, const sockaddr* addr, socklen_t len) {
+    if (::connect(s, addr, len) == 0) return 0;
+    return WSAGetLastError() == WSAEWOULDBLOCK ? 1 : -1;
+}
+int socket_error(socket_t s) {
+    int err = 0;
+    int len = sizeof(err);
+    if (::getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len) == SOCKET_ERROR)
+        return WSAGetLastError();
+    return err;
+}
 bool is_would_block(int err) {
     return err == WSAEWOULDBLOCK;
 }
@@ -54,5 +85,10 @@ bool set_socket_nonblocking(socket_t s) {
     return ioctlsocket(s, FIONBIO, &mode) == 0;
 }
 
+bool set_socket_nodelay(socket_t s) {
+    BOOL on = TRUE;
+    return ::setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on)) == 0;
+}
+
 } // namespace net
 #endif
@@ -0,0 +1,52 @@
+#ifndef _WIN32
+#include "server/Waker.h"
+#include <cstdint>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace net {
+
+Waker::~Waker() {
+    if (is_valid_socket(read_fd_)) ::close(read_fd_);
+    if (is_valid_socket(write_fd_) && write_fd_ != read_fd_) ::close(write_fd_);
+}
+
+bool Waker::open() {
+#ifdef __linux__
+    // eventfd：一个 8 字节计数器，多次 notify 合并成一次可读
+    const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) return false;
+    read_fd_ = write_fd_ = fd;
+    return true;
+#else
+    int p[2];
+    if (::pipe(p) != 0) return false;
+    for (int fd : p) {
+        set_socket_nonblocking(fd); // 管道写满时 notify 直接放弃：已经有未读的唤醒了
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    read_fd_  = p[0];
+    write_fd_ = p[1];
+    return true;
+#endif
+}
+
+void Waker::notify() noexcept {
+#ifdef __linux__
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = ::write(write_fd_, &one, sizeof(one));
+#else
+    const char one = 1;
+    [[maybe_unused]] ssize_t n = ::write(write_fd_, &one, 1);
+#endif
+}
+
+void Waker::drain() noexcept {
+    char buf[64];
+    while (::read(read_fd_, buf, sizeof(buf)) > 0) {
+    }
+}
+
+} // namespace net
+#endif
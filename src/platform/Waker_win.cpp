@@ -0,0 +1,41 @@
+#ifdef _WIN32
+#include "server/Waker.h"
+
+namespace net {
+
+Waker::~Waker() {
+    if (is_valid_socket(read_fd_)) ::closesocket(read_fd_);
+}
+
+bool Waker::open() {
+    // select 只认 socket：绑定 127.0.0.1 的 UDP socket 连向自己，notify 即给自己发一个字节
+    socket_t s = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (!is_valid_socket(s)) return false;
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+    int len = sizeof(addr);
+    if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0 ||
+        ::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || !set_socket_nonblocking(s)) {
+        ::closesocket(s);
+        return false;
+    }
+    read_fd_ = write_fd_ = s;
+    return true;
+}
+
+void Waker::notify() noexcept {
+    const char one = 1;
+    ::send(write_fd_, &one, 1, 0);
+}
+
+void Waker::drain() noexcept {
+    char buf[64];
+    while (::recv(read_fd_, buf, sizeof(buf), 0) > 0) {
+    }
+}
+
+} // namespace net
+#endif
@@ -0,0 +1,1210 @@
+#include "server/EventLoop.h"
+#include "server/PlatformSocket.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace net {
+
+namespace {
+
+// 交给工作线程的请求：自带一份请求字节（req 的视图改指到这里），
+// 处理完挂回所属 loop 的完成队列，由 loop 线程写出响应
+struct AsyncJob final : Task {
+    EventLoop*          loop{nullptr};
+    const http::Router* router{nullptr};
+    const http::Route*  route{nullptr};
+    socket_t            fd{};
+    uint32_t            gen{0};
+    uint32_t            stream{0};      // HTTP/2 的流，0 为 HTTP/1.1
+    EventLoop::Clock::time_point start; // 指标：从路由开始计时
+    std::string         raw;
+    http::HttpRequest   req;
+    http::HttpResponse  resp;
+
+    void run() noexcept override {
+        router->run_deferred(*route, req, resp);
+        loop->post(this);
+    }
+    void cancel() noexcept override {
+        http::Router::cancel_deferred(*route);
+        delete this;
+    }
+};
+
+// 其他线程对流式响应的唤醒（HttpResponse::stream_waker）
+struct StreamWake final : MpscNode {
+    uint64_t conn{0};
+    uint32_t stream{0};
+};
+
+} // namespace
+
+EventLoop::~EventLoop() {
+    close_all();
+    // 池已停止：剩下的是已完成但 loop 没来得及收尾的请求
+    while (MpscNode* n = done_.pop()) delete static_cast<AsyncJob*>(n);
+    while (MpscNode* n = stream_wakes_.pop()) delete static_cast<StreamWake*>(n);
+    ws_detach();
+}
+
+bool EventLoop::open(uint16_t port, bool reuse_port) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (!is_valid_socket(listen_fd_)) {
+        sys_perror("socket");
+        return false;
+    }
+
+    // 端口复用
+    int opt = 1;
+    if (::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&opt), sizeof(opt)) < 0) {
+        sys_perror("setsockopt(SO_REUSEADDR)");
+        // 不致命，继续
+    }
+#ifdef SO_REUSEPORT
+    // 多 loop 模式：每个 loop 各自绑定同一端口，由内核做连接负载均衡
+    if (reuse_port &&
+        ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&opt), sizeof(opt)) < 0) {
+        sys_perror("setsockopt(SO_REUSEPORT)");
+        return false;
+    }
+#else
+    if (reuse_port) return false;
+#endif
+
+    // 绑定 0.0.0.0:port
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY); // 设置监听的ip为0.0.0.0
+    addr.sin_port        = htons(port);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        sys_perror("bind");
+        return false;
+    }
+
+    if (::listen(listen_fd_, 128) < 0) {
+        sys_perror("listen");
+        return false;
+    }
+
+    if (!set_nonblocking(listen_fd_)) {
+        sys_perror("set_nonblocking(listen_fd_)");
+        // 这里不强制失败，但建议继续返回 true
+    }
+
+    if (!waker_.open()) {
+        sys_perror("waker");
+        return false;
+    }
+
+    if (backend_ == Backend::IoUring) {
+#ifdef __linux__
+        if (open_uring()) return true;
+#endif
+        // io_uring 不可用（老内核 / 被禁用）：回退到 epoll 或 select
+        std::cerr << "io_uring unavailable, falling back to poller backend" << std::endl;
+        backend_ = Backend::Auto;
+    }
+    return open_poller();
+}
+
+bool EventLoop::open_poller() {
+    poller_ = make_poller(backend_);
+    if (!poller_ || !poller_->add_listener(listen_fd_)) {
+        std::cerr << "event backend " << backend_name(backend_) << " unavailable" << std::endl;
+        return false;
+    }
+    // Waker 按监听 fd 的方式注册：电平触发，读空之前一直可读
+    if (!poller_->add_listener(waker_.fd())) return false;
+    return true;
+}
+
+Backend EventLoop::backend() const noexcept {
+#ifdef __linux__
+    if (uring_) return Backend::IoUring;
+#endif
+    return poller_ ? poller_->backend() : backend_;
+}
+
+bool EventLoop::handle_read(Connection& c) {
+    char buf[8192];
+
+    // 非阻塞尽量读空内核缓冲
+    for (;;) {
+        if (c.read_paused) break; // 流式请求体积压：数据留在内核里，协程取走后再读
+        const ssize_t n = socket_recv(c.fd, buf, sizeof(buf));
+        ++stats_.syscalls;
+        if (n > 0) { //后续还要继续读
+            c.last_read = now_;
+            metrics_->bytes_in.add(static_cast<uint64_t>(n));
+            borrow_io(c).inbuf.append(buf, static_cast<size_t>(n)); //处理读事件，把数据放入连接的输入缓冲区
+            if (tracer_) {
+                if (!c.io->trace) c.io->trace = std::make_unique<ConnTrace>();
+                c.io->trace->last_recv = trace_ticks();
+            }
+            // 每收到一块就交给增量解析器：解析器只扫描新到的字节，
+            // 完整的请求立即处理并移出 inbuf，inbuf 里最多只剩一个未完成的请求
+            if (!process_input(c)) return false;
+            continue;
+        }
+
+        if (n == 0) {
+            // 对端正常关闭
+            return false;
+        }
+
+        // n < 0：错误或暂不可读
+        const int err = last_sys_err();
+        if (is_would_block(err)) {
+            break; // 读完当前可得数据
+        }
+        // 其他错误
+        sys_perror("recv");
+        return false;
+    } // 将内核缓冲全读到inbuf中
+
+    return true;
+}
+
+bool EventLoop::process_input(Connection& c) {
+    if (!c.io) return true; // 没有收到过数据
+    if (c.h2) return h2_input(c);
+    if (c.ws) return ws_input(c);
+    // 边收边处理的请求体（流式交给协程 / 落盘）：先消化新到的数据，收齐前 inbuf 开头是它的请求头
+    if (c.io->body && !feed_body(c)) return true;
+    // 协程路由在头部完整时就已启动：先把它的请求体收齐，收齐前 inbuf 开头就是这个请求
+    if (c.call && !c.call->body_ready && !feed_call_body(c)) return true;
+
+    // 已决定关闭（Connection: close / 400 / 413）：之后到达的数据一律丢弃
+    if (!c.keep_alive) {
+        c.io->inbuf.clear();
+        return true;
+    }
+    // 前一个请求还在工作线程 / 协程里，或者流式响应还没发完：为保证响应顺序先只收数据，积压过多则断开
+    if (c.async_pending || c.streaming()) return c.io->inbuf.size() <= kMaxRequestSize;
+
+    // HTTP/1.1 pipelining：按顺序处理 inbuf 里所有完整的请求，
+    // 响应依次追加到 out，由写阶段用 writev 合并成尽量少的 send
+    size_t   off    = 0;
+    unsigned reject = 0; // 请求体超过路由的上限：前面的请求照常处理，然后回 413
+    while (off < c.io->inbuf.size()) {
+        // 未完成的请求总是从 inbuf 开头开始，解析器从上次停下的位置继续
+        const std::string_view pending(c.io->inbuf.data() + off, c.io->inbuf.size() - off);
+        // 连接的第一个请求以 HTTP/2 连接前言开头（prior knowledge）：整个连接改走 HTTP/2
+        if (http2_ && off == 0 && c.responses == 0 && pending[0] == 'P') {
+            const size_t n = std::min(pending.size(), h2::kPreface.size());
+            if (pending.substr(0, n) == h2::kPreface.substr(0, n)) {
+                if (n < h2::kPreface.size()) return true; // 前言还没收全
+                return h2_start(c);
+            }
+        }
+        const uint64_t trace_t0 = tracer_ ? trace_feed_begin(c) : 0;
+        const bool     complete = c.io->parser.feed(pending) == http::HttpParser::Status::Complete;
+        if (tracer_) trace_feed_end(c, trace_t0, complete ? &c.io->parser.request() : nullptr);
+        if (!complete) {
+            // 头部已完整、请求体还在路上：按路由决定怎么收（上限、100-continue、
+            // 流式交给协程 / 落盘、协程路由提前启动）
+            if (c.io->parser.in_body() && !c.body_probed) {
+                c.body_probed = true;
+                reject = begin_body(c, pending.substr(0, c.io->parser.consumed()));
+            }
+            break;
+        }
+
+        auto& req = c.io->parser.request();
+        // 请求体和请求头一起到齐（没经过 begin_body），或是 chunked 解码在内存里的：路由的上限在这里查
+        if (!req.body.empty() && router_ && router_->has_body_options()) {
+            const http::Route* r = router_->match_route(req);
+            if (r && r->opts.max_body && req.body.size() > r->opts.max_body) {
+                reject = 413;
+                break;
+            }
+        }
+        // Upgrade: h2c：回 101，这个请求作为流 1 在 HTTP/2 上答复，后面的字节都是 HTTP/2 帧。
+        // 在建本请求的响应之前：流 1 的分派同样要回卷 arena
+        if (http2_ && req.keep_alive() && !req.header("HTTP2-Settings").empty() &&
+            h2_upgrade(c, pending.substr(0, c.io->parser.consumed()), req)) {
+            off += c.io->parser.consumed();
+            end_request(c);
+            c.io->inbuf.erase(0, off);
+            return h2_input(c);
+        }
+        // Upgrade: websocket 到注册的 WebSocket 端点：回 101，后面的字节都是 WebSocket 帧
+        if (!ws_routes_.empty() && ws_upgrade(c, req)) {
+            if (!c.ws) return true; // 握手不合规：已回了错误，发完即关闭
+            off += c.io->parser.consumed();
+            end_request(c);
+            c.io->inbuf.erase(0, off);
+            return ws_input(c);
+        }
+
+        // 上一个响应已序列化进输出队列，它在 arena 里的内存不再被引用：整块回卷。
+        // 交给工作线程的响应在 submit_job 里移进堆上的 AsyncJob::resp（逐元素拷出 arena）
+        c.io->arena.rewind();
+        http::HttpResponse resp(&c.io->arena);
+
+        c.keep_alive = req.keep_alive();
+        resp.set_keep_alive(c.keep_alive);
+
+        // 找到路由并执行处理函数；有工作线程池时 blocking 路由只做匹配，交给池执行，
+        // 协程路由在本 loop 上启动
+        using Dispatch = http::Router::Dispatch;
+        const http::Route* route   = nullptr;
+        const auto         start   = Clock::now();
+        bool               builtin = false;
+        const auto         d       = route_request(req, resp, route, builtin);
+        if (tracer_) c.io->trace->cur.route = route_id(route);
+
+        if (d == Dispatch::Deferred || d == Dispatch::Coroutine) {
+            const size_t used = c.io->parser.consumed();
+            if (d == Dispatch::Deferred) submit_job(c, pending.substr(0, used), req, *route, std::move(resp), start);
+            else                         start_call(c, pending.substr(0, used), false, req, *route);
+            off += used;
+            end_request(c);
+            if (!c.keep_alive) {
+                off = c.io->inbuf.size();
+                break;
+            }
+            if (c.async_pending || c.streaming()) break; // 后面的 pipelined 请求等这个响应回来再处理
+            continue;                                    // 协程没有挂起就做完了：响应已入队
+        }
+
+        if (d == Dispatch::NotFound) { // 未命中路由，返回 404，也可能是服务器对象未设置路由
+            resp.status = 404;
+            resp.reason = "Not Found";
+            resp.body   = "Not Found";
+            resp.set_content_type("text/plain; charset=utf-8");
+        }
+
+        // 生成响应
+        queue_response(c, resp, &req);
+        ++stats_.requests;
+        if (!builtin) observe(route_id(route), resp.status, start);
+
+        // 只消费这个请求占用的字节，后面可能还有下一个请求
+        off += c.io->parser.consumed();
+        end_request(c);
+
+        if (!c.keep_alive) { // 客户端要求关闭：后续请求不再处理
+            off = c.io->inbuf.size();
+            break;
+        }
+        if (c.streaming()) break; // 流发完（pump_stream 返回 true）再处理后面的请求
+    }
+    if (off > 0) c.io->inbuf.erase(0, off); // 每次 process_input 只搬移一次剩余数据
+
+    // 请求体超过上限（声明的长度或已收到的）：返回 413 并关闭，不读剩下的请求体
+    if (reject) {
+        queue_error(c, reject, "Payload Too Large");
+        return true; // 让写阶段发送响应；发送完会根据 keep_alive 关闭
+    }
+    // 解析失败：返回 400（请求头行数超过上限为 431）
+    if (c.io->parser.error()) {
+        if (c.io->parser.error_status() == 431) queue_error(c, 431, "Request Header Fields Too Large");
+        else                                    queue_error(c, 400, "Bad Request");
+        return true; // 让写阶段发送 400 / 431
+    }
+    // 剩下的不完整请求过大：同样 413
+    if (c.io->inbuf.size() > request_limit(*c.io)) {
+        queue_error(c, 413, "Payload Too Large");
+        return true;
+    }
+    // 刚开始边收边处理的请求体：inbuf 里已经到了的那部分
+    if (c.io->body) return process_input(c);
+
+    // 既未出错也未解析出完整请求 => 继续等更多数据
+    return true;
+}
+
+http::Router::Dispatch EventLoop::route_request(http::HttpRequest& req, http::HttpResponse& resp,
+                                               const http::Route*& route, bool& builtin) {
+    using Dispatch = http::Router::Dispatch;
+    builtin = false;
+    if (!endpoints_.empty() && req.method == http::Method::GET) {
+        for (const Endpoint& e : endpoints_) {
+            if (req.path != e.path) continue;
+            builtin   = true; // 内置端点：抓取本身不计入路由延迟
+            resp.body = e.render();
+            resp.set_content_type(e.content_type);
+            return Dispatch::Done;
+        }
+    }
+    return router_ ? router_->dispatch(req, resp, route, pool_ != nullptr) : Dispatch::NotFound;
+}
+
+uint64_t EventLoop::body_limit(http::HttpRequest& req) const {
+    const http::Route* r = router_ && router_->has_body_options() ? router_->match_route(req) : nullptr;
+    return r && r->opts.max_body ? r->opts.max_body : kMaxRequestSize;
+}
+
+unsigned EventLoop::begin_body(Connection& c, std::string_view head) {
+    ConnIo& io  = *c.io;
+    auto&   req = io.parser.request();
+    const http::Route* r = router_ && (router_->has_coroutines() || router_->has_body_options())
+                               ? router_->match_route(req)
+                               : nullptr;
+    const uint64_t limit   = r && r->opts.max_body ? r->opts.max_body
+                                                   : kMaxRequestSize - std::min(head.size(), kMaxRequestSize);
+    const bool     chunked = io.parser.chunked();
+    if (!chunked && io.parser.body_length() > limit) return 413; // 声明的长度就超了：不等请求体
+
+    // 客户端发完请求头在等 100 Continue 才发请求体（RFC 9110 10.1.1）；要拒绝的上面已直接回了 413
+    if (req.version == "HTTP/1.1" && http::iequals(req.header("Expect"), "100-continue")) {
+        static constexpr std::string_view kContinue = "HTTP/1.1 100 Continue\r\n\r\n";
+        io.out.append_borrowed(kContinue);
+        if (io.trace) io.trace->queued += kContinue.size(); // 不属于哪条记录，只占输出流的位置
+    }
+    io.max_request = head.size() + limit;
+
+    const bool stream = r && r->async && r->opts.stream_body;
+    const bool spill  = r && r->opts.spill_threshold && (chunked || io.parser.body_length() > r->opts.spill_threshold);
+    if (stream || spill) {
+        auto b = std::make_unique<RequestBody>();
+        if (chunked) b->decoder.reset_chunked();
+        else         b->decoder.reset_length(io.parser.body_length());
+        b->limit           = limit;
+        b->spill_threshold = r->opts.spill_threshold;
+        b->head            = head.size();
+        b->stream          = stream;
+        io.body            = std::move(b);
+    }
+    // 协程路由不必等请求体：处理函数 co_await 请求体（或一块块取）时再等。
+    // 落盘的请求体要等写完，请求照常在收齐后分派
+    if (r && r->async && !(spill && !stream)) {
+        if (tracer_) trace_feed_end(c, trace_ticks(), &req); // 请求头完整即算解析完
+        c.keep_alive = req.keep_alive();
+        start_call(c, head, true, req, *r);
+    }
+    return 0;
+}
+
+bool EventLoop::feed_body(Connection& c) {
+    ConnIo&      io = *c.io;
+    RequestBody& b  = *io.body;
+    // 从请求头之后解码；解码器不缓冲，没解码完的尾巴（半个 chunk-size 行）留在 inbuf 里
+    const std::string_view in = std::string_view(io.inbuf).substr(b.head);
+    std::string_view data;
+    size_t   used = 0;
+    unsigned fail = 0;
+    while (used < in.size() && !b.decoder.done()) {
+        used += b.decoder.next(in.substr(used), data);
+        if (b.decoder.error()) {
+            fail = 400;
+            break;
+        }
+        if (b.decoder.size() > b.limit) {
+            fail = 413;
+            break;
+        }
+        if (data.empty()) continue;
+        if (b.stream) {
+            CoroCall& call = *c.call;
+            if (!call.responded) call.body_next.append(data.data(), data.size()); // 已答复：收下丢弃
+        } else if (!spill_body(b, data)) {
+            fail = 500;
+            break;
+        }
+    }
+    if (fail) {
+        queue_error(c, fail, fail == 400 ? "Bad Request" : fail == 413 ? "Payload Too Large" : "Internal Server Error");
+        return false;
+    }
+    io.inbuf.erase(b.head, used);
+
+    if (b.stream) {
+        CoroCall& call = *c.call;
+        if (b.decoder.done()) {
+            io.inbuf.erase(0, b.head); // 协程自带请求头的副本
+            end_request(c);
+            call.body_ready = true;
+        } else if (call.body_next.size() >= kBodyHighWater) {
+            pause_read(c); // 协程取得慢：先不读，数据留在内核缓冲里，对端的发送窗口随之收窄
+        }
+        const bool ready = call.body_ready;
+        wake_body_waiter(c);
+        settle_call(c);
+        return ready;
+    }
+    if (!b.decoder.done()) return false;
+    // 收齐：请求照常分派，请求体在文件或 b.mem 里，到 end_request 才释放
+    if (b.file) {
+        io.parser.finish_body({});
+        io.parser.request().body_file = http::BodyFile{b.file, b.file->fd(), b.file->size()};
+    } else {
+        io.parser.finish_body(b.mem);
+    }
+    return true;
+}
+
+bool EventLoop::spill_body(RequestBody& b, std::string_view data) {
+    if (!b.file) {
+        if (b.mem.size() + data.size() <= b.spill_threshold) {
+            b.mem.append(data.data(), data.size());
+            return true;
+        }
+        // 超过阈值：已收的部分连同这一块写进临时文件，此后只占页缓存
+        b.file = SpillFile::create(spill_dir_);
+        if (!b.file || !b.file->write(b.mem)) return false;
+        std::string().swap(b.mem);
+        metrics_->bodies_spilled.add();
+    }
+    return b.file->write(data);
+}
+
+void EventLoop::queue_error(Connection& c, unsigned status, const char* reason) {
+    const bool answered = c.call && c.call->responded; // 处理函数没等请求体收齐就答复了：不再回第二个
+    if (c.call) { // 还在等请求体的协程路由
+        cancel_call(c);
+        c.async_pending = false;
+    }
+    if (!answered) {
+        http::HttpResponse resp;
+        resp.status = status;
+        resp.reason = reason;
+        resp.body   = reason;
+        resp.set_content_type("text/plain; charset=utf-8");
+        resp.set_keep_alive(false);
+        queue_response(c, resp);
+    }
+    if (status == 400)      metrics_->parse_errors.add();
+    else if (status == 413) metrics_->too_large.add();
+    else if (status == 408) metrics_->timeouts.add();
+    c.keep_alive = false;
+    c.io->inbuf.clear();
+    end_request(c);
+}
+
+void EventLoop::end_request(Connection& c) noexcept {
+    c.io->parser.reset();
+    c.io->body.reset();
+    c.io->max_request = 0;
+    c.body_probed     = false;
+}
+
+void EventLoop::pause_read(Connection& c) {
+    if (c.read_paused) return;
+    c.read_paused = true;
+#ifdef __linux__
+    if (uring_) {
+        uring_pause_recv(c);
+        return;
+    }
+#endif
+    poller_->set_want_read(c.fd, false); // select 是电平触发：不撤掉会一直报可读
+}
+
+void EventLoop::resume_read(Connection& c) {
+    if (c.read_paused) read_ready_.push_back(StreamRef{c.fd, c.gen});
+}
+
+void EventLoop::resume_reads() {
+    if (read_ready_.empty()) return;
+    std::vector<StreamRef> ready;
+    ready.swap(read_ready_);
+    for (const StreamRef& r : ready) {
+        Connection* c = conns_.find(r.fd);
+        if (!c || c->gen != r.gen || c->closing || !c->read_paused) continue; // 已关闭或已恢复
+        c->read_paused = false;
+#ifdef __linux__
+        if (uring_) {
+            if (!c->recv_armed) uring_arm_recv(*c);
+            c = conns_.find(r.fd); // 挂不上时连接已关闭
+            if (c && c->gen == r.gen && !c->closing) after_async(*c);
+            continue;
+        }
+#endif
+        poller_->set_want_read(c->fd, true);
+        if (!handle_read(*c)) { // 边沿触发：暂停期间到达的数据不会再有通知，这里直接读
+            close_conn(c->fd);
+            continue;
+        }
+        after_async(*c);
+    }
+}
+
+void EventLoop::queue_response(Connection& c, http::HttpResponse& resp, const http::HttpRequest* req) {
+    ++c.responses;
+    metrics_->requests.add();
+    metrics_->count_status(resp.status);
+    const uint64_t routed = tracer_ ? trace_ticks() : 0;
+    ConnIo&      io  = borrow_io(c);
+    OutputQueue& out = io.out;
+    if (resp.stream) {
+        // HTTP/1.0 不认识 chunked：不带长度发，发完关闭连接作为结束
+        if (resp.stream_length == http::HttpResponse::kChunked && req && req->version == "HTTP/1.0") {
+            resp.stream_length = http::HttpResponse::kUntilClose;
+        }
+        if (resp.stream_length == http::HttpResponse::kUntilClose) {
+            resp.set_keep_alive(false);
+            c.keep_alive = false;
+        }
+    }
+    std::string head = out.take_buffer(); // 复用发完的段的缓冲
+    resp.write_head(head);
+    if (resp.stream) {
+        // 只发响应头：HEAD 请求、不带体的状态码
+        const bool bodiless = (req && req->method == http::Method::HEAD) || resp.status < 200 ||
+                              resp.status == 204 || resp.status == 304;
+        if (tracer_) trace_queued(c, routed, static_cast<uint16_t>(resp.status), head.size(), !bodiless);
+        out.append(std::move(head));
+        if (!bodiless) {
+            io.stream           = std::make_unique<ResponseStream>();
+            io.stream->producer = std::move(resp.stream);
+            io.stream->chunked  = resp.stream_length == http::HttpResponse::kChunked;
+            io.stream->timer.data = timer_tag(kTimerStream, c);
+            if (resp.stream_signal) {
+                io.stream->signal = std::move(resp.stream_signal);
+                io.stream->signal->bind(&EventLoop::stream_wake_sink, this, io.stream->timer.data, 0);
+            }
+        }
+        return;
+    }
+    if (tracer_) trace_queued(c, routed, static_cast<uint16_t>(resp.status), head.size() + resp.body_size());
+    out.append(std::move(head));
+    // 大响应体单独成段，移动或共享进队列，不拷贝；小响应体会并入响应头那一段
+    if (resp.file.fd >= 0) {
+        out.append_file(std::move(resp.file.owner), resp.file.fd, resp.file.offset, resp.file.length);
+    } else if (resp.shared_body) {
+        out.append_shared(std::move(resp.shared_body));
+    } else {
+        out.append(std::move(resp.body));
+    }
+}
+
+// 每个 loop 最多留这么多空闲的 ConnIo；被大请求撑大的输入缓冲归还时释放
+static constexpr size_t kIoPoolMax   = 256;
+static constexpr size_t kIoKeepBytes = 16 * 1024;
+
+ConnIo& EventLoop::borrow_io(Connection& c) {
+    if (!c.io) {
+        if (io_pool_.empty()) {
+            c.io = std::make_unique<ConnIo>();
+        } else {
+            c.io = std::move(io_pool_.back());
+            io_pool_.pop_back();
+        }
+    }
+    return *c.io;
+}
+
+void EventLoop::return_io(Connection& c) {
+    if (!c.io) return;
+    ConnIo& io = *c.io;
+    io.parser.reset();
+    io.out.clear();
+    io.arena.rewind();
+    if (io.trace) io.trace->reset();
+    if (io.stream) {
+        wheel_.cancel(io.stream->timer);
+        io.stream.reset(); // 连接关闭时流还没发完：生产者随之销毁
+    }
+    io.body.reset(); // 同上：没收完的请求体，落盘的临时文件随之删除
+    io.max_request = 0;
+    if (io.inbuf.capacity() > kIoKeepBytes) std::string().swap(io.inbuf);
+    else                                    io.inbuf.clear();
+    if (io_pool_.size() < kIoPoolMax) io_pool_.push_back(std::move(c.io));
+    c.io.reset();
+}
+
+void EventLoop::submit_job(Connection& c, std::string_view raw, const http::HttpRequest& req,
+                           const http::Route& route, http::HttpResponse&& resp, Clock::time_point start,
+                           uint32_t stream) {
+    auto job    = std::make_unique<AsyncJob>();
+    job->loop   = this;
+    job->router = router_;
+    job->route  = &route;
+    job->fd     = c.fd;
+    job->gen    = c.gen;
+    job->stream = stream;
+    job->start  = start;
+    copy_request(raw, req, job->req, job->raw); // inbuf 随后会被搬移，请求必须自带字节
+    job->resp = std::move(resp);
+    if (!stream) c.async_pending = true; // HTTP/2 的流各自答复，连接不用等
+    pool_->submit(job.release());
+}
+
+void EventLoop::copy_request(std::string_view raw, const http::HttpRequest& src, http::HttpRequest& req,
+                             std::string& out) {
+    const std::string_view body = src.body;
+    const auto at = [](const char* p) { return reinterpret_cast<uintptr_t>(p); };
+    const bool outside = !body.empty() && (at(body.data()) < at(raw.data()) ||
+                                           at(body.data()) + body.size() > at(raw.data()) + raw.size());
+    out.reserve(raw.size() + (outside ? body.size() : 0));
+    out.assign(raw.data(), raw.size());
+    req = src;
+    req.rebase(raw.data(), raw.size(), out.data());
+    if (outside) {
+        out.append(body.data(), body.size());
+        req.body = std::string_view(out).substr(raw.size());
+    }
+}
+
+void EventLoop::post(Task* done) noexcept {
+    done_.push(done);
+    // 已经有一次未处理的唤醒就不再写 eventfd：一批完成只花一次系统调用
+    if (!wake_pending_.exchange(true)) waker_.notify();
+}
+
+void EventLoop::drain_completions() {
+    wake_pending_.store(false); // 先清标志再取：之后入队的任务一定会再次唤醒
+    while (MpscNode* n = done_.pop()) {
+        std::unique_ptr<AsyncJob> job(static_cast<AsyncJob*>(n));
+        Connection* conn = conns_.find(job->fd);
+        if (!conn || conn->gen != job->gen || conn->closing) continue; // 连接已关闭
+        Connection& c = *conn;
+        if (job->stream) { // 流在此期间被撤销时 h2_respond 直接丢弃
+            if (!c.h2) continue;
+            h2_respond(c, job->stream, job->resp, job->req.method == http::Method::HEAD);
+        } else {
+            c.async_pending = false;
+            queue_response(c, job->resp, &job->req);
+        }
+        ++stats_.requests;
+        observe(job->route->id, job->resp.status, job->start);
+        after_async(c);
+    }
+    ws_drain(true); // 其他线程发布的广播
+    while (MpscNode* n = stream_wakes_.pop()) { // 其他线程唤醒的流式响应
+        std::unique_ptr<StreamWake> w(static_cast<StreamWake*>(n));
+        on_stream_wake(w->conn, w->stream);
+    }
+}
+
+void EventLoop::after_async(Connection& c) {
+    bool ok = process_input(c); // 等在后面的 pipelined 请求
+#ifdef __linux__
+    if (uring_) {
+        if (!ok) uring_close(c);
+        else if (uring_flush(c)) refresh_timer(c);
+        return;
+    }
+#endif
+    ok = ok && handle_write(c);
+    if (ok && !c.has_output() && !c.keep_alive && !c.async_pending && !c.streaming()) ok = false;
+    if (!ok) {
+        close_conn(c.fd);
+        return;
+    }
+    poller_->set_want_write(c.fd, c.has_output());
+    refresh_timer(c);
+}
+
+bool EventLoop::pump_stream(Connection& c, size_t& budget) {
+    ConnIo&         io = *c.io;
+    ResponseStream& s  = *io.stream;
+    while (io.out.size() < kStreamHighWater) {
+        s.chunk.clear();
+        if (s.signal) s.signal->rearm(); // 从这里起的 wake() 都会再投递一次
+        const bool   more = s.producer(s.chunk);
+        const size_t n    = s.chunk.size();
+        uint64_t     queued = 0;
+        if (n > 0) {
+            budget = n < budget ? budget - n : 0;
+            if (s.chunked) {
+                // chunk-size 行 + 数据 + CRLF：小块拼成一段，大块的数据单独成段、移进队列不拷贝
+                char hex[20];
+                std::string frame = io.out.take_buffer();
+                frame.append(hex, std::to_chars(hex, hex + sizeof(hex), n, 16).ptr);
+                frame += "\r\n";
+                queued = frame.size() + n + 2;
+                if (n <= OutputQueue::kCoalesceMax) {
+                    frame += s.chunk;
+                    frame += "\r\n";
+                    io.out.append(std::move(frame));
+                } else {
+                    io.out.append(std::move(frame));
+                    io.out.append(std::move(s.chunk));
+                    io.out.append_borrowed("\r\n");
+                }
+            } else {
+                io.out.append(std::move(s.chunk));
+                queued = n;
+            }
+        }
+        if (!more) {
+            if (s.chunked) {
+                io.out.append_borrowed("0\r\n\r\n");
+                queued += 5;
+            }
+            if (tracer_) trace_stream(c, queued, true);
+            wheel_.cancel(s.timer);
+            io.stream.reset();
+            return true;
+        }
+        if (tracer_) trace_stream(c, queued, false);
+        if (n == 0) { // 暂时没有数据（例如 SSE 在等事件）：有 waker 的等它唤醒，否则过一会儿再问
+            if (s.signal && s.signal->pending()) { // 生产者返回前已被唤醒：本轮事件处理完再问
+                stream_ready_.push_back(StreamRef{c.fd, c.gen});
+                return false;
+            }
+            s.waiting = true;
+            if (!s.signal) wheel_.schedule(s.timer, now_ + kStreamRetryMs);
+            return false;
+        }
+        if (budget == 0) { // 配额用完：本轮事件处理完再继续，poll 不等待
+            stream_ready_.push_back(StreamRef{c.fd, c.gen});
+            return false;
+        }
+    }
+    return false;
+}
+
+void EventLoop::stream_wake_sink(void* loop, uint64_t conn, uint32_t stream) {
+    auto* self = static_cast<EventLoop*>(loop);
+    if (tls_loop_ == self) { // 生产者、本 loop 上的回调或协程里唤醒：不经过队列
+        self->on_stream_wake(conn, stream);
+        return;
+    }
+    auto* w   = new StreamWake;
+    w->conn   = conn;
+    w->stream = stream;
+    self->stream_wakes_.push(w);
+    if (!self->wake_pending_.exchange(true)) self->waker_.notify(); // 与工作线程的完成共用一次唤醒
+}
+
+void EventLoop::on_stream_wake(uint64_t conn, uint32_t stream) {
+    const uint32_t gen = static_cast<uint32_t>(conn >> 32) & 0xFFFFFF;
+    Connection*    c   = conns_.find(static_cast<socket_t>(conn & 0xFFFFFFFF));
+    if (!c || c->gen != gen || c->closing) return; // 流已随连接结束
+    if (stream) {
+        if (!c->h2) return;
+        c->h2->session.wake(stream);
+    } else {
+        if (!c->streaming()) return;
+        ResponseStream& s = *c->io->stream;
+        if (!s.waiting) return; // 没在等（例如卡在高水位）：下次拉数据时自然会问到
+        s.waiting = false;
+    }
+    stream_ready_.push_back(StreamRef{c->fd, c->gen}); // 本轮事件处理完再拉，不在唤醒方的调用栈里
+}
+
+void EventLoop::resume_streams() {
+    if (stream_ready_.empty()) return;
+    std::vector<StreamRef> ready;
+    ready.swap(stream_ready_); // 恢复途中可能再次用完配额，追加到新的一轮
+    for (const StreamRef& r : ready) {
+        Connection* c = conns_.find(r.fd);
+        if (c && c->gen == r.gen && !c->closing && (c->streaming() || c->h2)) after_async(*c);
+    }
+}
+
+bool EventLoop::handle_write(Connection& c) {
+    IoSlice iov[kMaxIoSlices];
+    size_t  budget = kStreamBudget;
+    for (;;) {
+        // 流式响应：队列快发空时向生产者要下一批；等在重试定时器上时不问
+        if (c.streaming() && budget > 0 && !c.io->stream->waiting && c.io->out.size() < kStreamLowWater) {
+            if (pump_stream(c, budget) && !process_input(c)) return false; // 流发完：接着处理 pipelined 请求
+        }
+        // HTTP/2：各流待发的响应体按窗口分帧入队
+        if (c.h2 && c.io && budget > 0 && c.io->out.size() < kStreamLowWater) h2_pump(c, budget);
+        if (!c.has_output()) break;
+        ssize_t n;
+        OutputQueue::FileSlice f;
+        if (c.io->out.front_file(f)) {
+            n = socket_sendfile(c.fd, f.fd, f.offset, f.len); // 文件段：内核直接从页缓存发出
+        } else {
+            // 一次 sendmsg 带出多段（响应头、响应体、pipelining 的后续响应）
+            const size_t cnt = c.io->out.gather(iov, kMaxIoSlices);
+            n = socket_sendv(c.fd, iov, cnt); //发送数据
+        }
+        ++stats_.syscalls;
+        //由于当前设置了非阻塞，send可能会返回-1并设置errno为EAGAIN或EWOULDBLOCK，（Windows 下是 WSAEWOULDBLOCK）
+        //表示当前无法发送数据，需要稍后重试
+        //这种情况通常发生在发送缓冲区已满时，应用程序需要等待缓冲区有空间后再尝试发送
+        if (n > 0) {
+            c.io->out.consume(static_cast<size_t>(n)); // 只推进游标 / 释放发完的段，不搬移剩余数据
+            c.last_write = now_;
+            metrics_->bytes_out.add(static_cast<uint64_t>(n));
+            if (tracer_) trace_sent(c, static_cast<size_t>(n));
+            continue;
+        }
+        if (n == 0) return false; // 文件在发送途中被截断
+        const int err = last_sys_err();
+        if (is_would_block(err)) {
+            // 发送缓冲区满，等下次可写
+            // 认为是正常情况，返回true，只是没成功让系统发送出去
+            return true;
+        }
+        // 其他错误
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::run(const std::atomic<bool>& running) {
+    tls_loop_ = this; // 协程的 awaitable 据此找到本 loop
+#ifdef __linux__
+    // ring 的唯一提交者是启用它的线程，只能在这里启用；失败时还没有任何连接，就地换成 poller
+    if (uring_ && !uring_->enable()) {
+        sys_perror("io_uring enable");
+        std::cerr << "falling back to poller backend" << std::endl;
+        uring_.reset();
+        backend_ = Backend::Auto;
+        if (!open_poller()) {
+            close_all();
+            tls_loop_ = nullptr;
+            return;
+        }
+    }
+    if (uring_) run_uring(running);
+    else
+#endif
+    run_poller(running);
+    tls_loop_ = nullptr;
+}
+
+void EventLoop::run_poller(const std::atomic<bool>& running) {
+    std::vector<PollEvent> events;
+    std::vector<socket_t>  to_close;
+    events.reserve(256);
+    to_close.reserve(32);
+
+    while (running) {
+        // 1s 超时，便于可中断 stop() //不设置间隔就无法检查服务器的running状态
+        // 有定时器（连接超时、协程 sleep）时提前到最近的到期时间
+        // 有用完配额的流式响应、要恢复读的连接时不等待，处理完就绪事件马上接着做
+        const int nready = poller_->wait(events, stream_ready_.empty() && read_ready_.empty() ? next_timeout(1000) : 0);
+        ++stats_.syscalls;
+        now_ = now_ms();
+        if (nready < 0) {
+            if (!running) break; // 正在退出
+            sys_perror("poll");
+            continue;
+        }
+
+        // 只遍历就绪的 fd，工作量与就绪数成正比而不是与连接总数成正比
+        bool woken = false;
+        for (const PollEvent& ev : events) {
+            if (ev.fd == listen_fd_) { // 有新连接到来
+                accept_all();
+                continue;
+            }
+            if (ev.fd == waker_.fd()) { // 工作线程交回了响应 / 其他线程发布了广播、唤醒了流
+                waker_.drain();
+                woken = true;
+                continue;
+            }
+            Connection* conn = conns_.find(ev.fd);
+            if (!conn) {
+                if (fd_waits_.count(ev.fd)) ready_fds_.push_back(ev.fd); // 协程在等的 fd
+                continue;
+            }
+            Connection& c = *conn;
+
+            bool ok = true;
+            if (ev.readable || ev.hangup) {
+                ok = handle_read(c);
+            }
+            // 读阶段可能刚生成响应：边沿触发下不会再收到可写通知，所以直接尝试发送
+            if (ok && (ev.writable || c.has_output())) {
+                ok = handle_write(c);
+            }
+            // 短连接：发送完或者标记为不保持连接 -> 关闭（响应还在工作线程上时除外）
+            if (ok && !c.has_output() && !c.keep_alive && !c.async_pending && !c.streaming()) {
+                ok = false; // 标记为关闭
+            }
+
+            if (!ok) {
+                to_close.push_back(ev.fd);
+                continue;
+            }
+            poller_->set_want_write(ev.fd, c.has_output());
+            refresh_timer(c);
+        }
+
+        // 延迟到本批事件处理完再关闭，避免同一批里 fd 被 accept 复用
+        for (socket_t fd : to_close) close_conn(fd);
+        to_close.clear();
+        if (woken) drain_completions(); // 本批事件处理完再收尾，其中关闭的连接按 gen 跳过
+        // 协程的等待点也放到最后恢复：恢复后可能发送 / 关闭连接
+        for (socket_t fd : ready_fds_) {
+            auto w = fd_waits_.find(fd);
+            if (w != fd_waits_.end()) wake_fd_waiter(fd, w->second.seq);
+        }
+        ready_fds_.clear();
+        resume_streams();
+        resume_reads();
+        run_timers();
+        ws_flush(); // 本轮各处入队的 WebSocket 帧（回调、广播）一起发出
+        if (tick_hook_) tick_hook_();
+    } // while (running) 结束
+
+    // 退出清理
+    close_all();
+}
+
+// —— 定时器 ——
+
+uint64_t EventLoop::now_ms() noexcept {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<milliseconds>(Clock::now().time_since_epoch()).count());
+}
+
+uint64_t EventLoop::to_tick(Clock::time_point t) noexcept {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(ceil<milliseconds>(t.time_since_epoch()).count());
+}
+
+int EventLoop::next_timeout(int cap_ms) const {
+    const uint64_t next = wheel_.next_tick();
+    if (next == UINT64_MAX) return cap_ms;
+    const uint64_t now = now_ms();
+    if (next <= now) return 0;
+    return next - now < static_cast<uint64_t>(cap_ms) ? static_cast<int>(next - now) : cap_ms;
+}
+
+void EventLoop::refresh_timer(Connection& c) {
+    if (c.closing) return;
+    using Phase = Connection::Phase;
+    Phase p;
+    const bool partial = c.io && !c.io->inbuf.empty();
+    if (c.has_output())                        p = Phase::Write;
+    else if (c.ws)                             p = Phase::Idle;
+    else if (c.h2)                             p = c.h2->session.receiving() ? Phase::Body // 有流的请求在收
+                                                 : !c.h2->session.idle() ? Phase::Busy     // 都在处理 / 等生产者
+                                                 : partial ? Phase::Header : Phase::Idle;
+    else if (c.read_paused)                    p = Phase::Busy; // 协程没取走请求体：等的是处理函数不是对端
+    else if (c.io && c.io->parser.in_body())   p = Phase::Body; // 包括已启动、在等请求体的协程路由
+    else if (c.async_pending || c.streaming()) p = Phase::Busy; // 流式响应在等生产者：不计超时
+    else if (partial || c.responses == 0)      p = Phase::Header;
+    else                                       p = Phase::Idle;
+    // 没有在途的请求和数据：缓冲、解析器和输出队列还给池
+    if (c.io && !partial && (p == Phase::Idle || p == Phase::Header) && !c.call) return_io(c);
+    if (p != c.phase || c.responses != c.phase_responses) {
+        c.phase           = p;
+        c.phase_since     = now_;
+        c.phase_responses = c.responses;
+    }
+
+    uint64_t d = 0;
+    switch (p) {
+        case Phase::Write:
+            if (timeouts_.write_ms) d = std::max(c.phase_since, c.last_write) + timeouts_.write_ms;
+            break;
+        case Phase::Body:
+            if (timeouts_.body_ms) d = std::max(c.phase_since, c.last_read) + timeouts_.body_ms;
+            break;
+        case Phase::Header:
+            if (timeouts_.header_ms) d = c.phase_since + timeouts_.header_ms;
+            break;
+        case Phase::Idle:
+            if (c.ws) { // WebSocket 不按请求计时：发出 Close 后等对端回应，否则按端点的 idle_ms
+                if (c.ws->close_sent)             d = c.phase_since + WebSocket::kCloseWaitMs;
+                else if (c.ws->handlers->idle_ms) d = std::max(c.phase_since, c.last_read) + c.ws->handlers->idle_ms;
+            } else if (timeouts_.keep_alive_ms) {
+                d = c.phase_since + timeouts_.keep_alive_ms;
+            }
+            break;
+        case Phase::Busy:
+            break;
+    }
+    c.deadline = d;
+    if (d == 0) {
+        wheel_.cancel(c.timer);
+        return;
+    }
+    // 截止时间推后（收发了数据）时不动定时器，到期时再按新的截止时间重挂：
+    // 持续收发的连接每个超时周期最多重挂一次
+    if (!c.timer.linked() || c.timer.expires > d) {
+        c.timer.data = timer_tag(kTimerConn, c);
+        wheel_.schedule(c.timer, d);
+    }
+}
+
+void EventLoop::expire_conn(Connection& c) {
+    refresh_timer(c);
+    if (c.deadline == 0 || c.deadline > now_) return; // 期间有进展，已按新的截止时间重挂
+    wheel_.cancel(c.timer);
+    using Phase = Connection::Phase;
+    // 读请求超时：请求已开始则回 408 再关闭；空闲、没开始发请求或对端不读响应则直接关闭
+    // HTTP/2 没有可以答 408 的请求：一律直接关闭
+    const bool started = !c.h2 && (c.phase == Phase::Body ||
+                                   (c.phase == Phase::Header && c.io && !c.io->inbuf.empty()));
+    const bool reply   = started && !(c.call && c.call->responded);
+    if (reply) {
+        queue_error(c, 408, "Request Timeout");
+    } else {
+        metrics_->idle_closes.add();
+    }
+#ifdef __linux__
+    if (uring_) {
+        if (!reply) uring_close(c);
+        else if (uring_flush(c)) refresh_timer(c);
+        return;
+    }
+#endif
+    if (!reply || !handle_write(c) || !c.has_output()) {
+        close_conn(c.fd);
+        return;
+    }
+    poller_->set_want_write(c.fd, true);
+    refresh_timer(c);
+}
+
+void EventLoop::run_timers() {
+    now_ = now_ms();
+    wheel_.advance(now_);
+    while (TimerNode* n = wheel_.pop_expired()) {
+        const auto     kind = static_cast<TimerKind>(n->data >> 56);
+        const uint32_t gen  = static_cast<uint32_t>(n->data >> 32) & 0xFFFFFF;
+        Connection* conn = conns_.find(static_cast<socket_t>(n->data & 0xFFFFFFFF));
+        if (kind == kTimerH2Call) { // 节点随调用销毁：连接和调用都还在
+            if (!conn || conn->closing || !conn->h2) continue;
+            CoroCall* call = find_h2_call(*conn, gen);
+            if (call && call->wait == CoroCall::Wait::Timer) wake_call(*conn, *call);
+            continue;
+        }
+        if (!conn || conn->gen != gen || conn->closing) continue;
+        Connection& c = *conn;
+        if (kind == kTimerConn) {
+            expire_conn(c);
+        } else if (kind == kTimerStream) { // 流的生产者重试
+            if (c.h2) c.h2->session.retry();
+            if (c.streaming()) c.io->stream->waiting = false;
+            if (c.streaming() || c.h2) after_async(c);
+        } else if (c.call && c.call->wait == CoroCall::Wait::Timer) { // 协程 sleep 到期
+            wake_call(c, *c.call);
+        }
+    }
+}
+
+void EventLoop::accept_all() {
+    for (;;) { // 可能有多个连接同时到来
+        sockaddr_in cli{};
+        socklen_t   len = sizeof(cli);
+        socket_t    cfd = socket_accept(listen_fd_, reinterpret_cast<sockaddr*>(&cli), &len);
+        ++stats_.syscalls;
+        if (!is_valid_socket(cfd)) {
+            const int err = last_sys_err();
+            if (is_would_block(err)) break; // 没有更多可接收的连接
+            sys_perror("accept");
+            break;
+        }
+        set_nonblocking(cfd);
+        stats_.syscalls += 3; // fcntl x2 + epoll_ctl
+        if (!poller_->add(cfd)) { // 例如 select 后端超过 FD_SETSIZE
+            close_socket(cfd);
+            continue;
+        }
+        Connection& c = conns_.emplace(cfd, cfd);
+        metrics_->connections_accepted.add();
+        c.gen = ++next_gen_ & 0xFFFFFF;
+        c.phase_since = now_; // 从连接建立起按请求头超时计
+        refresh_timer(c);
+    }
+}
+
+void EventLoop::close_conn(socket_t fd) {
+    if (Connection* c = conns_.find(fd)) {
+        cancel_call(*c);
+        h2_release(*c);
+        ws_release(*c);
+        return_io(*c);
+        metrics_->connections_closed.add();
+    }
+    poller_->remove(fd);
+    close_socket(fd);
+    conns_.erase(fd);
+    stats_.syscalls += 2;
+}
+
+void EventLoop::close_all() {
+#ifdef __linux__
+    uring_.reset(); // 先销毁 ring，取消所有仍引用连接缓冲区的请求
+#endif
+    conns_.for_each([this](Connection& c) { ws_release(c); }); // WebSocket 的 on_close 恰好一次
+    conns_.for_each([](Connection& c) { close_socket(c.fd); });
+    conns_.clear(); // 挂起的协程帧、定时器随连接销毁；等待登记随 poller / ring 一起作废
+    fd_waits_.clear();
+    ws_flush_.clear();
+    io_pool_.clear();
+    if (is_valid_socket(listen_fd_)) close_socket(listen_fd_);
+    listen_fd_ = kInvalidSocket;
+    poller_.reset();
+}
+
+// —— 请求追踪 ——
+
+void EventLoop::set_tracing(const TraceOptions& opts, unsigned loop_index) {
+    if (opts.sample_every || opts.slow_us) tracer_ = std::make_shared<TraceRing>(opts, loop_index);
+    else                                   tracer_.reset();
+}
+
+uint64_t EventLoop::trace_feed_begin(Connection& c) {
+    ConnIo& io = *c.io;
+    if (!io.trace) io.trace = std::make_unique<ConnTrace>();
+    const uint64_t now = trace_ticks();
+    TraceRecord& r = io.trace->cur;
+    if (r.start == 0) { // 新请求：从带来它第一个字节的那次 recv 算起
+        r.start = io.trace->last_recv ? io.trace->last_recv : now;
+        r.fd    = static_cast<uint32_t>(c.fd);
+        r.flags = tracer_->sample() ? TraceRecord::kSampled : 0;
+    }
+    return now;
+}
+
+void EventLoop::trace_feed_end(Connection& c, uint64_t t0, const http::HttpRequest* complete) {
+    TraceRecord& r = c.io->trace->cur;
+    const uint64_t now = trace_ticks();
+    r.parse_ticks += now - t0;
+    if (!complete) return;
+    r.parsed = now;
+    r.method = static_cast<uint8_t>(complete->method);
+    const size_t n = std::min(complete->path.size(), sizeof(r.path) - 1);
+    std::memcpy(r.path, complete->path.data(), n);
+    r.path[n] = '\0';
+}
+
+void EventLoop::trace_queued(Connection& c, uint64_t routed, uint16_t status, uint64_t bytes, bool open_ended) {
+    if (!c.io->trace) return;
+    ConnTrace& t = *c.io->trace;
+    t.queued += bytes;
+    if (t.cur.start == 0) return; // 没有对应的请求（不会发生，保险）
+    t.cur.routed     = routed;
+    t.cur.serialized = trace_ticks();
+    t.cur.status     = status;
+    t.cur.end_offset = open_ended ? UINT64_MAX : t.queued;
+    t.sending.push_back(t.cur);
+    t.cur = TraceRecord{};
+}
+
+void EventLoop::trace_stream(Connection& c, uint64_t bytes, bool done) {
+    if (!c.io->trace) return;
+    ConnTrace& t = *c.io->trace;
+    t.queued += bytes;
+    if (!done || t.sending.empty() || t.sending.back().end_offset != UINT64_MAX) return;
+    t.sending.back().end_offset = t.queued;
+    trace_sent(c, 0); // 最后一块之前的数据可能已经发完
+}
+
+void EventLoop::trace_sent(Connection& c, size_t n) {
+    if (!c.io || !c.io->trace) return;
+    ConnTrace& t = *c.io->trace;
+    t.sent += n;
+    size_t done = 0;
+    while (done < t.sending.size() && t.sending[done].end_offset <= t.sent) ++done;
+    if (done == 0) return;
+    const uint64_t now = trace_ticks();
+    for (size_t i = 0; i < done; ++i) {
+        t.sending[i].sent = now;
+        tracer_->finish(t.sending[i]);
+    }
+    t.sending.erase(t.sending.begin(), t.sending.begin() + static_cast<std::ptrdiff_t>(done));
+}
+
+// —— 工具方法 ——
+// 本质上就是是写了一个类的成员函数调用命名空间中的全局函数
+void EventLoop::close_socket(socket_t s) noexcept {
+    if (is_valid_socket(s)) {
+        net::close_socket(s);
+    }
+}
+
+bool EventLoop::set_nonblocking(socket_t s) noexcept {
+    return net::set_socket_nonblocking(s);
+}
+
+} // namespace net
@@ -0,0 +1,249 @@
+#include "server/Coroutine.h"
+#include "server/EventLoop.h"
+
+namespace net {
+
+thread_local EventLoop* EventLoop::tls_loop_ = nullptr;
+
+void EventLoop::start_call(Connection& c, std::string_view raw, bool body_pending, const http::HttpRequest& req,
+                           const http::Route& route) {
+    auto call = std::make_unique<CoroCall>();
+    call->fd  = c.fd;
+    call->gen = c.gen;
+    call->timer.data = timer_tag(kTimerCall, c);
+    copy_request(raw, req, call->req, call->raw); // 后到的请求体放进 call->body，raw 不再变
+    call->body_ready = !body_pending;
+    call->stream     = body_pending && route.opts.stream_body;
+    call->route_id   = route.id;
+    call->start      = Clock::now();
+    call->task       = route.async(call->req);
+    c.call          = std::move(call);
+    c.async_pending = true;
+
+    resume_call(*c.call, {}); // 跑到第一个挂起点；不挂起的处理函数在这里就做完了
+    if (c.call->task.done()) complete_call(c);
+}
+
+bool EventLoop::feed_call_body(Connection& c) {
+    CoroCall& call = *c.call;
+    ConnIo&   io   = *c.io;
+    // 请求从 inbuf 开头开始，解析器停在 BODY 状态：Content-Length 只比较长度，chunked 增量解码
+    const auto st = io.parser.feed(io.inbuf);
+    if (st == http::HttpParser::Status::Error) {
+        queue_error(c, 400, "Bad Request");
+        return false;
+    }
+    if (st != http::HttpParser::Status::Complete) {
+        if (io.inbuf.size() > request_limit(io)) queue_error(c, 413, "Payload Too Large");
+        return false;
+    }
+    const std::string_view body = io.parser.request().body;
+    call.body.assign(body.data(), body.size());
+    call.req.body   = call.body;
+    call.body_ready = true;
+    io.inbuf.erase(0, io.parser.consumed());
+    end_request(c);
+
+    wake_body_waiter(c);
+    settle_call(c);
+    return true;
+}
+
+void EventLoop::wake_body_waiter(Connection& c) {
+    CoroCall& call = *c.call;
+    if (call.wait != CoroCall::Wait::Body) return;
+    if (!call.body_ready && call.body_next.empty()) return; // 流式：还没有新的一块
+    call.wait = CoroCall::Wait::None;
+    resume_call(call, std::exchange(call.waiter, {}));
+}
+
+void EventLoop::settle_call(Connection& c) {
+    CoroCall& call = *c.call;
+    if (!call.responded && call.task.done()) {
+        complete_call(c); // 请求体已收齐时连接随即空闲
+    } else if (call.responded && call.body_ready) { // 处理函数没等请求体就答复了：这里才算整个请求结束
+        c.call.reset();
+        c.async_pending = false;
+    }
+}
+
+void EventLoop::resume_call(CoroCall& call, std::coroutine_handle<> h) {
+    CoroCall* prev = std::exchange(current_, &call);
+    if (h) h.resume();
+    else   call.task.resume();
+    current_ = prev;
+}
+
+void EventLoop::wake_call(Connection& c, CoroCall& call) {
+    call.wait = CoroCall::Wait::None;
+    resume_call(call, std::exchange(call.waiter, {}));
+    if (!call.task.done()) return;
+    if (call.h2_stream) complete_h2_call(c, call);
+    else                complete_call(c);
+    after_async(c);
+}
+
+http::HttpResponse EventLoop::call_response(CoroCall& call) {
+    http::HttpResponse resp;
+    if (call.task.failed()) { // 处理函数抛了异常
+        resp.status = 500;
+        resp.reason = "Internal Server Error";
+        resp.body   = "Internal Server Error";
+        resp.set_content_type("text/plain; charset=utf-8");
+    } else {
+        resp = call.task.result();
+        router_->finish(call.req, resp);
+    }
+    return resp;
+}
+
+void EventLoop::complete_call(Connection& c) {
+    CoroCall& call = *c.call;
+    http::HttpResponse resp = call_response(call);
+    resp.set_keep_alive(c.keep_alive);
+    queue_response(c, resp, &call.req);
+    ++stats_.requests;
+    observe(call.route_id, resp.status, call.start);
+    call.responded = true;
+    if (call.body_ready) {
+        c.call.reset();
+        c.async_pending = false;
+    } else if (call.stream) { // 没取完流式请求体就答复了：剩下的收下丢弃，暂停的读要恢复
+        std::string().swap(call.body_next);
+        resume_read(c);
+    }
+}
+
+void EventLoop::cancel_call(Connection& c) {
+    if (!c.call) return;
+    cancel_wait(*c.call);
+    c.call.reset();
+}
+
+void EventLoop::cancel_wait(CoroCall& call) {
+    if (call.wait != CoroCall::Wait::Fd) return;
+    // 先撤销登记再销毁协程帧：帧里的对象可能正拥有并关闭这个 fd
+    fd_waits_.erase(call.wait_fd);
+#ifdef __linux__
+    if (uring_) uring_cancel_fd_wait(call.wait_fd, call.wait_seq);
+    else
+#endif
+    poller_->remove(call.wait_fd);
+    call.wait = CoroCall::Wait::None;
+}
+
+void EventLoop::wake_fd_waiter(socket_t fd, uint32_t seq) {
+    auto w = fd_waits_.find(fd);
+    if (w == fd_waits_.end() || w->second.seq != seq) return; // 已撤销，或是上一次等待的迟到事件
+    const FdWait wait = w->second;
+    fd_waits_.erase(w);
+    if (poller_) poller_->remove(fd); // io_uring 的 POLL_ADD 是一次性的，不用撤
+    Connection* c = conns_.find(wait.conn);
+    if (!c || c->gen != wait.gen) return;
+    if (wait.stream) { // HTTP/2 的流：流可能已被撤销
+        if (!c->h2) return;
+        auto it = c->h2->calls.find(wait.stream);
+        if (it != c->h2->calls.end()) wake_call(*c, *it->second);
+        return;
+    }
+    if (c->call) wake_call(*c, *c->call);
+}
+
+bool EventLoop::suspend_until(Clock::time_point t, std::coroutine_handle<> h) {
+    EventLoop* loop = tls_loop_;
+    if (!loop || !loop->current_) return false;
+    CoroCall& call = *loop->current_;
+    call.wait   = CoroCall::Wait::Timer;
+    call.waiter = h;
+    loop->wheel_.schedule(call.timer, to_tick(t));
+    return true;
+}
+
+bool EventLoop::suspend_on_fd(socket_t fd, bool write, std::coroutine_handle<> h) {
+    EventLoop* loop = tls_loop_;
+    if (!loop || !loop->current_ || loop->fd_waits_.count(fd) || loop->conns_.contains(fd)) return false;
+    CoroCall& call = *loop->current_;
+    const uint32_t seq = ++loop->next_seq_ & 0xFFFFFF; // io_uring 的 user_data 里只有 24 位
+#ifdef __linux__
+    if (loop->uring_) {
+        if (!loop->uring_arm_fd_wait(fd, write, seq)) return false;
+    } else
+#endif
+    if (!loop->poller_->watch(fd, write)) {
+        return false;
+    }
+    loop->fd_waits_.emplace(fd, FdWait{call.fd, call.gen, seq, call.h2_stream});
+    call.wait     = CoroCall::Wait::Fd;
+    call.wait_fd  = fd;
+    call.wait_seq = seq;
+    call.waiter   = h;
+    return true;
+}
+
+bool EventLoop::suspend_on_body(std::coroutine_handle<> h, bool chunk) {
+    EventLoop* loop = tls_loop_;
+    if (!loop || !loop->current_) return false;
+    CoroCall& call = *loop->current_;
+    // 流式请求体不会整个收在内存里：request_body 不等，返回空
+    if (call.body_ready || (call.stream && (!chunk || !call.body_next.empty()))) return false;
+    call.wait   = CoroCall::Wait::Body;
+    call.waiter = h;
+    return true;
+}
+
+bool EventLoop::take_body_chunk(std::string_view& out) {
+    out = {};
+    EventLoop* loop = tls_loop_;
+    if (!loop || !loop->current_) return true; // 不在 loop 上：没有可取的
+    CoroCall& call = *loop->current_;
+    if (!call.stream) { // 整个请求体作为一块
+        if (!call.body_ready) return false;
+        if (!std::exchange(call.body_taken, true)) out = call.req.body;
+        return true;
+    }
+    if (call.body_next.empty()) return call.body_ready; // 收齐且取完：空块表示结束
+    // 两个缓冲轮换：交出的一块到下次取之前有效，新数据接着攒进另一个
+    call.body.swap(call.body_next);
+    call.body_next.clear();
+    out = call.body;
+    Connection* c = loop->conns_.find(call.fd);
+    if (c && c->gen == call.gen) loop->resume_read(*c);
+    return true;
+}
+
+// —— 协程版的 socket 操作：先直接做，EAGAIN 时挂起等就绪 ——
+
+http::Task<ssize_t> async_recv(socket_t fd, char* buf, size_t len) {
+    for (;;) {
+        const ssize_t n = socket_recv(fd, buf, len);
+        if (n >= 0 || !is_would_block(last_sys_err())) co_return n;
+        if (!co_await readable(fd)) co_return -1;
+    }
+}
+
+http::Task<ssize_t> async_send(socket_t fd, const char* data, size_t len) {
+    size_t sent = 0;
+    while (sent < len) {
+        const IoSlice slice{data + sent, len - sent};
+        const ssize_t n = socket_sendv(fd, &slice, 1); // 与连接一样不触发 SIGPIPE
+        if (n > 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && is_would_block(last_sys_err())) {
+            if (!co_await writable(fd)) co_return -1;
+            continue;
+        }
+        co_return -1;
+    }
+    co_return static_cast<ssize_t>(sent);
+}
+
+http::Task<bool> async_connect(socket_t fd, const sockaddr* addr, socklen_t len) {
+    const int r = socket_connect(fd, addr, len);
+    if (r <= 0) co_return r == 0;
+    if (!co_await writable(fd)) co_return false;
+    co_return socket_error(fd) == 0;
+}
+
+} // namespace net
@@ -0,0 +1,167 @@
+#include "server/EventLoop.h"
+
+namespace net {
+
+// —— HTTP/2（h2c）：帧和流的状态在 H2Session 里，这里把收齐的流交给路由、把响应交回会话 ——
+
+bool EventLoop::h2_start(Connection& c) {
+    c.h2 = std::make_unique<H2Conn>([this](http::HttpRequest& req) { return body_limit(req); });
+    c.h2->retry.data = timer_tag(kTimerStream, c);
+    metrics_->h2_connections.add();
+    set_socket_nodelay(c.fd); // 帧头与文件段是分开的两次发送
+    ++stats_.syscalls;
+    c.h2->session.start(borrow_io(c).out);
+    return h2_input(c);
+}
+
+bool EventLoop::h2_upgrade(Connection& c, std::string_view raw, const http::HttpRequest& req) {
+    // 边收边处理的请求体（流式 / 落盘）不在内存里，这样的请求照常按 HTTP/1.1 答复
+    if (req.version != "HTTP/1.1" || c.io->body || c.call || !http::has_token(req.header("Upgrade"), "h2c")) return false;
+    auto h2 = std::make_unique<H2Conn>([this](http::HttpRequest& r) { return body_limit(r); });
+    if (!h2->session.upgrade(req.header("HTTP2-Settings"))) return false;
+    c.h2 = std::move(h2);
+    c.h2->retry.data = timer_tag(kTimerStream, c);
+    metrics_->h2_connections.add();
+    set_socket_nodelay(c.fd); // 帧头与文件段是分开的两次发送
+    ++stats_.syscalls;
+
+    OutputQueue& out = c.io->out;
+    out.append_borrowed("HTTP/1.1 101 Switching Protocols\r\nConnection: Upgrade\r\nUpgrade: h2c\r\n\r\n");
+    c.h2->session.start(out);
+    // 这个请求就是流 1：请求字节拷进流里，inbuf 随后交给会话
+    H2Stream& s = *c.h2->session.find(1);
+    copy_request(raw, req, s.req, s.raw);
+    s.req.version = "HTTP/2";
+    h2_dispatch(c, s);
+    return true;
+}
+
+bool EventLoop::h2_input(Connection& c) {
+    H2Conn& h  = *c.h2;
+    ConnIo& io = borrow_io(c);
+    if (!io.inbuf.empty()) io.inbuf.erase(0, h.session.feed(io.inbuf, io.out)); // 不完整的帧留到下次
+    uint32_t id = 0;
+    while (h.session.pop_reset(id)) h2_cancel(c, id);
+    while (h.session.pop_ready(id)) {
+        if (H2Stream* s = h.session.find(id)) h2_dispatch(c, *s);
+    }
+    // 对端的 WINDOW_UPDATE 可能让等着的响应体又能发了
+    size_t budget = kStreamBudget;
+    h2_pump(c, budget);
+    return true;
+}
+
+void EventLoop::h2_dispatch(Connection& c, H2Stream& s) {
+    const uint32_t id        = s.id;
+    const bool     head_only = s.req.method == http::Method::HEAD;
+    if (s.reject) { // 请求体 / 请求头超限：不交给处理函数
+        http::HttpResponse resp;
+        resp.status = s.reject;
+        resp.reason = s.reject == 413 ? "Payload Too Large" : "Request Header Fields Too Large";
+        resp.body   = resp.reason;
+        resp.set_content_type("text/plain; charset=utf-8");
+        if (s.reject == 413) metrics_->too_large.add();
+        h2_respond(c, id, resp, head_only);
+        return;
+    }
+
+    // 上一个同步响应已编码进输出队列，arena 整块回卷（同 HTTP/1.1）
+    ConnIo& io = borrow_io(c);
+    io.arena.rewind();
+    http::HttpResponse resp(&io.arena);
+    using Dispatch = http::Router::Dispatch;
+    const http::Route* route   = nullptr;
+    const auto         start   = Clock::now();
+    bool               builtin = false;
+    const auto         d       = route_request(s.req, resp, route, builtin);
+    if (d == Dispatch::Deferred) {
+        submit_job(c, s.raw, s.req, *route, std::move(resp), start, id);
+        return;
+    }
+    if (d == Dispatch::Coroutine) {
+        start_h2_call(c, s, *route);
+        return;
+    }
+    if (d == Dispatch::NotFound) {
+        resp.status = 404;
+        resp.reason = "Not Found";
+        resp.body   = "Not Found";
+        resp.set_content_type("text/plain; charset=utf-8");
+    }
+    h2_respond(c, id, resp, head_only);
+    ++stats_.requests;
+    if (!builtin) observe(route_id(route), resp.status, start);
+}
+
+void EventLoop::h2_respond(Connection& c, uint32_t stream, http::HttpResponse& resp, bool head_only) {
+    H2Stream* s = c.h2->session.find(stream);
+    if (!s) return; // 处理期间被对端撤销，或连接出错已关掉所有流
+    ++c.responses;
+    metrics_->requests.add();
+    metrics_->count_status(resp.status);
+    c.h2->session.respond(*s, resp, head_only, borrow_io(c).out);
+    // 流式响应体的 waker：流还在（有响应体要发）才绑定，流结束时 H2Stream 解绑
+    if (H2Stream* t = c.h2->session.find(stream); t && t->signal)
+        t->signal->bind(&EventLoop::stream_wake_sink, this, timer_tag(kTimerStream, c), stream);
+}
+
+void EventLoop::h2_pump(Connection& c, size_t& budget) {
+    H2Conn& h = *c.h2;
+    h.session.pump(borrow_io(c).out, kStreamHighWater, budget);
+    // 有生产者暂时没有数据：过一会儿再问；配额用完：本轮事件处理完接着发
+    if (h.session.waiting() && !h.retry.linked()) wheel_.schedule(h.retry, now_ + kStreamRetryMs);
+    if (budget == 0 && h.session.sendable()) stream_ready_.push_back(StreamRef{c.fd, c.gen});
+    if (h.session.closed()) c.keep_alive = false; // 输出发完即关闭
+}
+
+void EventLoop::start_h2_call(Connection& c, H2Stream& s, const http::Route& route) {
+    auto call = std::make_unique<CoroCall>();
+    call->fd        = c.fd;
+    call->gen       = c.gen;
+    call->h2_stream = s.id;
+    const uint32_t seq = ++c.h2->next_call & 0xFFFFFF;
+    call->timer.data = (static_cast<uint64_t>(kTimerH2Call) << 56) | (static_cast<uint64_t>(seq) << 32) |
+                       static_cast<uint32_t>(c.fd);
+    copy_request(s.raw, s.req, call->req, call->raw); // 请求已收齐
+    call->body_ready = true;
+    call->route_id   = route.id;
+    call->start      = Clock::now();
+    call->task       = route.async(call->req);
+    CoroCall& ref = *call;
+    c.h2->calls[s.id] = std::move(call);
+
+    resume_call(ref, {});
+    if (ref.task.done()) complete_h2_call(c, ref);
+}
+
+void EventLoop::complete_h2_call(Connection& c, CoroCall& call) {
+    http::HttpResponse resp = call_response(call);
+    const uint32_t     id   = call.h2_stream;
+    h2_respond(c, id, resp, call.req.method == http::Method::HEAD);
+    ++stats_.requests;
+    observe(call.route_id, resp.status, call.start);
+    c.h2->calls.erase(id); // call 此后失效
+}
+
+CoroCall* EventLoop::find_h2_call(Connection& c, uint32_t seq) noexcept {
+    for (auto& [id, call] : c.h2->calls) {
+        if ((static_cast<uint32_t>(call->timer.data >> 32) & 0xFFFFFF) == seq) return call.get();
+    }
+    return nullptr;
+}
+
+void EventLoop::h2_cancel(Connection& c, uint32_t stream) {
+    // 同步路由早已答复；工作线程上的请求回来时找不到流，响应直接丢弃
+    auto it = c.h2->calls.find(stream);
+    if (it == c.h2->calls.end()) return;
+    cancel_wait(*it->second);
+    c.h2->calls.erase(it);
+}
+
+void EventLoop::h2_release(Connection& c) {
+    if (!c.h2) return;
+    for (auto& [id, call] : c.h2->calls) cancel_wait(*call);
+    c.h2->calls.clear();
+}
+
+} // namespace net
@@ -0,0 +1,316 @@
+#ifdef __linux__
+#include "server/EventLoop.h"
+
+#include <cstdio>
+#include <iostream>
+#include <poll.h>
+#include <sys/utsname.h>
+
+namespace net {
+
+namespace {
+
+// user_data 布局：op(8) | gen(24) | fd(32)
+// kOpFdWait 的 gen 字段放的是协程等待的编号
+enum UringOp : uint64_t {
+    kOpAccept = 1, kOpRecv = 2, kOpSend = 3, kOpCancel = 4, kOpPollOut = 5, kOpWake = 6, kOpFdWait = 7
+};
+
+constexpr uint16_t kBufGroup   = 0;
+constexpr unsigned kRingSize   = 4096;
+constexpr unsigned kNumBufs    = 1024;     // 2 的幂
+constexpr unsigned kBufSize    = 8192;
+
+uint64_t pack(UringOp op, uint32_t gen, socket_t fd) {
+    return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(gen & 0xFFFFFF) << 32) |
+           static_cast<uint32_t>(fd);
+}
+
+// 多发 recv 需要 6.0+，多发 accept 与 buffer ring 需要 5.19+
+bool kernel_at_least(int major, int minor) {
+    utsname u{};
+    if (::uname(&u) != 0) return false;
+    int ma = 0, mi = 0;
+    if (std::sscanf(u.release, "%d.%d", &ma, &mi) != 2) return false;
+    return ma > major || (ma == major && mi >= minor);
+}
+
+} // namespace
+
+bool EventLoop::open_uring() {
+    if (!kernel_at_least(6, 0)) return false;
+    auto ring = std::make_unique<IoUring>();
+    if (!ring->init(kRingSize)) return false;
+    if (!ring->setup_buf_ring(kBufGroup, kNumBufs, kBufSize)) return false;
+    uring_ = std::move(ring);
+    return true;
+}
+
+void EventLoop::uring_arm_accept() {
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return;
+    sqe->opcode    = IORING_OP_ACCEPT;
+    sqe->fd        = listen_fd_;
+    sqe->ioprio    = IORING_ACCEPT_MULTISHOT; // 一次提交，持续产生新连接
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC; // 文件段要在 socket 上直接调用 sendfile
+    sqe->user_data = pack(kOpAccept, 0, listen_fd_);
+}
+
+// 读 eventfd：工作线程交回响应时完成，读走计数的同时就清除了可读状态
+void EventLoop::uring_arm_wake() {
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return;
+    sqe->opcode    = IORING_OP_READ;
+    sqe->fd        = waker_.fd();
+    sqe->addr      = reinterpret_cast<uint64_t>(&wake_buf_);
+    sqe->len       = sizeof(wake_buf_);
+    sqe->user_data = pack(kOpWake, 0, waker_.fd());
+}
+
+// 协程等待其他 fd：一次性的 POLL_ADD，完成时按 fd + 编号找回等待者
+bool EventLoop::uring_arm_fd_wait(socket_t fd, bool write, uint32_t seq) {
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return false;
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+    sqe->poll32_events = write ? POLLOUT : POLLIN;
+    sqe->user_data     = pack(kOpFdWait, seq, fd);
+    return true;
+}
+
+// 等待者已不在（连接关闭）：撤掉 POLL_ADD，之后即使完成也会因登记已删除而被忽略
+void EventLoop::uring_cancel_fd_wait(socket_t fd, uint32_t seq) {
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return;
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->addr      = pack(kOpFdWait, seq, fd);
+    sqe->user_data = pack(kOpCancel, 0, fd);
+}
+
+void EventLoop::uring_arm_recv(Connection& c) {
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) { uring_close(c); return; }
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = c.fd;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT; // 数据落到 buffer ring，由内核挑缓冲区
+    sqe->buf_group = kBufGroup;
+    sqe->user_data = pack(kOpRecv, c.gen, c.fd);
+    c.recv_armed = true;
+    ++c.ops_inflight;
+}
+
+// 流式请求体积压：撤掉多发 recv，撤销完成前已在路上的数据照常收下
+void EventLoop::uring_pause_recv(Connection& c) {
+    if (!c.recv_armed) return;
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return; // 撤不掉就继续收，只是多占些内存
+    sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+    sqe->addr      = pack(kOpRecv, c.gen, c.fd);
+    sqe->user_data = pack(kOpCancel, 0, c.fd);
+}
+
+bool EventLoop::uring_flush(Connection& c) {
+    if (c.send_inflight || c.closing) return true;
+    size_t budget = kStreamBudget;
+    OutputQueue::FileSlice f;
+    for (;;) {
+        while (c.streaming() && budget > 0 && !c.io->stream->waiting && c.io->out.size() < kStreamLowWater) {
+            if (!pump_stream(c, budget)) break;
+            if (!process_input(c)) return uring_close(c); // 流发完：接着处理 pipelined 请求，可能又是一个流
+        }
+        if (c.h2 && c.io && budget > 0 && c.io->out.size() < kStreamLowWater) h2_pump(c, budget);
+        // 文件段：io_uring 没有 sendfile，直接在非阻塞 socket 上调用 sendfile；
+        // 发送缓冲区满时挂一个 POLL_ADD(POLLOUT)，可写后再继续
+        while (c.has_output() && c.io->out.front_file(f)) {
+            const ssize_t n = socket_sendfile(c.fd, f.fd, f.offset, f.len);
+            ++stats_.syscalls;
+            if (n > 0) {
+                c.io->out.consume(static_cast<size_t>(n));
+                c.last_write = now_;
+                metrics_->bytes_out.add(static_cast<uint64_t>(n));
+                if (tracer_) trace_sent(c, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && is_would_block(last_sys_err())) {
+                io_uring_sqe* sqe = uring_->get_sqe();
+                if (!sqe) return uring_close(c);
+                sqe->opcode        = IORING_OP_POLL_ADD;
+                sqe->fd            = c.fd;
+                sqe->poll32_events = POLLOUT;
+                sqe->user_data     = pack(kOpPollOut, c.gen, c.fd);
+                c.send_inflight = true;
+                ++c.ops_inflight;
+                return true;
+            }
+            return uring_close(c); // 出错或文件被截断
+        }
+        // 文件段发完、队列空了：HTTP/2 还有窗口之内的响应体，再入队一批
+        if (c.has_output() || !c.h2 || budget == 0 || !c.h2->session.sendable()) break;
+    }
+    if (!c.has_output()) {
+        if (!c.keep_alive && !c.async_pending && !c.streaming()) return uring_close(c); // 短连接：发送完即关闭
+        return true;
+    }
+    // 队列里的段直接交给内核（SENDMSG），发送期间锁定这些段；
+    // 新响应继续追加到队尾，下次完成时再一起发出
+    UringSend& s = c.io->send;
+    IoSlice slices[UringSend::kMaxIov];
+    const size_t cnt = c.io->out.gather(slices, UringSend::kMaxIov);
+    for (size_t i = 0; i < cnt; ++i) {
+        s.iov[i].iov_base = const_cast<char*>(slices[i].data);
+        s.iov[i].iov_len  = slices[i].len;
+    }
+    s.msg            = msghdr{};
+    s.msg.msg_iov    = s.iov;
+    s.msg.msg_iovlen = cnt;
+
+    io_uring_sqe* sqe = uring_->get_sqe();
+    if (!sqe) return uring_close(c);
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = c.fd;
+    sqe->addr      = reinterpret_cast<uint64_t>(&s.msg);
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = pack(kOpSend, c.gen, c.fd);
+    c.io->out.pin(cnt);
+    c.send_inflight = true;
+    ++c.ops_inflight;
+    return true;
+}
+
+bool EventLoop::uring_close(Connection& c) {
+    if (!c.closing) {
+        c.closing = true;
+        wheel_.cancel(c.timer);
+        cancel_call(c);
+        h2_release(c);
+        ws_release(c);
+        if (c.ops_inflight > 0) {
+            // 取消该 fd 上的所有请求；等它们的 CQE 都回来后再释放连接
+            if (io_uring_sqe* sqe = uring_->get_sqe()) {
+                sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+                sqe->fd           = c.fd;
+                sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+                sqe->user_data    = pack(kOpCancel, c.gen, c.fd);
+            }
+        }
+    }
+    if (c.ops_inflight == 0) {
+        const socket_t fd = c.fd;
+        close_socket(fd);
+        ++stats_.syscalls;
+        return_io(c);
+        metrics_->connections_closed.add();
+        conns_.erase(fd); // c 此后失效
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::uring_on_cqe(const io_uring_cqe& cqe) {
+    const auto     op  = static_cast<UringOp>(cqe.user_data >> 56);
+    const uint32_t gen = static_cast<uint32_t>(cqe.user_data >> 32) & 0xFFFFFF;
+    const auto     fd  = static_cast<socket_t>(cqe.user_data & 0xFFFFFFFF);
+    const bool     more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    if (op == kOpAccept) {
+        if (cqe.res >= 0) {
+            // 旧连接在所有请求完成前不会 close，所以同一 fd 不会还留在表里
+            Connection& c = conns_.emplace(cqe.res, cqe.res);
+            metrics_->connections_accepted.add();
+            c.gen = ++next_gen_ & 0xFFFFFF;
+            c.phase_since = now_;
+            refresh_timer(c);
+            uring_arm_recv(c);
+        } else if (cqe.res != -EAGAIN && cqe.res != -ECANCELED) {
+            std::cerr << "accept: " << -cqe.res << std::endl;
+        }
+        if (!more) uring_arm_accept(); // 多发 accept 被内核终止时重新挂上
+        return;
+    }
+    if (op == kOpCancel) return;
+    if (op == kOpWake) {
+        drain_completions();
+        uring_arm_wake();
+        return;
+    }
+    if (op == kOpFdWait) {
+        wake_fd_waiter(fd, gen);
+        return;
+    }
+
+    Connection* c = conns_.find(fd);
+    if (c && c->gen != gen) c = nullptr;
+
+    if (op == kOpRecv) {
+        const bool has_buf = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        const auto bid     = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        if (c && cqe.res > 0 && !c->closing) {
+            c->last_read = now_;
+            metrics_->bytes_in.add(static_cast<uint64_t>(cqe.res));
+            borrow_io(*c).inbuf.append(uring_->buf(bid), static_cast<size_t>(cqe.res));
+            if (tracer_) {
+                if (!c->io->trace) c->io->trace = std::make_unique<ConnTrace>();
+                c->io->trace->last_recv = trace_ticks();
+            }
+        }
+        if (has_buf) uring_->recycle_buf(bid); // 拷进 inbuf 后立刻归还给内核
+        if (!c) return;
+        if (!more) { c->recv_armed = false; --c->ops_inflight; }
+
+        if (c->closing) { uring_close(*c); return; }
+        // -ECANCELED：暂停读时撤掉的 recv（关闭引起的上面已处理）
+        if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -ECANCELED)) { uring_close(*c); return; }
+        if (cqe.res > 0) {
+            if (!process_input(*c)) { uring_close(*c); return; }
+            if (!uring_flush(*c) || c->closing) return; // flush 里可能已经关闭并释放
+        }
+        refresh_timer(*c);
+        // buffer ring 暂时耗尽或内核终止了多发：重新挂上；暂停读时由 resume_reads 挂
+        if (!c->recv_armed && !c->read_paused) uring_arm_recv(*c);
+        return;
+    }
+
+    if (op == kOpSend || op == kOpPollOut) {
+        if (!c) return;
+        --c->ops_inflight;
+        c->send_inflight = false;
+        c->io->out.unpin();
+        if (c->closing || cqe.res < 0) { uring_close(*c); return; }
+        if (op == kOpSend) {
+            c->io->out.consume(static_cast<size_t>(cqe.res));
+            if (cqe.res > 0) c->last_write = now_;
+            metrics_->bytes_out.add(static_cast<uint64_t>(cqe.res));
+            if (tracer_ && cqe.res > 0) trace_sent(*c, static_cast<size_t>(cqe.res));
+        }
+        // 部分发送则续发剩余部分，以及发送期间新入队的响应
+        if (uring_flush(*c)) refresh_timer(*c);
+    }
+}
+
+void EventLoop::run_uring(const std::atomic<bool>& running) {
+    uring_arm_accept();
+    uring_arm_wake();
+    while (running) {
+        // 本轮所有新 SQE（recv 重挂、send）在这里一次提交，同时等待完成事件
+        const int ret = uring_->submit_and_wait(stream_ready_.empty() && read_ready_.empty() ? next_timeout(1000) : 0);
+        now_ = now_ms();
+        if (ret < 0) {
+            if (!running) break;
+            sys_perror("io_uring_enter");
+            continue;
+        }
+        uring_->drain_cqes([this](const io_uring_cqe& cqe) { uring_on_cqe(cqe); });
+        resume_streams();
+        resume_reads();
+        run_timers();
+        ws_flush();
+        if (tick_hook_) tick_hook_();
+    }
+    stats_.syscalls += uring_->enter_calls();
+    close_all();
+}
+
+} // namespace net
+#endif
@@ -0,0 +1,342 @@
+#include "server/EventLoop.h"
+
+#include <algorithm>
+
+namespace net {
+
+// —— WebSocket：升级握手、帧的收发，以及频道广播在各 loop 上的分发 ——
+
+namespace {
+
+// 其他线程发布到本 loop 的广播：帧已序列化好，由本 loop 线程分发给自己的订阅者
+struct WsPost final : MpscNode {
+    WsChannel*                         channel{nullptr};
+    std::shared_ptr<const std::string> frame;
+};
+
+} // namespace
+
+bool EventLoop::ws_upgrade(Connection& c, const http::HttpRequest& req) {
+    if (req.method != http::Method::GET || !http::has_token(req.header("Upgrade"), "websocket")) return false;
+    const WsRoute* route = nullptr;
+    for (const WsRoute& r : ws_routes_) {
+        if (req.path == r.path) {
+            route = &r;
+            break;
+        }
+    }
+    if (!route) return false;
+
+    const std::string_view key = req.header("Sec-WebSocket-Key");
+    if (req.version != "HTTP/1.1" || !http::has_token(req.header("Connection"), "upgrade") || key.size() != 24) {
+        queue_error(c, 400, "Bad Request");
+        return true;
+    }
+    if (req.header("Sec-WebSocket-Version") != "13") { // 带上支持的版本，客户端可以据此重试
+        http::HttpResponse resp;
+        resp.status = 426;
+        resp.reason = "Upgrade Required";
+        resp.body   = resp.reason;
+        resp.set_content_type("text/plain; charset=utf-8");
+        resp.set_header("Sec-WebSocket-Version", "13");
+        resp.set_keep_alive(false);
+        queue_response(c, resp);
+        c.keep_alive = false;
+        c.io->inbuf.clear();
+        end_request(c);
+        return true;
+    }
+
+    const WsHandlers& h = *route->handlers;
+    std::string_view protocol; // 按端点的顺序取第一个客户端也提供的子协议
+    if (!h.protocols.empty()) {
+        const std::string_view offered = req.header("Sec-WebSocket-Protocol");
+        for (const std::string& p : h.protocols) {
+            if (http::has_token(offered, p)) {
+                protocol = p;
+                break;
+            }
+        }
+    }
+    OutputQueue& out  = c.io->out;
+    std::string  head = out.take_buffer();
+    head += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: ";
+    head += http::ws_accept_key(key);
+    if (!protocol.empty()) {
+        head += "\r\nSec-WebSocket-Protocol: ";
+        head += protocol;
+    }
+    head += "\r\n\r\n";
+    out.append(std::move(head));
+    ++c.responses;
+    ++stats_.requests;
+    metrics_->requests.add();
+    metrics_->count_status(101);
+    metrics_->ws_connections.add();
+
+    c.keep_alive = true;
+    c.ws = std::make_unique<WsConn>(WebSocket(this, c.fd, c.gen), route->handlers);
+    set_socket_nodelay(c.fd); // 实时消息多是小帧，不等 Nagle 攒包
+    ++stats_.syscalls;
+    if (h.on_open) h.on_open(c.ws->socket, req); // req 的视图还指向 inbuf，调用方随后才移走
+    return true;
+}
+
+bool EventLoop::ws_input(Connection& c) {
+    WsConn& w  = *c.ws;
+    ConnIo& io = borrow_io(c);
+    if (!c.keep_alive) { // 关闭握手已完成或出了错：之后到达的数据一律丢弃，只等输出发完
+        io.inbuf.clear();
+        return true;
+    }
+    using Kind = http::WsEvent::Kind;
+    size_t off = 0;
+    while (off < io.inbuf.size()) {
+        http::WsEvent ev;
+        off += w.parser.parse(io.inbuf.data() + off, io.inbuf.size() - off, ev);
+        if (ev.kind == Kind::None) break; // 帧还没收全，留在 inbuf 里
+        switch (ev.kind) {
+            case Kind::Message:
+                metrics_->ws_messages_in.add();
+                // 已发出 Close 后对端还在途中的消息不再交出（RFC 6455 7.1.1 之后只等对端的 Close）
+                if (!w.close_sent && w.handlers->on_message) w.handlers->on_message(w.socket, ev.data, ev.binary);
+                break;
+            case Kind::Ping:
+                if (!w.close_sent) ws_send(c, http::WsOpcode::Pong, ev.data);
+                break;
+            case Kind::Pong:
+                break;
+            default: // Close / Error：回同样的码（或发出错误码），发完即断开
+                if (!w.close_sent) {
+                    ws_close(c, ev.kind == Kind::Close && ev.code == http::kWsCloseNoStatus ? 0 : ev.code, {});
+                }
+                ws_finish(c, ev.code);
+                c.keep_alive = false;
+                io.inbuf.clear();
+                return true;
+        }
+    }
+    if (off > 0) io.inbuf.erase(0, off);
+    return true;
+}
+
+Connection* EventLoop::ws_conn(const WebSocket& s) noexcept {
+    Connection* c = conns_.find(s.fd_);
+    return c && c->gen == s.gen_ && c->ws && !c->closing ? c : nullptr;
+}
+
+void EventLoop::ws_send(Connection& c, http::WsOpcode op, std::string_view payload) {
+    if (c.ws->close_sent) return;
+    std::string frame = borrow_io(c).out.take_buffer();
+    http::ws_frame(op, payload, frame);
+    ws_queue(c, std::move(frame));
+}
+
+void EventLoop::ws_queue(Connection& c, std::string frame) {
+    if (c.ws->overflow) return;
+    borrow_io(c).out.append(std::move(frame)); // 小帧并进上一段，大帧移进队列不拷贝
+    ws_queued(c);
+}
+
+void EventLoop::ws_queue(Connection& c, const std::shared_ptr<const std::string>& frame) {
+    if (c.ws->overflow) return;
+    borrow_io(c).out.append_shared(frame); // 所有订阅者引用同一块缓冲
+    ws_queued(c);
+}
+
+void EventLoop::ws_queued(Connection& c) {
+    WsConn& w = *c.ws;
+    metrics_->ws_frames_out.add();
+    if (c.io->out.size() > w.handlers->max_backlog) w.overflow = true;
+    if (!w.flush_pending) {
+        w.flush_pending = true;
+        ws_flush_.push_back(StreamRef{c.fd, c.gen});
+    }
+}
+
+void EventLoop::ws_close(Connection& c, uint16_t code, std::string_view reason) {
+    if (c.ws->close_sent) return;
+    std::string frame = borrow_io(c).out.take_buffer();
+    http::ws_close_frame(code, reason, frame);
+    ws_queue(c, std::move(frame));
+    c.ws->close_sent = true;
+}
+
+void EventLoop::ws_finish(Connection& c, uint16_t code) {
+    WsConn& w = *c.ws;
+    if (w.finished) return;
+    w.finished   = true;
+    w.close_sent = true; // on_close 里的发送一律忽略
+    if (w.handlers->on_close) w.handlers->on_close(w.socket, code);
+    // 订阅表里的条目留到下次分发时清掉
+    for (WsChannel* ch : w.channels) {
+        ch->count_.fetch_sub(1, std::memory_order_relaxed);
+        ++ws_subs_[ch].dead;
+    }
+    w.channels.clear();
+}
+
+void EventLoop::ws_release(Connection& c) {
+    if (c.ws) ws_finish(c, http::kWsCloseAbnormal);
+}
+
+void EventLoop::ws_subscribe(Connection& c, WsChannel& ch) {
+    WsConn& w = *c.ws;
+    if (w.close_sent) return;
+    for (WsChannel* x : w.channels) {
+        if (x == &ch) return;
+    }
+    w.channels.push_back(&ch);
+    auto [it, fresh] = ws_subs_.try_emplace(&ch);
+    if (fresh) { // 频道第一次有本 loop 的订阅者：之后其他线程的发布也要投递到这里
+        std::lock_guard<std::mutex> lock(ch.mu_);
+        ch.loops_.push_back(this);
+    }
+    WsSubs& subs = it->second;
+    if (subs.dead > 64 && subs.dead * 2 > subs.refs.size()) { // 频道很久没有广播、断开的又多：压缩一次
+        size_t keep = 0;
+        for (const StreamRef& r : subs.refs) {
+            const Connection* s = conns_.find(r.fd);
+            if (s && s->gen == r.gen && !s->closing && s->ws && !s->ws->close_sent) subs.refs[keep++] = r;
+        }
+        subs.refs.resize(keep);
+        subs.dead = 0;
+    }
+    subs.refs.push_back(StreamRef{c.fd, c.gen});
+    ch.count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventLoop::ws_unsubscribe(Connection& c, WsChannel& ch) {
+    std::vector<WsChannel*>& chs = c.ws->channels;
+    auto i = std::find(chs.begin(), chs.end(), &ch);
+    if (i == chs.end()) return;
+    chs.erase(i);
+    ch.count_.fetch_sub(1, std::memory_order_relaxed);
+    auto it = ws_subs_.find(&ch);
+    if (it == ws_subs_.end()) return;
+    std::vector<StreamRef>& refs = it->second.refs;
+    for (StreamRef& r : refs) {
+        if (r.fd == c.fd && r.gen == c.gen) {
+            r = refs.back();
+            refs.pop_back();
+            break;
+        }
+    }
+}
+
+void EventLoop::ws_post(WsChannel* ch, const std::shared_ptr<const std::string>& frame) {
+    auto* p    = new WsPost;
+    p->channel = ch;
+    p->frame   = frame;
+    ws_inbox_.push(p);
+    // 与工作线程的完成共用一次唤醒
+    if (!wake_pending_.exchange(true)) waker_.notify();
+}
+
+void EventLoop::ws_fanout(WsChannel* ch, const std::shared_ptr<const std::string>& frame) {
+    auto it = ws_subs_.find(ch);
+    if (it == ws_subs_.end()) return;
+    WsSubs& subs = it->second;
+    size_t  keep = 0;
+    for (const StreamRef& r : subs.refs) {
+        Connection* c = conns_.find(r.fd);
+        if (!c || c->gen != r.gen || c->closing || !c->ws || c->ws->close_sent) continue; // 已断开：顺带删掉
+        subs.refs[keep++] = r;
+        ws_queue(*c, frame);
+    }
+    subs.refs.resize(keep);
+    subs.dead = 0;
+}
+
+void EventLoop::ws_drain(bool deliver) {
+    while (MpscNode* n = ws_inbox_.pop()) {
+        std::unique_ptr<WsPost> p(static_cast<WsPost*>(n));
+        if (deliver) ws_fanout(p->channel, p->frame);
+    }
+}
+
+void EventLoop::ws_flush() {
+    if (ws_flush_.empty()) return;
+    std::vector<StreamRef> ready;
+    ready.swap(ws_flush_);
+    for (const StreamRef& r : ready) {
+        Connection* c = conns_.find(r.fd);
+        if (!c || c->gen != r.gen || c->closing || !c->ws) continue;
+        c->ws->flush_pending = false;
+        if (c->ws->overflow) { // 对端读得比消息产生得慢：断开，不让积压无限增长
+            metrics_->ws_slow_closes.add();
+#ifdef __linux__
+            if (uring_) {
+                uring_close(*c);
+                continue;
+            }
+#endif
+            close_conn(c->fd);
+            continue;
+        }
+        after_async(*c);
+    }
+}
+
+void EventLoop::ws_detach() noexcept {
+    for (auto& [ch, subs] : ws_subs_) {
+        std::lock_guard<std::mutex> lock(ch->mu_);
+        auto& loops = ch->loops_;
+        loops.erase(std::remove(loops.begin(), loops.end(), this), loops.end());
+    }
+    ws_subs_.clear();
+    ws_drain(false); // 摘掉之后不会再有新的投递
+}
+
+// —— 交给处理函数的句柄与频道 ——
+
+void WebSocket::send_text(std::string_view text) {
+    if (Connection* c = loop_->ws_conn(*this)) loop_->ws_send(*c, http::WsOpcode::Text, text);
+}
+
+void WebSocket::send_binary(std::string_view data) {
+    if (Connection* c = loop_->ws_conn(*this)) loop_->ws_send(*c, http::WsOpcode::Binary, data);
+}
+
+void WebSocket::send(const http::WsMessage& m) {
+    Connection* c = loop_->ws_conn(*this);
+    if (c && !m.empty() && !c->ws->close_sent) loop_->ws_queue(*c, m.frame());
+}
+
+void WebSocket::ping(std::string_view payload) {
+    if (Connection* c = loop_->ws_conn(*this)) loop_->ws_send(*c, http::WsOpcode::Ping, payload.substr(0, 125));
+}
+
+void WebSocket::close(uint16_t code, std::string_view reason) {
+    if (Connection* c = loop_->ws_conn(*this)) loop_->ws_close(*c, code, reason);
+}
+
+uint64_t WebSocket::buffered() const noexcept {
+    const Connection* c = loop_->ws_conn(*this);
+    return c && c->io ? c->io->out.size() : 0;
+}
+
+void WsChannel::subscribe(WebSocket& ws) {
+    if (Connection* c = ws.loop_->ws_conn(ws)) ws.loop_->ws_subscribe(*c, *this);
+}
+
+void WsChannel::unsubscribe(WebSocket& ws) {
+    if (Connection* c = ws.loop_->ws_conn(ws)) ws.loop_->ws_unsubscribe(*c, *this);
+}
+
+void WsChannel::publish(const http::WsMessage& m) {
+    if (m.empty()) return;
+    EventLoop* self  = EventLoop::tls_loop_;
+    bool       local = false;
+    {
+        // 持锁投递：loop 销毁前要拿这把锁把自己摘掉，持锁期间的投递对象一定还在
+        std::lock_guard<std::mutex> lock(mu_);
+        for (EventLoop* loop : loops_) {
+            if (loop == self) local = true;
+            else              loop->ws_post(this, m.frame());
+        }
+    }
+    if (local) self->ws_fanout(this, m.frame()); // 本线程的 loop：不经队列，当场分发
+}
+
+} // namespace net
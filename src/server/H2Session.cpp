@@ -0,0 +1,733 @@
+#include "server/H2Session.h"
+
+#include <algorithm>
+#include <charconv>
+#include <utility>
+
+namespace net {
+
+namespace {
+
+constexpr size_t   kFrameHeader   = 9;
+constexpr uint32_t kMaxWindow     = 0x7FFFFFFF;
+constexpr size_t   kMaxBlock      = 64 * 1024; // 一个头部块（HEADERS + CONTINUATION）压缩后的上限
+constexpr size_t   kInlineBody    = OutputQueue::kCoalesceMax; // 不超过它的响应体直接拷进 DATA 帧
+
+// SETTINGS 参数
+enum Setting : uint16_t {
+    kHeaderTableSize = 1, kEnablePush = 2, kMaxConcurrentStreams = 3, kInitialWindowSize = 4,
+    kMaxFrameSize = 5, kMaxHeaderListSize = 6
+};
+
+uint32_t read_u32(const char* p) noexcept {
+    return (static_cast<uint32_t>(static_cast<uint8_t>(p[0])) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[1])) << 16) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(p[2])) << 8) | static_cast<uint8_t>(p[3]);
+}
+
+void put_u32(std::string& out, uint32_t v) {
+    out += static_cast<char>(v >> 24);
+    out += static_cast<char>(v >> 16);
+    out += static_cast<char>(v >> 8);
+    out += static_cast<char>(v);
+}
+
+void put_setting(std::string& out, uint16_t id, uint32_t v) {
+    out += static_cast<char>(id >> 8);
+    out += static_cast<char>(id);
+    put_u32(out, v);
+}
+
+// 协议不允许带进 HTTP/2 的逐跳头部（RFC 9113 8.2.2）
+bool connection_specific(std::string_view name) noexcept {
+    return name == "connection" || name == "keep-alive" || name == "proxy-connection" ||
+           name == "transfer-encoding" || name == "upgrade";
+}
+
+// base64url，不带填充（RFC 7540 3.2.1 的 HTTP2-Settings），也接受标准字母表和填充
+bool base64url_decode(std::string_view in, std::string& out) {
+    uint32_t acc  = 0;
+    int      bits = 0;
+    for (const char ch : in) {
+        int v;
+        if (ch >= 'A' && ch <= 'Z')      v = ch - 'A';
+        else if (ch >= 'a' && ch <= 'z') v = ch - 'a' + 26;
+        else if (ch >= '0' && ch <= '9') v = ch - '0' + 52;
+        else if (ch == '-' || ch == '+') v = 62;
+        else if (ch == '_' || ch == '/') v = 63;
+        else if (ch == '=')              break;
+        else                             return false;
+        acc   = (acc << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>(acc >> bits);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void H2Session::frame_header(uint32_t len, uint8_t type, uint8_t flags, uint32_t id) {
+    wbuf_ += static_cast<char>(len >> 16);
+    wbuf_ += static_cast<char>(len >> 8);
+    wbuf_ += static_cast<char>(len);
+    wbuf_ += static_cast<char>(type);
+    wbuf_ += static_cast<char>(flags);
+    put_u32(wbuf_, id & kMaxWindow);
+}
+
+void H2Session::flush(OutputQueue& out) {
+    if (wbuf_.empty()) return;
+    out.append(std::move(wbuf_));
+    wbuf_ = out.take_buffer(); // 复用发完的段的缓冲
+    wbuf_.clear();
+}
+
+void H2Session::start(OutputQueue& out) {
+    frame_header(18, h2::kSettings, 0, 0);
+    put_setting(wbuf_, kMaxConcurrentStreams, kMaxStreams);
+    put_setting(wbuf_, kInitialWindowSize, kStreamWindow);
+    put_setting(wbuf_, kMaxHeaderListSize, kMaxHeaderList);
+    window_update(0, kConnWindow - 65535);
+    conn_recv_window_ = kConnWindow;
+    flush(out);
+}
+
+bool H2Session::upgrade(std::string_view settings) {
+    std::string payload;
+    if (!base64url_decode(settings, payload) || payload.size() % 6 != 0) return false;
+    if (!apply_settings(payload)) return false; // 升级的 SETTINGS 由 101 隐式确认，不回 ACK
+    auto s         = std::make_unique<H2Stream>();
+    s->id          = 1;
+    s->send_window = peer_initial_window_;
+    s->remote_done = true;
+    s->dispatched  = true;
+    last_peer_id_  = 1;
+    streams_.emplace(1, std::move(s));
+    return true;
+}
+
+H2Stream* H2Session::find(uint32_t id) noexcept {
+    const auto it = streams_.find(id);
+    return it == streams_.end() ? nullptr : it->second.get();
+}
+
+bool H2Session::pop_ready(uint32_t& id) {
+    if (ready_head_ == ready_.size()) {
+        ready_.clear();
+        ready_head_ = 0;
+        return false;
+    }
+    id = ready_[ready_head_++];
+    return true;
+}
+
+bool H2Session::pop_reset(uint32_t& id) {
+    if (resets_.empty()) return false;
+    id = resets_.back();
+    resets_.pop_back();
+    return true;
+}
+
+bool H2Session::receiving() const noexcept {
+    for (const auto& [id, s] : streams_)
+        if (!s->remote_done) return true;
+    return false;
+}
+
+bool H2Session::sendable() const noexcept {
+    if (conn_send_window_ <= 0 || state_ == State::Preface) return false;
+    for (const uint32_t id : sending_) {
+        const auto it = streams_.find(id);
+        if (it == streams_.end()) continue;
+        const H2Stream& s = *it->second;
+        if (s.send_window > 0 && (!s.data.empty() || s.file_left > 0 || (s.producer && !s.waiting))) return true;
+    }
+    return false;
+}
+
+void H2Session::retry() noexcept {
+    waiting_ = false;
+    for (const uint32_t id : sending_)
+        if (H2Stream* s = find(id); s && !s->signal) s->waiting = false;
+}
+
+void H2Session::wake(uint32_t id) noexcept {
+    if (H2Stream* s = find(id)) s->waiting = false;
+}
+
+void H2Session::goaway(uint32_t code) {
+    if (goaway_sent_) return;
+    frame_header(8, h2::kGoaway, 0, 0);
+    put_u32(wbuf_, last_peer_id_);
+    put_u32(wbuf_, code);
+    goaway_sent_ = true;
+    state_       = State::Closed;
+}
+
+void H2Session::window_update(uint32_t id, uint32_t n) {
+    frame_header(4, h2::kWindowUpdate, 0, id);
+    put_u32(wbuf_, n);
+}
+
+void H2Session::drop_stream(uint32_t id) {
+    const auto it = streams_.find(id);
+    if (it == streams_.end()) return;
+    if (it->second->dispatched && !it->second->responded) resets_.push_back(id);
+    streams_.erase(it); // sending_ / ready_ 里的编号在用到时按找不到跳过
+}
+
+void H2Session::reset_stream(uint32_t id, uint32_t code) {
+    frame_header(4, h2::kRstStream, 0, id);
+    put_u32(wbuf_, code);
+    drop_stream(id);
+}
+
+bool H2Session::apply_settings(std::string_view payload) {
+    for (size_t i = 0; i + 6 <= payload.size(); i += 6) {
+        const auto     id = static_cast<uint16_t>((static_cast<uint8_t>(payload[i]) << 8) | static_cast<uint8_t>(payload[i + 1]));
+        const uint32_t v  = read_u32(payload.data() + i + 2);
+        switch (id) {
+            case kHeaderTableSize:
+                encoder_.set_max_table_size(v);
+                break;
+            case kEnablePush:
+                if (v > 1) { goaway(h2::kProtocolError); return false; }
+                break;
+            case kInitialWindowSize: {
+                if (v > kMaxWindow) { goaway(h2::kFlowControlError); return false; }
+                // 已打开的流按差值调整发送窗口，可以变成负数（6.9.2）
+                const int64_t delta = static_cast<int64_t>(v) - peer_initial_window_;
+                for (auto& [sid, s] : streams_) {
+                    s->send_window += delta;
+                    if (s->send_window > kMaxWindow) { goaway(h2::kFlowControlError); return false; }
+                }
+                peer_initial_window_ = v;
+                break;
+            }
+            case kMaxFrameSize:
+                if (v < 16384 || v > 16777215) { goaway(h2::kProtocolError); return false; }
+                peer_max_frame_ = v;
+                break;
+            default: // 并发流数（我们不推送）、头部列表上限、未知参数：忽略
+                break;
+        }
+    }
+    return true;
+}
+
+size_t H2Session::feed(std::string_view in, OutputQueue& out) {
+    size_t pos = 0;
+    if (state_ == State::Preface) {
+        const size_t n = std::min(in.size(), h2::kPreface.size());
+        if (in.substr(0, n) != h2::kPreface.substr(0, n)) {
+            goaway(h2::kProtocolError);
+            flush(out);
+            return in.size();
+        }
+        if (n < h2::kPreface.size()) return 0;
+        pos    = n;
+        state_ = State::Settings; // 前言之后第一帧必须是 SETTINGS
+    }
+    while (state_ != State::Closed && in.size() - pos >= kFrameHeader) {
+        const char*    h     = in.data() + pos;
+        const uint32_t len   = (static_cast<uint32_t>(static_cast<uint8_t>(h[0])) << 16) |
+                               (static_cast<uint32_t>(static_cast<uint8_t>(h[1])) << 8) | static_cast<uint8_t>(h[2]);
+        const auto     type  = static_cast<uint8_t>(h[3]);
+        const auto     flags = static_cast<uint8_t>(h[4]);
+        const uint32_t id    = read_u32(h + 5) & kMaxWindow;
+        if (len > kMaxFrame) {
+            goaway(h2::kFrameSizeError);
+            break;
+        }
+        if (in.size() - pos - kFrameHeader < len) break; // 帧还没收全
+        const std::string_view payload = in.substr(pos + kFrameHeader, len);
+        pos += kFrameHeader + len;
+
+        if (state_ == State::Settings && (type != h2::kSettings || (flags & h2::kAck))) {
+            goaway(h2::kProtocolError);
+            break;
+        }
+        // 头部块没收完时只能是同一个流的 CONTINUATION
+        if (block_stream_ && (type != h2::kContinuation || id != block_stream_)) {
+            goaway(h2::kProtocolError);
+            break;
+        }
+
+        switch (type) {
+            case h2::kData:
+                on_data(id, flags, payload);
+                break;
+            case h2::kHeaders:
+                on_headers(id, flags, payload);
+                break;
+            case h2::kContinuation:
+                if (!block_stream_) { goaway(h2::kProtocolError); break; }
+                if (block_.size() + payload.size() > kMaxBlock) { goaway(h2::kEnhanceYourCalm); break; }
+                block_.append(payload.data(), payload.size());
+                if (flags & h2::kEndHeaders) end_headers();
+                break;
+            case h2::kPriority: // 不按优先级调度，只检查格式
+                if (id == 0) goaway(h2::kProtocolError);
+                else if (len != 5) reset_stream(id, h2::kFrameSizeError);
+                break;
+            case h2::kRstStream:
+                if (id == 0 || id > last_peer_id_) { goaway(h2::kProtocolError); break; }
+                if (len != 4) { goaway(h2::kFrameSizeError); break; }
+                drop_stream(id);
+                break;
+            case h2::kSettings:
+                if (id != 0) { goaway(h2::kProtocolError); break; }
+                if ((flags & h2::kAck) ? len != 0 : len % 6 != 0) { goaway(h2::kFrameSizeError); break; }
+                if (flags & h2::kAck) break;
+                if (!apply_settings(payload)) break;
+                frame_header(0, h2::kSettings, h2::kAck, 0);
+                state_ = State::Frames;
+                break;
+            case h2::kPing:
+                if (id != 0) { goaway(h2::kProtocolError); break; }
+                if (len != 8) { goaway(h2::kFrameSizeError); break; }
+                if (flags & h2::kAck) break;
+                frame_header(8, h2::kPing, h2::kAck, 0);
+                wbuf_.append(payload.data(), payload.size());
+                break;
+            case h2::kGoaway:
+                if (id != 0) { goaway(h2::kProtocolError); break; }
+                goaway_received_ = true; // 不再接受新流，已有的做完
+                break;
+            case h2::kWindowUpdate: {
+                if (len != 4) { goaway(h2::kFrameSizeError); break; }
+                const uint32_t inc = read_u32(payload.data()) & kMaxWindow;
+                if (id == 0) {
+                    if (inc == 0) { goaway(h2::kProtocolError); break; }
+                    conn_send_window_ += inc;
+                    if (conn_send_window_ > kMaxWindow) goaway(h2::kFlowControlError);
+                    break;
+                }
+                if (id > last_peer_id_) { goaway(h2::kProtocolError); break; }
+                H2Stream* s = find(id);
+                if (!s) break; // 已关闭的流：忽略
+                if (inc == 0) { reset_stream(id, h2::kProtocolError); break; }
+                s->send_window += inc;
+                if (s->send_window > kMaxWindow) reset_stream(id, h2::kFlowControlError);
+                break;
+            }
+            case h2::kPushPromise: // 客户端不能推送
+                goaway(h2::kProtocolError);
+                break;
+            default: // 未知类型的帧：忽略（5.5）
+                break;
+        }
+    }
+    if (state_ == State::Closed) pos = in.size(); // GOAWAY 之后的输入不再处理
+    flush(out);
+    return pos;
+}
+
+void H2Session::on_headers(uint32_t id, uint8_t flags, std::string_view payload) {
+    if (id == 0 || !(id & 1)) {
+        goaway(h2::kProtocolError);
+        return;
+    }
+    if (flags & h2::kPadded) {
+        if (payload.empty()) { goaway(h2::kProtocolError); return; }
+        const auto pad = static_cast<uint8_t>(payload[0]);
+        if (pad >= payload.size()) { goaway(h2::kProtocolError); return; }
+        payload = payload.substr(1, payload.size() - 1 - pad);
+    }
+    if (flags & h2::kPriorityFlag) {
+        if (payload.size() < 5) { goaway(h2::kProtocolError); return; }
+        payload.remove_prefix(5);
+    }
+    if (id < last_peer_id_ && !find(id)) { // 已关闭的流上又来 HEADERS
+        goaway(h2::kStreamClosed);
+        return;
+    }
+    block_.assign(payload.data(), payload.size());
+    block_stream_ = id;
+    block_flags_  = flags;
+    if (flags & h2::kEndHeaders) end_headers();
+}
+
+void H2Session::end_headers() {
+    const uint32_t id    = std::exchange(block_stream_, 0);
+    const uint8_t  flags = block_flags_;
+    H2Stream*      s     = find(id);
+    // 头部块总要解码，哪怕流马上被拒绝：动态表要和对端保持同步
+    std::string raw;
+    fields_.clear();
+    if (!decoder_.decode(block_, raw, fields_, kMaxHeaderList)) {
+        goaway(h2::kCompressionError);
+        return;
+    }
+    if (s) { // 已有的流：trailer，内容不用，必须带 END_STREAM
+        if (s->remote_done || !(flags & h2::kEndStream)) {
+            reset_stream(id, s->remote_done ? h2::kStreamClosed : h2::kProtocolError);
+            return;
+        }
+        finish_request(*s);
+        return;
+    }
+    if (id <= last_peer_id_) { // 已关闭的流
+        goaway(h2::kStreamClosed);
+        return;
+    }
+    last_peer_id_ = id;
+    if (goaway_received_ || streams_.size() >= kMaxStreams) {
+        reset_stream(id, h2::kRefusedStream);
+        return;
+    }
+    auto stream          = std::make_unique<H2Stream>();
+    stream->id           = id;
+    stream->raw          = std::move(raw);
+    stream->send_window  = peer_initial_window_;
+    stream->recv_window  = kStreamWindow;
+    H2Stream& ns = *stream;
+    streams_.emplace(id, std::move(stream));
+    if (const uint32_t err = build_request(ns)) {
+        reset_stream(id, err);
+        return;
+    }
+    ns.body_limit = body_limit_(ns.req);
+    if (ns.content_length != UINT64_MAX && ns.content_length > ns.body_limit) ns.reject = 413;
+    if (flags & h2::kEndStream) {
+        finish_request(ns);
+    } else if (ns.reject) { // 不等请求体：先答复，随后的 DATA 收下丢弃
+        ns.dispatched = true;
+        ready_.push_back(id);
+    }
+}
+
+uint32_t H2Session::build_request(H2Stream& s) {
+    std::string&       raw = s.raw;
+    http::HttpRequest& req = s.req;
+    // 先只记位置：合并 cookie 时 raw 还会增长，视图最后再建
+    const http::HpackField* method    = nullptr;
+    const http::HpackField* path      = nullptr;
+    const http::HpackField* scheme    = nullptr;
+    const http::HpackField* authority = nullptr;
+    size_t cookies = 0;
+    bool   regular = false;
+    for (const http::HpackField& f : fields_) {
+        const std::string_view name = f.name(raw);
+        if (name.empty()) return h2::kProtocolError;
+        if (name[0] == ':') { // 伪头部：只能在最前面，各一次
+            const http::HpackField** slot = name == ":method"    ? &method
+                                          : name == ":path"      ? &path
+                                          : name == ":scheme"    ? &scheme
+                                          : name == ":authority" ? &authority
+                                                                 : nullptr;
+            if (regular || !slot || *slot) return h2::kProtocolError;
+            *slot = &f;
+            continue;
+        }
+        regular = true;
+        for (const char ch : name)
+            if (ch >= 'A' && ch <= 'Z') return h2::kProtocolError;
+        if (connection_specific(name)) return h2::kProtocolError;
+        if (name == "te" && f.value(raw) != "trailers") return h2::kProtocolError;
+        if (name == "cookie") ++cookies;
+        if (name == "content-length") {
+            const std::string_view v = f.value(raw);
+            uint64_t n = 0;
+            const auto [p, ec] = std::from_chars(v.data(), v.data() + v.size(), n);
+            if (ec != std::errc{} || p != v.data() + v.size() || s.content_length != UINT64_MAX) return h2::kProtocolError;
+            s.content_length = n;
+        }
+    }
+    if (!method || !path || !scheme || path->value_len == 0) return h2::kProtocolError; // 不支持 CONNECT
+
+    // 分成多个字段的 cookie 合成一个（8.2.3），放在 raw 末尾
+    http::HpackField cookie{};
+    if (cookies > 1) {
+        cookie.name_off = cookie.value_off = static_cast<uint32_t>(raw.size());
+        cookie.name_len = 6;
+        raw += "cookie";
+        cookie.value_off = static_cast<uint32_t>(raw.size());
+        for (const http::HpackField& f : fields_) {
+            if (f.name(raw) != "cookie") continue;
+            if (raw.size() > cookie.value_off) raw += "; ";
+            raw.append(f.value(raw));
+        }
+        cookie.value_len = static_cast<uint32_t>(raw.size() - cookie.value_off);
+    }
+
+    req.clear();
+    req.method  = http::parse_method(method->value(raw));
+    req.uri     = path->value(raw);
+    req.version = "HTTP/2";
+    const size_t q = req.uri.find('?');
+    if (q == std::string_view::npos) {
+        req.path = req.uri;
+    } else {
+        req.path  = req.uri.substr(0, q);
+        req.query = req.uri.substr(q + 1);
+    }
+    bool ok = true;
+    if (authority) ok = req.headers.add("host", authority->value(raw)); // :authority 顶替 Host
+    if (cookies > 1) ok = ok && req.headers.add("cookie", cookie.value(raw));
+    for (const http::HpackField& f : fields_) {
+        const std::string_view name = f.name(raw);
+        if (name[0] == ':' || (authority && name == "host") || (cookies > 1 && name == "cookie")) continue;
+        ok = ok && req.headers.add(name, f.value(raw));
+    }
+    if (!ok) s.reject = 431;
+    return 0;
+}
+
+void H2Session::on_data(uint32_t id, uint8_t flags, std::string_view payload) {
+    if (id == 0) {
+        goaway(h2::kProtocolError);
+        return;
+    }
+    // 流量控制按整个负载（含填充）计
+    conn_recv_window_ -= static_cast<int64_t>(payload.size());
+    if (conn_recv_window_ < 0) {
+        goaway(h2::kFlowControlError);
+        return;
+    }
+    conn_recv_unacked_ += static_cast<uint32_t>(payload.size());
+    if (conn_recv_unacked_ >= kConnWindow / 2) {
+        window_update(0, conn_recv_unacked_);
+        conn_recv_window_ += conn_recv_unacked_;
+        conn_recv_unacked_ = 0;
+    }
+    if (flags & h2::kPadded) {
+        if (payload.empty()) { goaway(h2::kProtocolError); return; }
+        const auto pad = static_cast<uint8_t>(payload[0]);
+        if (pad >= payload.size()) { goaway(h2::kProtocolError); return; }
+        payload = payload.substr(1, payload.size() - 1 - pad);
+    }
+    H2Stream* s = find(id);
+    if (!s) {
+        if (id > last_peer_id_) goaway(h2::kProtocolError); // 还没打开的流
+        else                    reset_stream(id, h2::kStreamClosed);
+        return;
+    }
+    if (s->remote_done) {
+        reset_stream(id, h2::kStreamClosed);
+        return;
+    }
+    s->recv_window -= static_cast<int64_t>(payload.size());
+    if (s->recv_window < 0) {
+        reset_stream(id, h2::kFlowControlError);
+        return;
+    }
+    if (!s->reject) {
+        if (s->body.size() + payload.size() > s->body_limit) { // 超过路由的上限：回 413，其余的丢弃
+            s->reject = 413;
+            std::string().swap(s->body);
+            if (!s->dispatched) {
+                s->dispatched = true;
+                ready_.push_back(id);
+            }
+        } else {
+            s->body.append(payload.data(), payload.size());
+        }
+    }
+    if (flags & h2::kEndStream) {
+        finish_request(*s);
+        return;
+    }
+    // 请求体整个收在内存里，上限由 body_limit 管：收到就还窗口
+    s->recv_unacked += static_cast<uint32_t>(payload.size());
+    if (s->recv_unacked >= kStreamWindow / 2) {
+        window_update(id, s->recv_unacked);
+        s->recv_window += s->recv_unacked;
+        s->recv_unacked = 0;
+    }
+}
+
+void H2Session::finish_request(H2Stream& s) {
+    s.remote_done = true;
+    if (!s.reject && s.content_length != UINT64_MAX && s.content_length != s.body.size()) {
+        reset_stream(s.id, h2::kProtocolError); // 声明的长度和实际的不符（8.1.1）
+        return;
+    }
+    if (s.responded) { // 已经答复（413）的流：请求也结束了，流随之关闭
+        if (s.data.empty() && s.file_left == 0 && !s.producer) streams_.erase(s.id);
+        return;
+    }
+    if (s.dispatched) return;
+    s.req.body   = s.body;
+    s.dispatched = true;
+    ready_.push_back(s.id);
+}
+
+void H2Session::respond(H2Stream& s, http::HttpResponse& resp, bool head_only, OutputQueue& out) {
+    s.responded = true;
+    const int  status   = resp.status;
+    const bool bodiless = head_only || status < 200 || status == 204 || status == 304;
+    // 响应头：状态码、各头部（名字转小写，去掉逐跳头部），没写 content-length 时补上
+    std::string& block = hbuf_;
+    block.clear();
+    encoder_.begin(block);
+    encoder_.status(status, block);
+    std::string name;
+    bool        has_len = false;
+    const auto  add = [&](std::string_view n, std::string_view v) {
+        name.assign(n.data(), n.size());
+        for (char& ch : name)
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch + ('a' - 'A'));
+        if (connection_specific(name)) return;
+        if (name == "content-length") has_len = true;
+        encoder_.field(name, v, block);
+    };
+    for (const auto& [k, v] : resp.headers) add(k, v);
+    if (resp.raw_headers) {
+        std::string_view lines = *resp.raw_headers;
+        while (!lines.empty()) {
+            const size_t eol   = lines.find("\r\n");
+            const std::string_view line = lines.substr(0, eol);
+            const size_t colon = line.find(':');
+            if (colon != std::string_view::npos) {
+                std::string_view v = line.substr(colon + 1);
+                while (!v.empty() && (v.front() == ' ' || v.front() == '\t')) v.remove_prefix(1);
+                add(line.substr(0, colon), v);
+            }
+            if (eol == std::string_view::npos) break;
+            lines.remove_prefix(eol + 2);
+        }
+    }
+    const bool streamed = static_cast<bool>(resp.stream);
+    if (!has_len && status >= 200 && status != 204 && status != 304 && (!streamed || resp.stream_length >= 0)) {
+        char buf[24];
+        const auto r = std::to_chars(buf, buf + sizeof(buf), streamed ? static_cast<uint64_t>(resp.stream_length)
+                                                                      : resp.body_size());
+        encoder_.field("content-length", std::string_view(buf, static_cast<size_t>(r.ptr - buf)), block);
+    }
+
+    // 响应体的来源；小的内存响应体窗口够时直接跟在头后面，一次写完
+    if (!bodiless) {
+        if (streamed) {
+            s.producer = std::move(resp.stream);
+            s.signal   = std::move(resp.stream_signal); // loop 在 respond 之后绑定
+        } else if (resp.file.fd >= 0) {
+            s.owner     = std::move(resp.file.owner);
+            s.file_fd   = resp.file.fd;
+            s.file_off  = resp.file.offset;
+            s.file_left = resp.file.length;
+        } else if (resp.shared_body) {
+            s.data  = *resp.shared_body;
+            s.owner = std::move(resp.shared_body);
+        } else if (!resp.body.empty()) {
+            auto body = std::make_shared<std::string>(std::move(resp.body));
+            s.data    = *body;
+            s.owner   = std::move(body);
+        }
+    }
+    const bool no_body = !s.producer && s.data.empty() && s.file_left == 0;
+    const bool inline_body = !no_body && !s.producer && s.file_left == 0 && s.data.size() <= kInlineBody &&
+                             static_cast<int64_t>(s.data.size()) <= std::min(conn_send_window_, s.send_window);
+
+    // HEADERS，超过对端帧长上限的部分放进 CONTINUATION
+    size_t off = 0;
+    do {
+        const size_t  n     = std::min(block.size() - off, static_cast<size_t>(peer_max_frame_));
+        const bool    last  = off + n == block.size();
+        uint8_t       flags = last ? h2::kEndHeaders : 0;
+        if (off == 0 && no_body) flags |= h2::kEndStream;
+        frame_header(static_cast<uint32_t>(n), off == 0 ? h2::kHeaders : h2::kContinuation, flags, s.id);
+        wbuf_.append(block, off, n);
+        off += n;
+    } while (off < block.size());
+
+    if (inline_body) {
+        frame_header(static_cast<uint32_t>(s.data.size()), h2::kData, h2::kEndStream, s.id);
+        wbuf_.append(s.data.data(), s.data.size());
+        conn_send_window_ -= static_cast<int64_t>(s.data.size());
+        s.send_window     -= static_cast<int64_t>(s.data.size());
+        s.data = {};
+        s.owner.reset();
+    }
+    flush(out);
+    if (no_body || inline_body) close_local(s);
+    else                        sending_.push_back(s.id);
+}
+
+void H2Session::close_local(H2Stream& s) {
+    // 请求还没收完（例如 413 没等请求体）：告诉对端不用再发了（8.1）
+    if (!s.remote_done) reset_stream(s.id, h2::kNoError);
+    else                streams_.erase(s.id);
+}
+
+H2Session::Sent H2Session::send_data(H2Stream& s, OutputQueue& out, size_t& budget) {
+    if (s.data.empty() && s.file_left == 0 && s.producer) {
+        if (s.waiting) return Sent::Blocked;
+        auto chunk = std::make_shared<std::string>();
+        if (s.signal) s.signal->rearm();
+        const bool more = s.producer(*chunk);
+        if (!more) s.producer = nullptr;
+        if (chunk->empty() && more) { // 生产者暂时没有数据：有 waker 的等唤醒（返回前已被唤醒就不等），否则等 retry
+            if (!s.signal) s.waiting = waiting_ = true;
+            else           s.waiting = !s.signal->pending();
+            return Sent::Blocked;
+        }
+        s.data  = *chunk;
+        s.owner = std::move(chunk);
+    }
+    const uint64_t avail = s.file_left ? s.file_left : s.data.size();
+    if (avail == 0) { // 生产者最后一次没给数据：空 DATA 帧结束流
+        frame_header(0, h2::kData, h2::kEndStream, s.id);
+        flush(out);
+        return Sent::Finished;
+    }
+    const int64_t window = std::min(conn_send_window_, s.send_window);
+    if (window <= 0) return Sent::Blocked;
+    const size_t n = static_cast<size_t>(std::min<uint64_t>({avail, static_cast<uint64_t>(window), peer_max_frame_}));
+    const bool   last = n == avail && !s.producer;
+    frame_header(static_cast<uint32_t>(n), h2::kData, last ? h2::kEndStream : 0, s.id);
+    if (s.file_left) {
+        flush(out);
+        out.append_file(s.owner, s.file_fd, s.file_off, n); // 文件段照旧走 sendfile
+        s.file_off  += n;
+        s.file_left -= n;
+    } else if (n <= kInlineBody) {
+        wbuf_.append(s.data.data(), n);
+        flush(out);
+        s.data.remove_prefix(n);
+    } else {
+        flush(out);
+        out.append_shared(s.owner, s.data.substr(0, n)); // 共享段：响应体本身不拷贝
+        s.data.remove_prefix(n);
+    }
+    if (s.data.empty() && s.file_left == 0) s.owner.reset();
+    conn_send_window_ -= static_cast<int64_t>(n);
+    s.send_window     -= static_cast<int64_t>(n);
+    budget = n < budget ? budget - n : 0;
+    return last ? Sent::Finished : Sent::Progress;
+}
+
+void H2Session::pump(OutputQueue& out, size_t high_water, size_t& budget) {
+    flush(out);
+    // h2c 升级：客户端的连接前言到之前不发响应体。有的客户端（curl）只能缓存 101 之后
+    // 很少的数据，前言之后才开始按帧读
+    if (state_ == State::Preface) return;
+    // 各流轮流每次发一帧，大响应不会把别的流饿住
+    bool progress = true;
+    while (progress && !sending_.empty()) {
+        progress = false;
+        for (size_t i = 0; i < sending_.size();) {
+            if (out.size() >= high_water || budget == 0 || conn_send_window_ <= 0) return;
+            H2Stream* s = find(sending_[i]);
+            if (!s) { // 被对端撤销了
+                sending_.erase(sending_.begin() + static_cast<std::ptrdiff_t>(i));
+                continue;
+            }
+            const Sent r = send_data(*s, out, budget);
+            if (r == Sent::Finished) {
+                sending_.erase(sending_.begin() + static_cast<std::ptrdiff_t>(i));
+                close_local(*s);
+                flush(out);
+                progress = true;
+                continue;
+            }
+            if (r == Sent::Progress) progress = true;
+            ++i;
+        }
+    }
+}
+
+} // namespace net
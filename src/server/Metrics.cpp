@@ -0,0 +1,236 @@
+#include "server/Metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+
+namespace net {
+
+size_t LatencyHistogram::bucket_of(uint64_t ns) noexcept {
+    if (ns < kSub) return static_cast<size_t>(ns);
+    const unsigned msb = 63u - static_cast<unsigned>(std::countl_zero(ns));
+    if (msb >= kMaxShift) return kBuckets - 1;
+    const unsigned shift = msb - kSubBits;
+    const size_t   sub   = static_cast<size_t>(ns >> shift) & (kSub - 1);
+    return kSub + static_cast<size_t>(shift) * kSub + sub;
+}
+
+uint64_t LatencyHistogram::upper_bound(size_t bucket) noexcept {
+    if (bucket < kSub) return bucket;
+    const size_t shift = (bucket - kSub) / kSub;
+    const size_t sub   = (bucket - kSub) % kSub;
+    return ((static_cast<uint64_t>(kSub + sub) + 1) << shift) - 1;
+}
+
+void HistogramSnapshot::add(const LatencyHistogram& h) noexcept {
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        const uint64_t n = h.bucket(i);
+        buckets[i] += n;
+        count += n;
+    }
+    sum += h.sum();
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const noexcept {
+    if (count == 0) return 0;
+    const double want = q <= 0 ? 1 : q >= 1 ? static_cast<double>(count) : q * static_cast<double>(count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (static_cast<double>(seen) >= want) return LatencyHistogram::upper_bound(i);
+    }
+    return LatencyHistogram::upper_bound(buckets.size() - 1);
+}
+
+LoopMetrics::LoopMetrics(size_t routes)
+    : routes_(routes > 0 ? routes : 1), hist_(new std::atomic<LatencyHistogram*>[routes_ * kClasses]) {
+    for (size_t i = 0; i < routes_ * kClasses; ++i) hist_[i].store(nullptr, std::memory_order_relaxed);
+}
+
+LoopMetrics::~LoopMetrics() {
+    for (size_t i = 0; i < routes_ * kClasses; ++i) delete hist_[i].load(std::memory_order_relaxed);
+}
+
+LatencyHistogram* LoopMetrics::create(std::atomic<LatencyHistogram*>& slot) {
+    auto* h = new LatencyHistogram();
+    slot.store(h, std::memory_order_release); // 抓取线程 acquire 读到指针时，清零的桶已可见
+    return h;
+}
+
+// —— Prometheus 文本格式 ——
+
+namespace {
+
+// Prometheus 的 le 边界：1µs（2^10 ns）到约 69s（2^36 ns），每个 2 的幂一档。
+// 边界正好落在分桶的起点上，所以累计值是精确的（只差边界值本身归入下一档）
+constexpr unsigned kLeFirstShift = 10;
+
+void append_uint(std::string& out, uint64_t v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
+void append_seconds(std::string& out, uint64_t ns) {
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof(buf), "%.9g", static_cast<double>(ns) / 1e9);
+    if (n > 0) out.append(buf, static_cast<size_t>(n));
+}
+
+// 标签值里的 \ " 换行要转义
+void append_label(std::string& out, std::string_view v) {
+    for (const char ch : v) {
+        if (ch == '\\')      out += "\\\\";
+        else if (ch == '"')  out += "\\\"";
+        else if (ch == '\n') out += "\\n";
+        else                 out += ch;
+    }
+}
+
+void append_meta(std::string& out, const char* name, const char* type, const char* help) {
+    out.append("# HELP ").append(name).append(1, ' ').append(help).append(1, '\n');
+    out.append("# TYPE ").append(name).append(1, ' ').append(type).append(1, '\n');
+}
+
+template <class Get>
+void append_counter(std::string& out, const std::vector<std::shared_ptr<const LoopMetrics>>& loops,
+                    const char* name, const char* help, Get get) {
+    uint64_t total = 0;
+    for (const auto& m : loops) total += get(*m);
+    append_meta(out, name, "counter", help);
+    out.append(name).append(1, ' ');
+    append_uint(out, total);
+    out += '\n';
+}
+
+} // namespace
+
+std::string render_prometheus(const std::vector<std::shared_ptr<const LoopMetrics>>& loops,
+                              const http::Router* router) {
+    std::string out;
+    out.reserve(4096);
+
+    append_counter(out, loops, "http_server_connections_accepted_total", "Connections accepted.",
+                   [](const LoopMetrics& m) { return m.connections_accepted.get(); });
+    append_counter(out, loops, "http_server_connections_closed_total", "Connections closed.",
+                   [](const LoopMetrics& m) { return m.connections_closed.get(); });
+    uint64_t open = 0;
+    for (const auto& m : loops) {
+        const uint64_t a = m->connections_accepted.get(), c = m->connections_closed.get();
+        open += a > c ? a - c : 0; // 两个计数器不是同一时刻读的
+    }
+    append_meta(out, "http_server_connections_open", "gauge", "Connections currently open.");
+    out += "http_server_connections_open ";
+    append_uint(out, open);
+    out += '\n';
+    append_counter(out, loops, "http_server_bytes_received_total", "Bytes read from client sockets.",
+                   [](const LoopMetrics& m) { return m.bytes_in.get(); });
+    append_counter(out, loops, "http_server_bytes_sent_total", "Bytes written to client sockets.",
+                   [](const LoopMetrics& m) { return m.bytes_out.get(); });
+    append_counter(out, loops, "http_server_requests_total", "Responses queued, including error responses.",
+                   [](const LoopMetrics& m) { return m.requests.get(); });
+    append_counter(out, loops, "http_server_parse_errors_total", "Malformed requests answered 400.",
+                   [](const LoopMetrics& m) { return m.parse_errors.get(); });
+    append_counter(out, loops, "http_server_requests_too_large_total", "Oversized requests answered 413.",
+                   [](const LoopMetrics& m) { return m.too_large.get(); });
+    append_counter(out, loops, "http_server_request_timeouts_total", "Requests timed out while being read (408).",
+                   [](const LoopMetrics& m) { return m.timeouts.get(); });
+    append_counter(out, loops, "http_server_idle_timeouts_total",
+                   "Connections closed for idling or not reading the response.",
+                   [](const LoopMetrics& m) { return m.idle_closes.get(); });
+    append_counter(out, loops, "http_server_request_bodies_spilled_total",
+                   "Request bodies written to a temporary file instead of memory.",
+                   [](const LoopMetrics& m) { return m.bodies_spilled.get(); });
+    append_counter(out, loops, "http_server_h2_connections_total",
+                   "Connections that switched to HTTP/2 (prior knowledge or h2c upgrade).",
+                   [](const LoopMetrics& m) { return m.h2_connections.get(); });
+    append_counter(out, loops, "http_server_websocket_connections_total",
+                   "Connections upgraded to WebSocket.",
+                   [](const LoopMetrics& m) { return m.ws_connections.get(); });
+    append_counter(out, loops, "http_server_websocket_messages_received_total",
+                   "Complete WebSocket messages received.",
+                   [](const LoopMetrics& m) { return m.ws_messages_in.get(); });
+    append_counter(out, loops, "http_server_websocket_frames_sent_total",
+                   "WebSocket frames queued for sending; a broadcast counts once per subscriber.",
+                   [](const LoopMetrics& m) { return m.ws_frames_out.get(); });
+    append_counter(out, loops, "http_server_websocket_slow_closes_total",
+                   "WebSocket connections dropped for exceeding their send backlog.",
+                   [](const LoopMetrics& m) { return m.ws_slow_closes.get(); });
+
+    append_meta(out, "http_server_responses_total", "counter", "Responses by status code.");
+    for (unsigned code = 100; code < 600; ++code) {
+        uint64_t n = 0;
+        for (const auto& m : loops) n += m->status_count(code);
+        if (n == 0) continue;
+        out += "http_server_responses_total{code=\"";
+        append_uint(out, code);
+        out += "\"} ";
+        append_uint(out, n);
+        out += '\n';
+    }
+
+    append_meta(out, "http_server_request_duration_seconds", "histogram",
+                "Time from routing a request to queueing its response, by route and status class.");
+    size_t routes = 0;
+    for (const auto& m : loops) routes = std::max(routes, m->routes());
+    HistogramSnapshot snap;
+    std::string labels;
+    for (uint32_t r = 0; r < routes; ++r) {
+        for (unsigned cls = 0; cls < LoopMetrics::kClasses; ++cls) {
+            snap = HistogramSnapshot{};
+            for (const auto& m : loops)
+                if (const LatencyHistogram* h = m->histogram(r, cls)) snap.add(*h);
+            if (snap.count == 0) continue;
+
+            labels.clear();
+            if (router && r < router->routes().size()) {
+                const http::Router::RouteInfo& info = router->routes()[r];
+                const std::string_view method = http::method_name(info.method);
+                if (!method.empty()) {
+                    labels += "method=\"";
+                    labels.append(method);
+                    labels += "\",";
+                }
+                labels += "route=\"";
+                append_label(labels, info.pattern);
+            } else {
+                labels += "route=\"";
+                append_uint(labels, r);
+            }
+            labels += "\",class=\"";
+            labels += static_cast<char>('1' + cls);
+            labels += "xx\"";
+
+            uint64_t cum = 0;
+            size_t   b   = 0;
+            for (unsigned shift = kLeFirstShift; shift <= LatencyHistogram::kMaxShift; ++shift) {
+                const uint64_t le = uint64_t{1} << shift;
+                for (; b < snap.buckets.size() && LatencyHistogram::upper_bound(b) < le; ++b) cum += snap.buckets[b];
+                out += "http_server_request_duration_seconds_bucket{";
+                out += labels;
+                out += ",le=\"";
+                append_seconds(out, le);
+                out += "\"} ";
+                append_uint(out, cum);
+                out += '\n';
+            }
+            out += "http_server_request_duration_seconds_bucket{";
+            out += labels;
+            out += ",le=\"+Inf\"} ";
+            append_uint(out, snap.count);
+            out += "\nhttp_server_request_duration_seconds_sum{";
+            out += labels;
+            out += "} ";
+            append_seconds(out, snap.sum);
+            out += "\nhttp_server_request_duration_seconds_count{";
+            out += labels;
+            out += "} ";
+            append_uint(out, snap.count);
+            out += '\n';
+        }
+    }
+    return out;
+}
+
+} // namespace net
@@ -0,0 +1,136 @@
+#include "server/OutputQueue.h"
+
+namespace net {
+
+OutputQueue::BlockCache::~BlockCache() {
+    for (Slot& s : slots_)
+        if (s.ptr) std::pmr::new_delete_resource()->deallocate(s.ptr, s.size, s.align);
+}
+
+void* OutputQueue::BlockCache::do_allocate(size_t bytes, size_t align) {
+    for (Slot& s : slots_) {
+        if (s.ptr && s.size == bytes && s.align == align) {
+            void* p = s.ptr;
+            s.ptr = nullptr;
+            return p;
+        }
+    }
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+}
+
+void OutputQueue::BlockCache::do_deallocate(void* p, size_t bytes, size_t align) noexcept {
+    for (Slot& s : slots_) {
+        if (!s.ptr) {
+            s = Slot{p, bytes, align};
+            return;
+        }
+    }
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+}
+
+void OutputQueue::push(Segment&& s) {
+    bytes_ += s.size();
+    segs_.push_back(std::move(s));
+}
+
+void OutputQueue::append(std::string data) {
+    if (data.empty()) return;
+    // 小块数据（响应头、小响应体、pipelining 的连续小响应）合并成一段；
+    // 上一段本身很大时只在容量还放得下时合并，否则 += 会重新分配并拷贝整个大段
+    if (data.size() <= kCoalesceMax && segs_.size() > pinned_ && segs_.back().is_owned &&
+        (segs_.back().owned.size() <= kCoalesceMax ||
+         segs_.back().owned.capacity() - segs_.back().owned.size() >= data.size())) {
+        segs_.back().owned += data;
+        bytes_ += data.size();
+        recycle(std::move(data));
+        return;
+    }
+    Segment s;
+    s.owned    = std::move(data);
+    s.is_owned = true;
+    push(std::move(s));
+}
+
+void OutputQueue::append_shared(std::shared_ptr<const std::string> data) {
+    if (!data || data->empty()) return;
+    const std::string_view v(*data);
+    append_shared(std::shared_ptr<const void>(std::move(data)), v);
+}
+
+void OutputQueue::append_shared(std::shared_ptr<const void> owner, std::string_view data) {
+    if (data.empty()) return;
+    Segment s;
+    s.ref = std::move(owner);
+    s.ptr = data.data();
+    s.len = data.size();
+    push(std::move(s));
+}
+
+void OutputQueue::append_borrowed(std::string_view data) {
+    if (data.empty()) return;
+    Segment s;
+    s.ptr = data.data();
+    s.len = data.size();
+    push(std::move(s));
+}
+
+void OutputQueue::append_file(std::shared_ptr<const void> owner, int fd, uint64_t offset, uint64_t len) {
+    if (len == 0) return;
+    Segment s;
+    s.ref      = std::move(owner);
+    s.file_fd  = fd;
+    s.file_off = offset;
+    s.len      = len;
+    push(std::move(s));
+}
+
+bool OutputQueue::front_file(FileSlice& out) const noexcept {
+    if (segs_.empty() || !segs_.front().is_file()) return false;
+    const Segment& f = segs_.front();
+    const uint64_t left = f.len - offset_;
+    constexpr uint64_t kMaxChunk = 1ull << 30; // sendfile 单次上限约 2GB，分块发
+    out = FileSlice{f.file_fd, f.file_off + offset_, static_cast<size_t>(left < kMaxChunk ? left : kMaxChunk)};
+    return true;
+}
+
+size_t OutputQueue::gather(IoSlice* out, size_t max) const noexcept {
+    size_t n = 0;
+    size_t skip = static_cast<size_t>(offset_);
+    for (auto it = segs_.begin(); it != segs_.end() && n < max && !it->is_file(); ++it) {
+        const std::string_view v = it->view();
+        out[n++] = IoSlice{v.data() + skip, v.size() - skip};
+        skip = 0;
+    }
+    return n;
+}
+
+void OutputQueue::consume(uint64_t n) noexcept {
+    bytes_ -= n;
+    while (n > 0) {
+        const uint64_t left = segs_.front().size() - offset_;
+        if (n < left) {
+            offset_ += n;
+            return;
+        }
+        n -= left;
+        offset_ = 0;
+        if (segs_.front().is_owned) recycle(std::move(segs_.front().owned));
+        segs_.pop_front();
+        if (pinned_ > 0) --pinned_;
+    }
+}
+
+void OutputQueue::recycle(std::string&& s) noexcept {
+    if (s.capacity() <= spare_.capacity() || s.capacity() > kSpareMax) return;
+    s.clear();
+    spare_ = std::move(s);
+}
+
+void OutputQueue::clear() noexcept {
+    segs_.clear();
+    offset_ = 0;
+    bytes_  = 0;
+    pinned_ = 0;
+}
+
+} // namespace net
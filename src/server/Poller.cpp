@@ -0,0 +1,36 @@
+#include "server/Poller.h"
+
+namespace net {
+
+const char* backend_name(Backend b) noexcept {
+    switch (b) {
+        case Backend::Auto:    return "auto";
+        case Backend::Select:  return "select";
+        case Backend::Epoll:   return "epoll";
+        case Backend::IoUring: return "io_uring";
+    }
+    return "unknown";
+}
+
+std::unique_ptr<Poller> make_poller(Backend b) {
+    switch (b) {
+        case Backend::Select:
+            return make_select_poller();
+        case Backend::Epoll:
+#ifdef __linux__
+            return make_epoll_poller();
+#else
+            return nullptr;
+#endif
+        case Backend::Auto:
+#ifdef __linux__
+            if (auto p = make_epoll_poller()) return p;
+#endif
+            return make_select_poller();
+        case Backend::IoUring:
+            return nullptr;
+    }
+    return nullptr;
+}
+
+} // namespace net
@@ -0,0 +1,80 @@
+#ifdef __linux__
+#include "server/Poller.h"
+
+#include <sys/epoll.h>
+
+namespace net {
+
+namespace {
+
+// 边沿触发 epoll：连接注册一次 EPOLLIN|EPOLLOUT|EPOLLET，之后不再 epoll_ctl，
+// 每次唤醒只处理就绪的 fd，没有 fd 数量上限。
+class EpollPoller final : public Poller {
+public:
+    explicit EpollPoller(int epfd) : epfd_(epfd) { events_.resize(256); }
+    ~EpollPoller() override { ::close(epfd_); }
+
+    bool add_listener(socket_t fd) override {
+        epoll_event ev{};
+        ev.events  = EPOLLIN; // 电平触发
+        ev.data.fd = fd;
+        return ::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    bool add(socket_t fd) override {
+        epoll_event ev{};
+        ev.events  = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        return ::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    bool watch(socket_t fd, bool write) override {
+        epoll_event ev{};
+        ev.events  = (write ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+        ev.data.fd = fd;
+        return ::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    void set_want_write(socket_t, bool) override {} // ET 下写兴趣常驻
+    void set_want_read(socket_t, bool) override {}  // 同上：调用方不读，新数据只会再触发一次
+
+    void remove(socket_t fd) override {
+        ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    int wait(std::vector<PollEvent>& out, int timeout_ms) override {
+        out.clear();
+        const int n = ::epoll_wait(epfd_, events_.data(), static_cast<int>(events_.size()), timeout_ms);
+        if (n < 0) return errno == EINTR ? 0 : -1;
+
+        for (int i = 0; i < n; ++i) {
+            const uint32_t e = events_[i].events;
+            out.push_back(PollEvent{
+                events_[i].data.fd,
+                (e & EPOLLIN) != 0,
+                (e & EPOLLOUT) != 0,
+                (e & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0,
+            });
+        }
+        // 事件数组被打满说明就绪较多，扩容以减少 epoll_wait 次数
+        if (n == static_cast<int>(events_.size())) events_.resize(events_.size() * 2);
+        return n;
+    }
+
+    Backend backend() const noexcept override { return Backend::Epoll; }
+
+private:
+    int                      epfd_;
+    std::vector<epoll_event> events_;
+};
+
+} // namespace
+
+std::unique_ptr<Poller> make_epoll_poller() {
+    const int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) return nullptr;
+    return std::make_unique<EpollPoller>(epfd);
+}
+
+} // namespace net
+#endif
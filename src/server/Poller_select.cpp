@@ -0,0 +1,80 @@
+#include "server/Poller.h"
+
+#include <cerrno>
+#include <unordered_map>
+
+namespace net {
+
+namespace {
+
+// 可移植的兜底实现：每次 wait 重建 fd_set，复杂度 O(注册数)，
+// 在 POSIX 上受 FD_SETSIZE 限制（超出的 fd 注册失败）。
+class SelectPoller final : public Poller {
+public:
+    bool add_listener(socket_t fd) override { return add(fd); }
+
+    bool add(socket_t fd) override { return watch(fd, false); }
+
+    bool watch(socket_t fd, bool write) override {
+#ifdef _WIN32
+        if (interest_.size() >= FD_SETSIZE) return false;
+#else
+        if (fd >= FD_SETSIZE) return false;
+#endif
+        interest_[fd] = write ? kWrite : kRead;
+        return true;
+    }
+
+    void set_want_write(socket_t fd, bool on) override {
+        auto it = interest_.find(fd);
+        if (it != interest_.end()) it->second = static_cast<uint8_t>((it->second & kRead) | (on ? kWrite : 0));
+    }
+
+    void set_want_read(socket_t fd, bool on) override {
+        auto it = interest_.find(fd);
+        if (it != interest_.end()) it->second = static_cast<uint8_t>((it->second & kWrite) | (on ? kRead : 0));
+    }
+
+    void remove(socket_t fd) override { interest_.erase(fd); }
+
+    int wait(std::vector<PollEvent>& out, int timeout_ms) override {
+        out.clear();
+        fd_set rfds, wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+
+        socket_t maxfd = 0;
+        for (auto& [fd, in] : interest_) {
+            if (in & kRead)  FD_SET(fd, &rfds);
+            if (in & kWrite) FD_SET(fd, &wfds);
+            if (fd > maxfd) maxfd = fd;
+        }
+
+        timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        const int nready = ::select(static_cast<int>(maxfd + 1), &rfds, &wfds, nullptr,
+                                    timeout_ms < 0 ? nullptr : &tv);
+        if (nready < 0) return errno == EINTR ? 0 : -1;
+        if (nready == 0) return 0;
+
+        for (auto& [fd, in] : interest_) {
+            const bool r = (in & kRead) && FD_ISSET(fd, &rfds);
+            const bool w = (in & kWrite) && FD_ISSET(fd, &wfds);
+            if (r || w) out.push_back(PollEvent{fd, r, w, false});
+        }
+        return static_cast<int>(out.size());
+    }
+
+    Backend backend() const noexcept override { return Backend::Select; }
+
+private:
+    enum : uint8_t { kRead = 1, kWrite = 2 };
+    std::unordered_map<socket_t, uint8_t> interest_; // 连接默认关心可读，可写按需
+};
+
+} // namespace
+
+std::unique_ptr<Poller> make_select_poller() {
+    return std::make_unique<SelectPoller>();
+}
+
+} // namespace net
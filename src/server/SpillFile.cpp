@@ -0,0 +1,88 @@
+#include "server/SpillFile.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace net {
+
+namespace {
+
+std::string temp_dir(const std::string& dir) {
+    if (!dir.empty()) return dir;
+    std::error_code ec;
+    const std::filesystem::path p = std::filesystem::temp_directory_path(ec);
+    return ec ? std::string(".") : p.string();
+}
+
+#ifdef _WIN32
+int open_anonymous(const std::string& dir) {
+    // 没有匿名文件：按进程号 + 序号起名，_O_TEMPORARY 让最后一个句柄关闭时删除
+    static std::atomic<unsigned> seq{0};
+    for (int attempt = 0; attempt < 16; ++attempt) {
+        const std::string name = dir + "\\http-body-" + std::to_string(::_getpid()) + "-" +
+                                 std::to_string(seq.fetch_add(1, std::memory_order_relaxed));
+        const int fd = ::_open(name.c_str(), _O_CREAT | _O_EXCL | _O_RDWR | _O_BINARY | _O_TEMPORARY,
+                               _S_IREAD | _S_IWRITE);
+        if (fd >= 0 || errno != EEXIST) return fd;
+    }
+    return -1;
+}
+#else
+int open_anonymous(const std::string& dir) {
+#ifdef O_TMPFILE
+    const int fd = ::open(dir.c_str(), O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd >= 0) return fd;
+    // 文件系统不支持 O_TMPFILE（EOPNOTSUPP / EISDIR）时退回 mkstemp
+#endif
+    std::string name = dir + "/http-body-XXXXXX";
+    const int fd2 = ::mkstemp(name.data());
+    if (fd2 < 0) return -1;
+    ::unlink(name.c_str()); // 只剩 fd 引用，关闭即回收
+    ::fcntl(fd2, F_SETFD, FD_CLOEXEC);
+    return fd2;
+}
+#endif
+
+} // namespace
+
+std::shared_ptr<SpillFile> SpillFile::create(const std::string& dir) {
+    const int fd = open_anonymous(temp_dir(dir));
+    if (fd < 0) return nullptr;
+    return std::shared_ptr<SpillFile>(new SpillFile(fd));
+}
+
+SpillFile::~SpillFile() {
+#ifdef _WIN32
+    ::_close(fd_);
+#else
+    ::close(fd_);
+#endif
+}
+
+bool SpillFile::write(std::string_view data) noexcept {
+    while (!data.empty()) {
+#ifdef _WIN32
+        const int n = ::_write(fd_, data.data(), static_cast<unsigned>(data.size() < (1u << 30) ? data.size() : (1u << 30)));
+#else
+        const ssize_t n = ::write(fd_, data.data(), data.size());
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data.remove_prefix(static_cast<size_t>(n));
+        size_ += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+} // namespace net
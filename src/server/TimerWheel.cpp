@@ -0,0 +1,157 @@
+#include "server/TimerWheel.h"
+
+#include <bit>
+
+namespace net {
+
+namespace {
+
+void init_head(TimerNode& h) noexcept { h.prev = h.next = &h; }
+bool list_empty(const TimerNode& h) noexcept { return h.next == &h; }
+
+void push_back(TimerNode& h, TimerNode& n) noexcept {
+    n.prev       = h.prev;
+    n.next       = &h;
+    h.prev->next = &n;
+    h.prev       = &n;
+}
+
+// 把 from 整条链表接到 to（空）上，from 变空
+void take_all(TimerNode& from, TimerNode& to) noexcept {
+    init_head(to);
+    if (list_empty(from)) return;
+    to.next       = from.next;
+    to.prev       = from.prev;
+    to.next->prev = &to;
+    to.prev->next = &to;
+    init_head(from);
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(uint64_t now) noexcept : cur_(now) {
+    for (auto& level : slots_)
+        for (TimerNode& h : level) init_head(h);
+    init_head(expired_);
+}
+
+TimerWheel::~TimerWheel() {
+    // 还挂着的节点属于别人：摘成游离状态，拥有者之后销毁时不会再碰到轮
+    auto detach = [](TimerNode& h) {
+        while (!list_empty(h)) h.next->unlink();
+        h.prev = h.next = nullptr;
+    };
+    for (auto& level : slots_)
+        for (TimerNode& h : level) detach(h);
+    detach(expired_);
+}
+
+void TimerWheel::place(TimerNode& n) noexcept {
+    uint64_t e = n.expires <= cur_ ? cur_ + 1 : n.expires;
+    // 最高层当环用：往后最多 63 个槽，再远的先挂在最远的槽里
+    constexpr unsigned kTop   = kBits * (kLevels - 1);
+    const uint64_t     limit = (((cur_ >> kTop) + kSlots) << kTop) - 1;
+    if (e > limit) e = limit;
+    // 与 cur_ 在更高各层上都相同的最低一层（最高层除外）
+    unsigned level = 0;
+    while (level + 1 < kLevels && (e >> (kBits * (level + 1))) != (cur_ >> (kBits * (level + 1)))) ++level;
+    const unsigned slot = static_cast<unsigned>(e >> (kBits * level)) & (kSlots - 1);
+    n.level = static_cast<uint8_t>(level);
+    n.slot  = static_cast<uint8_t>(slot);
+    push_back(slots_[level][slot], n);
+    mask_[level] |= uint64_t{1} << slot;
+}
+
+void TimerWheel::schedule(TimerNode& n, uint64_t expires) noexcept {
+    if (n.linked()) cancel(n);
+    n.expires = expires;
+    place(n);
+}
+
+void TimerWheel::cancel(TimerNode& n) noexcept {
+    if (!n.linked()) return;
+    n.unlink();
+    if (n.level < kLevels && list_empty(slots_[n.level][n.slot])) mask_[n.level] &= ~(uint64_t{1} << n.slot);
+}
+
+// cur_ 刚跨进上一层的一个新槽：把那个槽里的节点按新的 cur_ 重新挂到下面几层
+void TimerWheel::cascade(unsigned level) noexcept {
+    if (level >= kLevels) return;
+    const unsigned slot = static_cast<unsigned>(cur_ >> (kBits * level)) & (kSlots - 1);
+    if (slot == 0) cascade(level + 1); // 更高一层先下来，可能正好落进这个槽
+    TimerNode list;
+    take_all(slots_[level][slot], list);
+    mask_[level] &= ~(uint64_t{1} << slot);
+    while (!list_empty(list)) {
+        TimerNode& n = *list.next;
+        n.unlink();
+        if (n.expires <= cur_) expire(n); // 正好在级联到的这个 tick 到期
+        else                   place(n);
+    }
+    list.prev = list.next = nullptr;
+}
+
+void TimerWheel::expire(TimerNode& n) noexcept {
+    n.level = kLevels; // 标记为在到期队列里
+    push_back(expired_, n);
+}
+
+void TimerWheel::expire_slot(unsigned slot) noexcept {
+    TimerNode list;
+    take_all(slots_[0][slot], list);
+    mask_[0] &= ~(uint64_t{1} << slot);
+    while (!list_empty(list)) {
+        TimerNode& n = *list.next;
+        n.unlink();
+        if (n.expires > cur_) place(n); // 超出范围时被提前挂在远处的
+        else                  expire(n);
+    }
+    list.prev = list.next = nullptr;
+}
+
+void TimerWheel::advance(uint64_t now) noexcept {
+    while (cur_ < now) {
+        // 本轮 level 0 剩下的槽都空：直接跳到 now 或本轮最后一个 tick
+        const unsigned pos  = static_cast<unsigned>(cur_) & (kSlots - 1);
+        const uint64_t stop = (cur_ | (kSlots - 1)) < now ? (cur_ | (kSlots - 1)) : now;
+        const unsigned end  = static_cast<unsigned>(stop) & (kSlots - 1);
+        if (end > pos) {
+            const uint64_t upto = end == kSlots - 1 ? ~uint64_t{0} : (uint64_t{1} << (end + 1)) - 1;
+            const uint64_t ahead = mask_[0] & upto & ~((uint64_t{2} << pos) - 1);
+            if (ahead == 0) {
+                cur_ = stop;
+                continue;
+            }
+            cur_ += static_cast<unsigned>(std::countr_zero(ahead)) - pos; // 下一个非空槽
+            expire_slot(static_cast<unsigned>(cur_) & (kSlots - 1));
+            continue;
+        }
+        ++cur_; // 跨过本轮末尾
+        cascade(1);
+        expire_slot(0);
+    }
+}
+
+TimerNode* TimerWheel::pop_expired() noexcept {
+    if (list_empty(expired_)) return nullptr;
+    TimerNode* n = expired_.next;
+    n->unlink();
+    return n;
+}
+
+uint64_t TimerWheel::next_tick() const noexcept {
+    if (!list_empty(expired_)) return cur_;
+    // 低层的下一个非空槽一定早于高层的：找到第一层就返回
+    for (unsigned level = 0; level < kLevels; ++level) {
+        const unsigned shift = kBits * level;
+        const unsigned pos   = static_cast<unsigned>(cur_ >> shift) & (kSlots - 1);
+        uint64_t ahead = pos == kSlots - 1 ? 0 : mask_[level] & ~((uint64_t{2} << pos) - 1);
+        if (ahead == 0 && level == kLevels - 1) ahead = mask_[level] & ((uint64_t{1} << pos) - 1); // 最高层绕回
+        if (ahead == 0) continue;
+        const unsigned delta = (static_cast<unsigned>(std::countr_zero(ahead)) - pos) & (kSlots - 1);
+        return ((cur_ >> shift) + delta) << shift;
+    }
+    return UINT64_MAX;
+}
+
+} // namespace net
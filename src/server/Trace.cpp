@@ -0,0 +1,198 @@
+#include "server/Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define NET_TRACE_TSC 1
+#elif defined(_M_X64)
+#include <intrin.h>
+#define NET_TRACE_TSC 1
+#endif
+
+namespace net {
+
+namespace {
+
+uint64_t steady_ns() noexcept {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+}
+
+std::atomic<bool> g_dump_requested{false};
+
+} // namespace
+
+uint64_t trace_ticks() noexcept {
+#ifdef NET_TRACE_TSC
+    return __rdtsc();
+#else
+    return steady_ns();
+#endif
+}
+
+double trace_ns_per_tick() noexcept {
+#ifdef NET_TRACE_TSC
+    // 对着 steady_clock 量 2ms 的 TSC 增量；只在开启追踪的 loop 创建时跑一次
+    static const double ratio = [] {
+        const uint64_t n0 = steady_ns(), t0 = trace_ticks();
+        uint64_t n1;
+        do n1 = steady_ns(); while (n1 - n0 < 2000000);
+        const uint64_t t1 = trace_ticks();
+        return t1 > t0 ? static_cast<double>(n1 - n0) / static_cast<double>(t1 - t0) : 1.0;
+    }();
+    return ratio;
+#else
+    return 1.0;
+#endif
+}
+
+void request_trace_dump() noexcept {
+    g_dump_requested.store(true, std::memory_order_relaxed);
+}
+
+bool take_trace_dump_request() noexcept {
+    return g_dump_requested.load(std::memory_order_relaxed) && g_dump_requested.exchange(false);
+}
+
+TraceRing::TraceRing(const TraceOptions& opts, unsigned loop_index)
+    : sample_every_(opts.sample_every), loop_(loop_index) {
+    size_t cap = 1;
+    while (cap < opts.capacity) cap <<= 1;
+    slots_.reset(new Slot[cap]);
+    mask_       = cap - 1;
+    slow_ticks_ = opts.slow_us
+                      ? static_cast<uint64_t>(static_cast<double>(opts.slow_us) * 1000.0 / trace_ns_per_tick())
+                      : 0;
+}
+
+void TraceRing::push(const TraceRecord& r) noexcept {
+    uint64_t words[kWords];
+    std::memcpy(words, &r, sizeof(words));
+    const uint64_t n = head_.load(std::memory_order_relaxed);
+    Slot& s = slots_[n & mask_];
+    const uint64_t seq = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(seq + 1, std::memory_order_relaxed); // 奇数：正在写
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; ++i) s.words[i].store(words[i], std::memory_order_relaxed);
+    s.seq.store(seq + 2, std::memory_order_release);
+    head_.store(n + 1, std::memory_order_release);
+}
+
+void TraceRing::snapshot(std::vector<TraceRecord>& out) const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t cap  = mask_ + 1;
+    uint64_t words[kWords];
+    for (uint64_t n = head > cap ? head - cap : 0; n < head; ++n) {
+        const Slot& s = slots_[n & mask_];
+        const uint64_t before = s.seq.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        for (size_t i = 0; i < kWords; ++i) words[i] = s.words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (s.seq.load(std::memory_order_relaxed) != before) continue; // 读的过程中被覆盖
+        TraceRecord r;
+        std::memcpy(&r, words, sizeof(r));
+        out.push_back(r);
+    }
+}
+
+// —— Chrome trace JSON ——
+
+namespace {
+
+void append_json_string(std::string& out, std::string_view v) {
+    out += '"';
+    for (const char ch : v) {
+        const auto u = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (u < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+            out += buf;
+        } else {
+            out += ch;
+        }
+    }
+    out += '"';
+}
+
+// 一个完整事件（ph "X"），时间以微秒计，保留到纳秒
+void append_span(std::string& out, std::string_view name, unsigned pid, uint32_t tid, double ts_us,
+                 double dur_us, const std::string& args) {
+    char buf[160];
+    out += "{\"name\":";
+    append_json_string(out, name);
+    const int n = std::snprintf(buf, sizeof(buf), ",\"cat\":\"http\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                                pid, tid, ts_us, dur_us > 0 ? dur_us : 0.0);
+    if (n > 0) out.append(buf, static_cast<size_t>(n));
+    if (!args.empty()) out.append(",\"args\":").append(args);
+    out += "},\n";
+}
+
+} // namespace
+
+std::string render_chrome_trace(const std::vector<std::shared_ptr<const TraceRing>>& loops,
+                                const http::Router* router) {
+    struct Item {
+        unsigned    loop;
+        TraceRecord r;
+    };
+    std::vector<Item>        items;
+    std::vector<TraceRecord> recs;
+    for (const auto& ring : loops) {
+        recs.clear();
+        ring->snapshot(recs);
+        for (const TraceRecord& r : recs) items.push_back(Item{ring->loop_index(), r});
+    }
+
+    uint64_t base = UINT64_MAX;
+    for (const Item& it : items) base = std::min(base, it.r.start);
+    const double us_per_tick = trace_ns_per_tick() / 1000.0;
+    const auto   us = [&](uint64_t t) { return static_cast<double>(t - base) * us_per_tick; };
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    char buf[96];
+    for (const auto& ring : loops) {
+        const int n = std::snprintf(buf, sizeof(buf),
+                                    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"loop %u\"}},\n",
+                                    ring->loop_index(), ring->loop_index());
+        if (n > 0) out.append(buf, static_cast<size_t>(n));
+    }
+
+    std::string name, args;
+    for (const Item& it : items) {
+        const TraceRecord& r = it.r;
+        // 头部完整时就启动的协程、解析出错的请求：缺的阶段并到相邻阶段里
+        const uint64_t routed = r.routed ? r.routed : r.serialized;
+        const uint64_t parsed = r.parsed && r.parsed <= routed ? r.parsed : routed;
+
+        name.assign(http::method_name(static_cast<http::Method>(r.method)));
+        if (!name.empty()) name += ' ';
+        const void* nul = std::memchr(r.path, 0, sizeof(r.path));
+        name.append(r.path, nul ? static_cast<const char*>(nul) - r.path : sizeof(r.path));
+
+        args = "{\"status\":" + std::to_string(r.status) + ",\"route\":";
+        if (router && r.route < router->routes().size()) append_json_string(args, router->routes()[r.route].pattern);
+        else                                             args += std::to_string(r.route);
+        args += (r.flags & TraceRecord::kSampled) ? ",\"sampled\":true}" : ",\"sampled\":false}";
+
+        append_span(out, name, it.loop, r.fd, us(r.start), us(r.sent) - us(r.start), args);
+        append_span(out, "recv", it.loop, r.fd, us(r.start), us(parsed) - us(r.start), {});
+        if (r.parse_ticks)
+            append_span(out, "parse", it.loop, r.fd, us(parsed) - static_cast<double>(r.parse_ticks) * us_per_tick,
+                        static_cast<double>(r.parse_ticks) * us_per_tick, {});
+        append_span(out, "route", it.loop, r.fd, us(parsed), us(routed) - us(parsed), {});
+        append_span(out, "serialize", it.loop, r.fd, us(routed), us(r.serialized) - us(routed), {});
+        append_span(out, "send", it.loop, r.fd, us(r.serialized), us(r.sent) - us(r.serialized), {});
+    }
+    if (out.back() == '\n' && out[out.size() - 2] == ',') out.erase(out.size() - 2, 1); // 去掉最后一个逗号
+    out += "]}\n";
+    return out;
+}
+
+} // namespace net
@@ -0,0 +1,84 @@
+#include "server/WorkerPool.h"
+
+namespace net {
+
+WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0) threads = 1;
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+}
+
+WorkerPool::~WorkerPool() {
+    stop();
+}
+
+void WorkerPool::start() {
+    stop_ = false;
+    threads_.reserve(queues_.size());
+    for (unsigned i = 0; i < queues_.size(); ++i) threads_.emplace_back([this, i] { worker(i); });
+}
+
+void WorkerPool::stop() noexcept {
+    {
+        std::lock_guard<std::mutex> lk(sleep_mu_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+    for (auto& q : queues_) {
+        for (Task* t : q->tasks) t->cancel();
+        q->tasks.clear();
+    }
+    pending_ = 0;
+}
+
+void WorkerPool::submit(Task* t) {
+    Queue& q = *queues_[next_.fetch_add(1, std::memory_order_relaxed) % queues_.size()];
+    pending_.fetch_add(1); // 先计数再入队，计数不会因为任务已被取走而减成负数
+    {
+        std::lock_guard<std::mutex> lk(q.mu);
+        q.tasks.push_back(t);
+    }
+    // 工作线程在 sleep_mu_ 下检查计数，这里经过一次 sleep_mu_ 再通知就不会错过唤醒
+    { std::lock_guard<std::mutex> lk(sleep_mu_); }
+    sleep_cv_.notify_one();
+}
+
+Task* WorkerPool::take(unsigned self) {
+    const size_t n = queues_.size();
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lk(own.mu);
+        if (!own.tasks.empty()) {
+            Task* t = own.tasks.front();
+            own.tasks.pop_front();
+            return t;
+        }
+    }
+    // 自己的队列空了：从其他队列的尾部偷，和队列主人在两端，冲突少
+    for (size_t i = 1; i < n; ++i) {
+        Queue& victim = *queues_[(self + i) % n];
+        std::lock_guard<std::mutex> lk(victim.mu);
+        if (!victim.tasks.empty()) {
+            Task* t = victim.tasks.back();
+            victim.tasks.pop_back();
+            return t;
+        }
+    }
+    return nullptr;
+}
+
+void WorkerPool::worker(unsigned self) {
+    while (!stop_.load(std::memory_order_relaxed)) {
+        if (Task* t = take(self)) {
+            pending_.fetch_sub(1);
+            t->run();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleep_mu_);
+        sleep_cv_.wait(lk, [this] { return stop_.load() || pending_.load() > 0; });
+    }
+}
+
+} // namespace net